@@ -0,0 +1,380 @@
+#include "prev.h"
+
+#include "platform/nullwindow.h"
+#include "api/null/nullapi.h"
+
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+using namespace prev;
+
+// Count every heap allocation so we can report allocations per frame
+static std::atomic<unsigned long long> s_AllocationCount(0);
+
+void * operator new(std::size_t size) {
+	s_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void * ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void * ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t size) noexcept {
+	std::free(ptr);
+}
+
+struct BenchConfig {
+	unsigned int Frames = 1000;
+	unsigned int WarmupFrames = 60;
+	float FixedDeltaTime = 1.0f / 60.0f;
+	std::vector<unsigned int> LayerCounts = { 1, 100, 10000 };
+	std::vector<unsigned int> EventCounts = { 0, 16, 256 };
+	std::string OutputPath;
+	bool IndependentLayers = false;
+	unsigned int FrameLatency = 1;
+	float PresentDelay = 0.0f;					// In ms, simulated Present
+	float TargetFPS = 0.0f;						// 0 doesn't pace
+	FramePacingMode Pacing = FramePacingMode::Cap;
+	long long MaxAllocations = -1;				// Fail when a measured frame allocates more than this or overflows the frame arena
+	std::string RecordPath;					// Input of the last scenario
+	std::string ReplayPath;					// Replaces the synthetic events
+	std::string LogPath;						// .pvlog writes the binary format
+	bool Profile = false;						// Keeps the profiler recording, to measure what it costs
+};
+
+struct BenchResult {
+	unsigned int LayerCount;
+	unsigned int EventsPerFrame;
+	std::vector<double> FrameTimes;			// In ms
+	std::vector<unsigned long long> Allocations;
+	FramePacingStats Pacing;
+	unsigned long long FrameArenaAllocations = 0;	// Over all measured frames
+	unsigned long long FrameArenaPeak = 0;			// Bytes, worst frame
+	unsigned long long FrameArenaOverflows = 0;
+};
+
+// Does a little bit of work per update and handles mouse events like a game layer would
+class SyntheticLayer : public Layer {
+	PV_LAYER_HOOKS(SyntheticLayer)
+public:
+	SyntheticLayer(bool independent) : Layer("SYNTHETIC_LAYER") {
+		// Lets the layer stack update them in parallel
+		if (independent)
+			DeclareIndependent();
+	}
+private:
+	virtual void OnUpdate() override {
+		// Scratch data lives in frame memory, no heap traffic
+		FrameVector<float> values = MakeFrameVector<float>();
+		values.reserve(16);
+		for (int i = 0; i < 16; i++) {
+			m_Accumulator = m_Accumulator * 1.0001f + 0.5f;
+			values.push_back((float)m_Accumulator);
+		}
+	}
+
+	virtual void OnEvent(Event & e) override {
+		EventDispatcher dispatcher(e);
+		dispatcher.Dispatch<MouseMovedEvent>(BIND_EVENT_FN(SyntheticLayer::MouseMoved));
+	}
+
+	bool MouseMoved(MouseMovedEvent & e) {
+		m_Accumulator += e.GetX() - e.GetY();
+		return false;
+	}
+private:
+	volatile float m_Accumulator = 0.0f;
+};
+
+// Pushed as the last overlay, so the time between two of its updates is exactly one trip around Application::Run
+class BenchLayer : public Layer {
+	PV_LAYER_HOOKS(BenchLayer)
+public:
+	BenchLayer(Application * app, BenchResult & result, unsigned int frames, unsigned int warmupFrames) :
+		Layer("BENCH_LAYER"), m_App(app), m_Result(result), m_Frames(frames), m_WarmupFrames(warmupFrames) {
+		m_Result.FrameTimes.reserve(frames);
+		m_Result.Allocations.reserve(frames);
+	}
+private:
+	virtual void OnUpdate() override {
+		auto now = std::chrono::steady_clock::now();
+		unsigned long long allocations = s_AllocationCount.load(std::memory_order_relaxed);
+
+		if (m_FrameIndex > m_WarmupFrames) {
+			std::chrono::duration<double, std::milli> frameTime = now - m_LastFrame;
+			m_Result.FrameTimes.push_back(frameTime.count());
+			m_Result.Allocations.push_back(allocations - m_LastAllocations);
+
+			const FrameAllocatorStats & arena = m_App->GetFrameAllocator().GetLastFrameStats();
+			m_Result.FrameArenaAllocations += arena.Allocations;
+			m_Result.FrameArenaPeak = std::max(m_Result.FrameArenaPeak, arena.Used);
+			m_Result.FrameArenaOverflows += arena.Overflows;
+		}
+
+		m_LastFrame = now;
+		m_FrameIndex++;
+
+		if (m_FrameIndex > m_Frames + m_WarmupFrames)
+			m_App->IsAppRunning = false;
+
+		// Don't count our own bookkeeping
+		m_LastAllocations = s_AllocationCount.load(std::memory_order_relaxed);
+	}
+private:
+	Application * m_App;
+	BenchResult & m_Result;
+	unsigned int m_Frames, m_WarmupFrames;
+	unsigned int m_FrameIndex = 0;
+	unsigned long long m_LastAllocations = 0;
+	std::chrono::time_point<std::chrono::steady_clock> m_LastFrame;
+};
+
+// One app (and so one job system) runs every scenario, the layers of a scenario are popped when it ends
+class BenchApp : public Application {
+public:
+	BenchApp(const BenchConfig & config) :
+		Application(WindowAPI::WINDOWING_API_NULL, RenderingAPI::RENDERING_API_NULL) {
+		if (!IsAppReady)
+			return;
+
+		SetFrameLatency(config.FrameLatency);
+		((NullAPI *)GetGraphicsAPI())->SetPresentDelay(config.PresentDelay);
+		GetFramePacer().SetMode(config.TargetFPS > 0.0f ? config.Pacing : FramePacingMode::Off);
+		GetFramePacer().SetTargetFPS(config.TargetFPS);
+	}
+
+	bool RunScenario(const BenchConfig & config, BenchResult & result) {
+		std::vector<SyntheticLayer *> layers;
+		layers.reserve(result.LayerCount);
+		for (unsigned int i = 0; i < result.LayerCount; i++) {
+			layers.push_back(new SyntheticLayer(config.IndependentLayers));
+			GetLayerStack().PushLayer(layers.back());
+		}
+		BenchLayer * benchLayer = new BenchLayer(this, result, config.Frames, config.WarmupFrames);
+		GetLayerStack().PushOverlay(benchLayer);
+
+		bool ready = true;
+		if (!config.RecordPath.empty())
+			StartInputRecording(config.RecordPath);
+		if (!config.ReplayPath.empty())
+			ready = StartInputReplay(config.ReplayPath);
+		else
+			SetSyntheticEvents(result.EventsPerFrame);
+
+		if (ready) {
+			GetFramePacer().ResetStats();
+			IsAppRunning = true;
+			Run();
+			result.Pacing = GetFramePacer().GetStats();
+		}
+
+		StopInputRecording();
+		if (GetLayerStack().PopOverlay(benchLayer))
+			delete benchLayer;
+		for (SyntheticLayer * layer : layers) {
+			if (GetLayerStack().PopLayer(layer))
+				delete layer;
+		}
+		return ready;
+	}
+private:
+	// Same input every frame, a mix of the events a real window would send
+	void SetSyntheticEvents(unsigned int eventsPerFrame) {
+		NullWindow * window = (NullWindow *)GetWindow();
+		window->SetEventSource([eventsPerFrame](std::function<void(Event & e)> & callback) -> void {
+			for (unsigned int i = 0; i < eventsPerFrame; i++) {
+				switch (i % 4) {
+				case 0: case 1:
+				{
+					MouseMovedEvent e((float)(i * 7 % 1280), (float)(i * 13 % 720));
+					callback(e);
+					break;
+				}
+				case 2:
+				{
+					MouseScrolledEvent e(0.0f, 1.0f);
+					callback(e);
+					break;
+				}
+				case 3:
+				{
+					KeyPressedEvent e(PV_KEYBOARD_KEY_A, false);
+					callback(e);
+					KeyReleasedEvent r(PV_KEYBOARD_KEY_A);
+					callback(r);
+					break;
+				}
+				}
+			}
+		});
+	}
+};
+
+static std::vector<unsigned int> ParseList(const char * str) {
+	std::vector<unsigned int> list;
+	std::stringstream ss(str);
+	std::string item;
+	while (std::getline(ss, item, ','))
+		list.push_back((unsigned int)std::strtoul(item.c_str(), nullptr, 10));
+	return list;
+}
+
+static bool ParseArgs(int argc, char ** argv, BenchConfig & config) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+			return false;
+		}
+		const char * value = argv[++i];
+		if (arg == "--frames")			config.Frames = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--warmup")		config.WarmupFrames = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--dt")			config.FixedDeltaTime = (float)std::atof(value);
+		else if (arg == "--layers")		config.LayerCounts = ParseList(value);
+		else if (arg == "--events")		config.EventCounts = ParseList(value);
+		else if (arg == "--out")		config.OutputPath = value;
+		else if (arg == "--log")		config.LogPath = value;
+		else if (arg == "--independent")	config.IndependentLayers = std::atoi(value) != 0;
+		else if (arg == "--latency")		config.FrameLatency = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--present-delay")	config.PresentDelay = (float)std::atof(value);
+		else if (arg == "--fps")		config.TargetFPS = (float)std::atof(value);
+		else if (arg == "--pacing")		config.Pacing = std::strcmp(value, "adaptive") == 0 ? FramePacingMode::Adaptive : FramePacingMode::Cap;
+		else if (arg == "--max-allocs")	config.MaxAllocations = std::atoll(value);
+		else if (arg == "--record")		config.RecordPath = value;
+		else if (arg == "--replay")		config.ReplayPath = value;
+		else if (arg == "--profile")	config.Profile = std::atoi(value) != 0;
+		else {
+			std::fprintf(stderr, "Unknown argument %s\n"
+						 "Usage: PrevBench [--frames N] [--warmup N] [--dt seconds] [--layers 1,100,10000] [--events 0,16,256] [--independent 0|1] [--latency 1|2|3] [--present-delay ms] [--fps N] [--pacing cap|adaptive] [--max-allocs N] [--out file.json] [--log file.txt|file.pvlog] [--record file.pvinput] [--replay file.pvinput] [--profile 0|1]\n",
+						 arg.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+template<typename T>
+static T Percentile(const std::vector<T> & sorted, double percentile) {
+	if (sorted.empty())
+		return T();
+	size_t index = (size_t)std::ceil(percentile / 100.0 * sorted.size());
+	return sorted[index > 0 ? index - 1 : 0];
+}
+
+static void WriteResult(FILE * file, const BenchResult & result, bool last) {
+	std::vector<double> times = result.FrameTimes;
+	std::vector<unsigned long long> allocations = result.Allocations;
+	std::sort(times.begin(), times.end());
+	std::sort(allocations.begin(), allocations.end());
+
+	double meanAllocations = 0.0;
+	for (auto count : allocations)
+		meanAllocations += (double)count;
+	if (!allocations.empty())
+		meanAllocations /= allocations.size();
+
+	std::fprintf(file,
+				 "\t\t{\n"
+				 "\t\t\t\"layers\": %u,\n"
+				 "\t\t\t\"events_per_frame\": %u,\n"
+				 "\t\t\t\"frames\": %zu,\n"
+				 "\t\t\t\"frame_time_ms\": { \"min\": %.6f, \"median\": %.6f, \"p99\": %.6f, \"max\": %.6f },\n"
+				 "\t\t\t\"allocations_per_frame\": { \"min\": %llu, \"mean\": %.3f, \"median\": %llu, \"p99\": %llu, \"max\": %llu },\n"
+				 "\t\t\t\"frame_arena\": { \"allocations_per_frame\": %.3f, \"peak_bytes\": %llu, \"overflows\": %llu },\n"
+				 "\t\t\t\"pacing\": { \"missed_deadlines\": %llu, \"wake_error_us\": { \"mean\": %.3f, \"max\": %.3f }, \"deadline_error_us\": %.3f, \"slept_ms\": %.3f, \"spun_ms\": %.3f }\n"
+				 "\t\t}%s\n",
+				 result.LayerCount, result.EventsPerFrame, times.size(),
+				 times.empty() ? 0.0 : times.front(), Percentile(times, 50.0), Percentile(times, 99.0), times.empty() ? 0.0 : times.back(),
+				 allocations.empty() ? 0ull : allocations.front(), meanAllocations, Percentile(allocations, 50.0),
+				 Percentile(allocations, 99.0), allocations.empty() ? 0ull : allocations.back(),
+				 times.empty() ? 0.0 : (double)result.FrameArenaAllocations / times.size(), result.FrameArenaPeak, result.FrameArenaOverflows,
+				 result.Pacing.MissedDeadlines, result.Pacing.MeanWakeErrorUs, result.Pacing.MaxWakeErrorUs, result.Pacing.MeanDeadlineErrorUs,
+				 result.Pacing.SleptMs, result.Pacing.SpunMs,
+				 last ? "" : ",");
+}
+
+int main(int argc, char ** argv) {
+	BenchConfig config;
+	if (!ParseArgs(argc, argv, config))
+		return -1;
+
+	Timer::SetFixedDeltaTime(config.FixedDeltaTime);
+
+	std::unique_ptr<LogFileSink> logSink;
+	if (!config.LogPath.empty()) {
+		bool binary = config.LogPath.size() > 6 && config.LogPath.compare(config.LogPath.size() - 6, 6, ".pvlog") == 0;
+		logSink = std::make_unique<LogFileSink>(LogFileSinkDesc(config.LogPath, binary));
+	}
+
+	// Zones would be timed along with the frame
+#ifdef PV_PROFILER_ENABLED
+	Profiler::SetEnabled(config.Profile);
+#endif
+
+	BenchApp * app = new BenchApp(config);
+	if (!app->IsAppReady) {
+		PV_POST_FATAL("Unable to initialize engine");
+		delete app;
+		return -1;
+	}
+
+	std::vector<BenchResult> results;
+	for (unsigned int layerCount : config.LayerCounts) {
+		for (unsigned int eventCount : config.EventCounts) {
+			BenchResult result;
+			result.LayerCount = layerCount;
+			result.EventsPerFrame = eventCount;
+
+			if (!app->RunScenario(config, result)) {
+				delete app;
+				return -1;
+			}
+			results.push_back(std::move(result));
+		}
+	}
+	delete app;
+
+	FILE * file = stdout;
+	if (!config.OutputPath.empty()) {
+		file = std::fopen(config.OutputPath.c_str(), "w");
+		if (!file) {
+			PV_POST_ERROR("Unable to open " + config.OutputPath);
+			return -1;
+		}
+	}
+
+	std::fprintf(file,
+				 "{\n"
+				 "\t\"frames\": %u,\n"
+				 "\t\"warmup_frames\": %u,\n"
+				 "\t\"fixed_dt\": %f,\n"
+				 "\t\"scenarios\": [\n",
+				 config.Frames, config.WarmupFrames, config.FixedDeltaTime);
+	for (size_t i = 0; i < results.size(); i++)
+		WriteResult(file, results[i], i + 1 == results.size());
+	std::fprintf(file, "\t]\n}\n");
+
+	if (file != stdout)
+		std::fclose(file);
+
+	// Lets CI catch a hot path that went back to the heap
+	int exitCode = 0;
+	if (config.MaxAllocations >= 0) {
+		for (auto & result : results) {
+			unsigned long long worst = result.Allocations.empty() ? 0 : *std::max_element(result.Allocations.begin(), result.Allocations.end());
+			if (worst > (unsigned long long)config.MaxAllocations || result.FrameArenaOverflows > 0) {
+				std::fprintf(stderr, "[%u layers, %u events] %llu heap allocations in a frame (max %lld), %llu frame arena overflows\n",
+							 result.LayerCount, result.EventsPerFrame, worst, config.MaxAllocations, result.FrameArenaOverflows);
+				exitCode = 2;
+			}
+		}
+	}
+
+	return exitCode;
+}
@@ -0,0 +1,415 @@
+#include "prev.h"
+
+#include "engine/jobs/jobsystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace prev;
+
+// Compares the ECS against game objects kept the ad-hoc way, one heap object per entity updated through a virtual call
+// Runs at 10k, 100k and 1M entities: creating them, updating them on one thread, a frame of systems on one thread and on
+// every core, and adding / removing a component through command buffers
+// Usage: PrevEcsBench [--entities N] [--frames N] [--repeats N] [--out file.json]
+// Exits with 1 when the ECS and the objects don't end up with the same positions, or systems lose entities or leave a
+// different world on every core than on one
+
+struct EcsBenchConfig {
+	std::vector<unsigned int> EntityCounts = { 10000, 100000, 1000000 };
+	unsigned int Frames = 10;		// Per systems run
+	unsigned int Repeats = 5;
+	std::string OutputPath;
+};
+
+struct EcsBenchResult {
+	const char * Name;
+	const char * Variant;
+	unsigned int Entities;
+	unsigned int Threads;
+	double BestMs;
+	double MedianMs;
+	double NsPerEntity;
+};
+
+struct Position {
+	float X, Y, Z;
+};
+
+struct Velocity {
+	float X, Y, Z;
+};
+
+struct Spin {
+	float Angle, Speed;
+};
+
+struct Lifetime {
+	float Left;
+};
+
+// Tag, entities that have it are skipped by the movement
+struct Frozen {
+};
+
+static const float s_DeltaTime = 1.0f / 60.0f;
+
+static bool ParseArgs(int argc, char ** argv, EcsBenchConfig & config) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+			return false;
+		}
+		const char * value = argv[++i];
+		if (arg == "--entities")		config.EntityCounts = { (unsigned int)std::strtoul(value, nullptr, 10) };
+		else if (arg == "--frames")		config.Frames = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--repeats")	config.Repeats = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--out")		config.OutputPath = value;
+		else {
+			std::fprintf(stderr, "Unknown argument %s\n"
+						 "Usage: PrevEcsBench [--entities N] [--frames N] [--repeats N] [--out file.json]\n",
+						 arg.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+static unsigned int EntityRandom(unsigned int index) {
+	unsigned int random = index * 2654435761u + 1;
+	random ^= random << 13;
+	random ^= random >> 17;
+	random ^= random << 5;
+	return random;
+}
+
+// In [-1, 1)
+static float RandomFloat(unsigned int index, unsigned int salt) {
+	return (float)(EntityRandom(index * 8 + salt) >> 8) / 8388608.0f - 1.0f;
+}
+
+static Position MakePosition(unsigned int index) {
+	return { RandomFloat(index, 0) * 100.0f, RandomFloat(index, 1) * 100.0f, RandomFloat(index, 2) * 100.0f };
+}
+
+static Velocity MakeVelocity(unsigned int index) {
+	return { RandomFloat(index, 3), RandomFloat(index, 4), RandomFloat(index, 5) };
+}
+
+static Spin MakeSpin(unsigned int index) {
+	return { 0.0f, RandomFloat(index, 6) * 3.0f };
+}
+
+// 1 to 10 seconds, a few entities are replaced every frame
+static Lifetime MakeLifetime(unsigned int index) {
+	return { RandomFloat(index, 7) * 4.5f + 5.5f };
+}
+
+// What the ECS replaces, game state in objects reached through pointers
+class GameObject {
+public:
+	virtual ~GameObject() = default;
+	virtual void Update(float deltaTime) = 0;
+};
+
+class Mover : public GameObject {
+public:
+	Mover(unsigned int index) :
+		m_Position(MakePosition(index)), m_Velocity(MakeVelocity(index)), m_Spin(MakeSpin(index)), m_Lifetime(MakeLifetime(index)) {
+	}
+
+	virtual void Update(float deltaTime) override {
+		m_Position.X += m_Velocity.X * deltaTime;
+		m_Position.Y += m_Velocity.Y * deltaTime;
+		m_Position.Z += m_Velocity.Z * deltaTime;
+		m_Spin.Angle += m_Spin.Speed * deltaTime;
+	}
+
+	inline const Position & GetPosition() const { return m_Position; }
+private:
+	Position m_Position;
+	Velocity m_Velocity;
+	Spin m_Spin;
+	Lifetime m_Lifetime;
+};
+
+class MoveSystem : public System {
+public:
+	MoveSystem() : System("MoveSystem") {
+		Reads<Velocity>();
+		Writes<Position>();
+		m_Query.Without<Frozen>();
+	}
+private:
+	virtual void OnUpdate(World & world, float deltaTime) override {
+		m_Query.ParallelForEach(world, [deltaTime](Position & position, const Velocity & velocity) -> void {
+			position.X += velocity.X * deltaTime;
+			position.Y += velocity.Y * deltaTime;
+			position.Z += velocity.Z * deltaTime;
+		});
+	}
+
+	Query<Position, const Velocity> m_Query;
+};
+
+class SpinSystem : public System {
+public:
+	SpinSystem() : System("SpinSystem") {
+		Writes<Spin>();
+	}
+private:
+	virtual void OnUpdate(World & world, float deltaTime) override {
+		m_Query.ParallelForEach(world, [deltaTime](Spin & spin) -> void {
+			spin.Angle += spin.Speed * deltaTime;
+		});
+	}
+
+	Query<Spin> m_Query;
+};
+
+// Entities that run out of time are replaced by new ones, through the command buffer of whichever thread saw them
+class AgeSystem : public System {
+public:
+	AgeSystem() : System("AgeSystem") {
+		Writes<Lifetime>();
+	}
+private:
+	virtual void OnUpdate(World & world, float deltaTime) override {
+		World * target = &world;
+		m_Query.ParallelForEach(world, [target, deltaTime](Entity entity, Lifetime & lifetime) -> void {
+			lifetime.Left -= deltaTime;
+			if (lifetime.Left > 0.0f)
+				return;
+			EntityCommandBuffer & commands = target->GetCommandBuffer();
+			commands.Destroy(entity);
+			commands.Create(MakePosition(entity.Index), MakeVelocity(entity.Index), MakeSpin(entity.Index), MakeLifetime(entity.Index + entity.Generation));
+		});
+	}
+
+	Query<Lifetime> m_Query;
+};
+
+// Conflicts with MoveSystem, so it runs in the level after it
+class BounceSystem : public System {
+public:
+	BounceSystem() : System("BounceSystem") {
+		Reads<Position>();
+		Writes<Velocity>();
+	}
+private:
+	virtual void OnUpdate(World & world, float deltaTime) override {
+		m_Query.ParallelForEach(world, [](const Position & position, Velocity & velocity) -> void {
+			if (position.X < -100.0f || position.X > 100.0f)
+				velocity.X = -velocity.X;
+			if (position.Y < -100.0f || position.Y > 100.0f)
+				velocity.Y = -velocity.Y;
+			if (position.Z < -100.0f || position.Z > 100.0f)
+				velocity.Z = -velocity.Z;
+		});
+	}
+
+	Query<const Position, Velocity> m_Query;
+};
+
+template<typename Scenario>
+static EcsBenchResult Measure(const EcsBenchConfig & config, const char * name, const char * variant, unsigned int entities, unsigned int threads, unsigned int operations, Scenario && scenario) {
+	std::vector<double> times;
+	for (unsigned int repeat = 0; repeat < config.Repeats + 1; repeat++) {
+		double ms = scenario();
+		// First run warms the caches and the chunk pool
+		if (repeat > 0)
+			times.push_back(ms);
+	}
+
+	std::sort(times.begin(), times.end());
+	double median = times[times.size() / 2];
+	return { name, variant, entities, threads, times.front(), median, median * 1000000.0 / operations };
+}
+
+template<typename F>
+static double Time(F && func) {
+	auto start = std::chrono::steady_clock::now();
+	func();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static void Populate(World & world, unsigned int count) {
+	for (unsigned int i = 0; i < count; i++)
+		world.Create(MakePosition(i), MakeVelocity(i), MakeSpin(i), MakeLifetime(i));
+}
+
+static void Populate(std::vector<std::unique_ptr<GameObject>> & objects, unsigned int count) {
+	objects.clear();
+	objects.reserve(count);
+	for (unsigned int i = 0; i < count; i++)
+		objects.emplace_back(new Mover(i));
+}
+
+// Creating and updating on one thread, both ways. Returns false when they don't agree on where things went
+static bool RunSingleThreaded(const EcsBenchConfig & config, unsigned int count, std::vector<EcsBenchResult> & results) {
+	results.push_back(Measure(config, "create", "ecs", count, 1, count, [count]() -> double {
+		World world;
+		return Time([&]() { Populate(world, count); });
+	}));
+	results.push_back(Measure(config, "create", "objects", count, 1, count, [count]() -> double {
+		std::vector<std::unique_ptr<GameObject>> objects;
+		return Time([&]() { Populate(objects, count); });
+	}));
+
+	World world;
+	Populate(world, count);
+	std::vector<std::unique_ptr<GameObject>> objects;
+	Populate(objects, count);
+
+	Query<Position, const Velocity, Spin> query;
+	results.push_back(Measure(config, "update", "ecs", count, 1, count, [&]() -> double {
+		return Time([&]() {
+			query.ForEach(world, [](Position & position, const Velocity & velocity, Spin & spin) -> void {
+				position.X += velocity.X * s_DeltaTime;
+				position.Y += velocity.Y * s_DeltaTime;
+				position.Z += velocity.Z * s_DeltaTime;
+				spin.Angle += spin.Speed * s_DeltaTime;
+			});
+		});
+	}));
+	results.push_back(Measure(config, "update", "objects", count, 1, count, [&]() -> double {
+		return Time([&]() {
+			for (auto & object : objects)
+				object->Update(s_DeltaTime);
+		});
+	}));
+
+	// Same updates in the same order, entity i is object i since nothing was destroyed
+	bool same = true;
+	Query<const Position> positions;
+	positions.ForEach(world, [&](Entity entity, const Position & position) -> void {
+		const Position & expected = ((const Mover *)objects[entity.Index].get())->GetPosition();
+		same &= std::memcmp(&position, &expected, sizeof(Position)) == 0;
+	});
+	if (!same)
+		std::fprintf(stderr, "ECS and objects disagree on positions with %u entities\n", count);
+	return same;
+}
+
+// Every entity and its components in chunk order, entities that got another index or chunk change it too
+static unsigned long long Checksum(World & world) {
+	unsigned long long hash = 14695981039346656037ull;
+	auto mix = [&hash](const void * data, size_t size) -> void {
+		for (size_t i = 0; i < size; i++)
+			hash = (hash ^ ((const unsigned char *)data)[i]) * 1099511628211ull;
+	};
+	Query<const Position, const Lifetime> query;
+	query.ForEach(world, [&](Entity entity, const Position & position, const Lifetime & lifetime) -> void {
+		mix(&entity, sizeof(Entity));
+		mix(&position, sizeof(Position));
+		mix(&lifetime, sizeof(Lifetime));
+	});
+	return hash;
+}
+
+// Frames of the four systems, returns false when the world doesn't hold count entities afterwards
+static bool RunSystems(const EcsBenchConfig & config, unsigned int count, unsigned int threads, std::vector<EcsBenchResult> & results, unsigned long long & checksum) {
+	JobSystem jobSystem(threads);
+	World world(&jobSystem);
+	Populate(world, count);
+
+	SystemScheduler systems;
+	systems.Add<MoveSystem>();
+	systems.Add<SpinSystem>();
+	systems.Add<AgeSystem>();
+	systems.Add<BounceSystem>();
+
+	results.push_back(Measure(config, "systems", "ecs", count, threads, count * config.Frames, [&]() -> double {
+		return Time([&]() {
+			for (unsigned int frame = 0; frame < config.Frames; frame++)
+				systems.Run(world, s_DeltaTime);
+		});
+	}));
+
+	// A tenth of the entities get frozen, the ones frozen before thaw
+	std::vector<Entity> entities;
+	Query<const Lifetime> all;
+	all.ForEach(world, [&](Entity entity, const Lifetime &) -> void {
+		entities.push_back(entity);
+	});
+	unsigned int round = 0;
+	results.push_back(Measure(config, "churn", "ecs", count, threads, std::max(1u, count / 5), [&]() -> double {
+		return Time([&]() {
+			EntityCommandBuffer & commands = world.GetCommandBuffer();
+			for (size_t i = round % 10; i < entities.size(); i += 10)
+				commands.Add(entities[i], Frozen());
+			for (size_t i = (round + 9) % 10; i < entities.size(); i += 10)
+				commands.Remove<Frozen>(entities[i]);
+			world.PlayBack();
+			round++;
+		});
+	}));
+
+	if (world.GetEntityCount() != count) {
+		std::fprintf(stderr, "Systems left %u entities out of %u with %u threads\n", world.GetEntityCount(), count, threads);
+		return false;
+	}
+	checksum = Checksum(world);
+	return true;
+}
+
+int main(int argc, char ** argv) {
+	EcsBenchConfig config;
+	if (!ParseArgs(argc, argv, config) || config.Repeats == 0 || config.Frames == 0)
+		return -1;
+
+	int exitCode = 0;
+	std::vector<EcsBenchResult> results;
+	unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int count : config.EntityCounts) {
+		if (count == 0)
+			continue;
+		if (!RunSingleThreaded(config, count, results))
+			exitCode = 1;
+		unsigned long long checksum = 0, threadedChecksum = 0;
+		if (!RunSystems(config, count, 1, results, checksum))
+			exitCode = 1;
+		if (maxThreads > 1 && !RunSystems(config, count, maxThreads, results, threadedChecksum))
+			exitCode = 1;
+		else if (maxThreads > 1 && threadedChecksum != checksum) {
+			std::fprintf(stderr, "Systems leave a different world with %u threads and %u entities\n", maxThreads, count);
+			exitCode = 1;
+		}
+	}
+
+	FILE * file = stdout;
+	if (!config.OutputPath.empty()) {
+		file = std::fopen(config.OutputPath.c_str(), "w");
+		if (!file) {
+			std::fprintf(stderr, "Unable to open %s\n", config.OutputPath.c_str());
+			return -1;
+		}
+	}
+
+	std::fprintf(file,
+				 "{\n"
+				 "\t\"frames\": %u,\n"
+				 "\t\"repeats\": %u,\n"
+				 "\t\"scenarios\": [\n",
+				 config.Frames, config.Repeats);
+	for (size_t i = 0; i < results.size(); i++) {
+		const EcsBenchResult & result = results[i];
+		std::fprintf(file, "\t\t{ \"scenario\": \"%s\", \"variant\": \"%s\", \"entities\": %u, \"threads\": %u, \"best_ms\": %.6f, \"median_ms\": %.6f, \"ns_per_entity\": %.3f }%s\n",
+					 result.Name, result.Variant, result.Entities, result.Threads, result.BestMs, result.MedianMs, result.NsPerEntity,
+					 i + 1 == results.size() ? "" : ",");
+	}
+	std::fprintf(file, "\t]\n}\n");
+
+	if (file != stdout)
+		std::fclose(file);
+
+	return exitCode;
+}
\ No newline at end of file
@@ -4,10 +4,24 @@
 #if defined(PV_RENDERING_API_DIRECTX) || defined(PV_RENDERING_API_BOTH)
 
 #include "platform/gethwnd.h"
+#include "engine/render/commandbuffer.h"
 
 #define CHECK_AND_POST_ERROR(hr, string, ...) { if (FAILED(hr)) { PV_POST_ERROR(string); __VA_ARGS__; return false; }}
 
 namespace prev {
+
+	static SetViewportCommand ToViewportCommand(const D3D11_VIEWPORT & viewport) {
+		SetViewportCommand command = {};
+		command.Type		= SetViewportCommand::CommandType;
+		command.X			= viewport.TopLeftX;
+		command.Y			= viewport.TopLeftY;
+		command.Width		= viewport.Width;
+		command.Height		= viewport.Height;
+		command.MinDepth	= viewport.MinDepth;
+		command.MaxDepth	= viewport.MaxDepth;
+		return command;
+	}
+
 	GraphicsAPI * GraphicsAPI::UseDirectX(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc) {
 		DirectXAPI * api = new DirectXAPI(windowRawPointer, windowApi, graphicsDesc);
 
@@ -65,6 +79,52 @@ namespace prev {
 		return;
 	}
 
+	void DirectXAPI::Submit(const RenderQueue & queue) {
+		// ImGui's renderer and resizes bind their own state between submits
+		m_StateCache.Invalidate();
+		for (const RenderSortEntry & entry : queue.GetSorted()) {
+			switch (*entry.Command) {
+			case RenderCommandType::Clear:
+			{
+				const ClearCommand & clear = RenderCommandCast<ClearCommand>(entry.Command);
+				if (clear.Flags & ClearColor)
+					m_Data.DeviceContext->ClearRenderTargetView(m_Data.RenderTarget.Get(), clear.Color);
+				UINT depthFlags = ((clear.Flags & ClearDepth) ? D3D11_CLEAR_DEPTH : 0) | ((clear.Flags & ClearStencil) ? D3D11_CLEAR_STENCIL : 0);
+				if (depthFlags != 0)
+					m_Data.DeviceContext->ClearDepthStencilView(m_Data.DepthStencilView.Get(), depthFlags, clear.Depth, clear.Stencil);
+				break;
+			}
+			case RenderCommandType::SetRenderTarget:
+			{
+				// Only the back buffer can be rendered to for now
+				unsigned int renderTarget = RenderCommandCast<SetRenderTargetCommand>(entry.Command).RenderTarget;
+				if (renderTarget == 0 && m_StateCache.SetRenderTarget(renderTarget))
+					m_Data.DeviceContext->OMSetRenderTargets(1, m_Data.RenderTarget.GetAddressOf(), m_Data.DepthStencilView.Get());
+				break;
+			}
+			case RenderCommandType::SetViewport:
+			{
+				const SetViewportCommand & command = RenderCommandCast<SetViewportCommand>(entry.Command);
+				if (!m_StateCache.SetViewport(command))
+					break;
+				D3D11_VIEWPORT viewport;
+				viewport.TopLeftX	= command.X;
+				viewport.TopLeftY	= command.Y;
+				viewport.Width		= command.Width;
+				viewport.Height		= command.Height;
+				viewport.MinDepth	= command.MinDepth;
+				viewport.MaxDepth	= command.MaxDepth;
+				m_Data.DeviceContext->RSSetViewports(1, &viewport);
+				break;
+			}
+			case RenderCommandType::Draw:
+				// Pipelines and buffers aren't created through the api yet, there is nothing to bind the ids to
+				break;
+			}
+		}
+		m_StateCache.EndFrame();
+	}
+
 	void DirectXAPI::OnEvent(Event & e) {
 	}
 
@@ -129,6 +189,7 @@ namespace prev {
 		CHECK_AND_POST_ERROR(hr, "Unable to resize target!");
 
 		m_Data.DeviceContext->ClearState();
+		m_StateCache.Invalidate();
 		m_Data.RenderTarget			= nullptr;
 		m_Data.DepthStencilBuffer	= nullptr;
 		m_Data.DepthStencilState	= nullptr;
@@ -156,7 +217,8 @@ namespace prev {
 		hr = CreateDepthStencilView();
 		CHECK_AND_POST_ERROR(hr, "Unable to create depth stencil view");
 
-		m_Data.DeviceContext->OMSetRenderTargets(1, m_Data.RenderTarget.GetAddressOf(), m_Data.DepthStencilView.Get());
+		if (m_StateCache.SetRenderTarget(0))
+			m_Data.DeviceContext->OMSetRenderTargets(1, m_Data.RenderTarget.GetAddressOf(), m_Data.DepthStencilView.Get());
 
 		hr = CreateRasterizerState();
 		CHECK_AND_POST_ERROR(hr, "Unable to create rasterizer state");
@@ -166,7 +228,8 @@ namespace prev {
 		D3D11_VIEWPORT viewport = CreateViewport(m_Data.AllDisplayModes[m_Data.CurrentModeDescriptionIndex].Width,
 												 m_Data.AllDisplayModes[m_Data.CurrentModeDescriptionIndex].Height);
 
-		m_Data.DeviceContext->RSSetViewports(1, &viewport);
+		if (m_StateCache.SetViewport(ToViewportCommand(viewport)))
+			m_Data.DeviceContext->RSSetViewports(1, &viewport);
 
 		return false;
 	}
@@ -317,7 +380,8 @@ namespace prev {
 		hr = CreateDepthStencilView();
 		CHECK_AND_POST_ERROR(hr, "Unable to create depth stencil view");
 
-		m_Data.DeviceContext->OMSetRenderTargets(1, m_Data.RenderTarget.GetAddressOf(), m_Data.DepthStencilView.Get());
+		if (m_StateCache.SetRenderTarget(0))
+			m_Data.DeviceContext->OMSetRenderTargets(1, m_Data.RenderTarget.GetAddressOf(), m_Data.DepthStencilView.Get());
 
 		hr = CreateRasterizerState();
 		CHECK_AND_POST_ERROR(hr, "Unable to create rasterizer state");
@@ -326,7 +390,8 @@ namespace prev {
 
 		D3D11_VIEWPORT viewport = CreateViewport(width, height);
 
-		m_Data.DeviceContext->RSSetViewports(1, &viewport);
+		if (m_StateCache.SetViewport(ToViewportCommand(viewport)))
+			m_Data.DeviceContext->RSSetViewports(1, &viewport);
 
 		return true;
 	}
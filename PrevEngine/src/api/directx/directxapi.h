@@ -17,6 +17,7 @@ namespace prev {
 		virtual void SetFullscreen(bool fullscreen) override;
 		virtual void ChangeResolution(int index) override;
 		virtual std::vector<std::pair<unsigned int, unsigned int>> GetSupportedResolution() override;
+		virtual void Submit(const RenderQueue & queue) override;
 	private:
 		bool ChangeWindowResolution(int index);
 	private:
@@ -0,0 +1,103 @@
+#include "pch.h"
+#include "nullapi.h"
+
+#include "engine/render/commandbuffer.h"
+
+namespace prev {
+
+	GraphicsAPI * GraphicsAPI::UseNull(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc) {
+		return new NullAPI(windowRawPointer, windowApi, graphicsDesc);
+	}
+
+	NullAPI::NullAPI(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc) {
+		m_Data.Width = graphicsDesc.Width;
+		m_Data.Height = graphicsDesc.Height;
+		m_Data.Vsync = graphicsDesc.Vsync;
+		m_Data.Fullscreen = graphicsDesc.Fullscreen;
+
+		m_RenderingAPI = RenderingAPI::RENDERING_API_NULL;
+	}
+
+	NullAPI::~NullAPI() {
+	}
+
+	void NullAPI::StartFrame() {
+	}
+
+	void NullAPI::EndFrame() {
+		if (m_Data.PresentDelay > 0.0f)
+			std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(m_Data.PresentDelay));
+	}
+
+	void NullAPI::OnEvent(Event & e) {
+		EventDispatcher dispatcher(e);
+		dispatcher.Dispatch(this, &NullAPI::WindowSizeChanged);
+	}
+
+	void NullAPI::ChangeResolution(int index) {
+	}
+
+	void NullAPI::SetFullscreen(bool fullscreen) {
+		m_Data.Fullscreen = fullscreen;
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int>> NullAPI::GetSupportedResolution() {
+		return { std::make_pair(m_Data.Width, m_Data.Height) };
+	}
+
+	void NullAPI::Submit(const RenderQueue & queue) {
+		m_Data.SubmittedCommands = queue.GetCommandCount();
+		m_Data.SubmittedDraws = 0;
+		m_Data.SubmittedPrimitives = 0;
+		m_Data.Calls.clear();
+
+		auto call = [this](RenderState state, unsigned int slot, unsigned int value) -> void {
+			if (m_Data.RecordCalls)
+				m_Data.Calls.push_back({ state, slot, value });
+		};
+
+		m_StateCache.Invalidate();
+		for (const RenderSortEntry & entry : queue.GetSorted()) {
+			switch (*entry.Command) {
+			case RenderCommandType::Clear:
+				break;
+			case RenderCommandType::SetRenderTarget:
+			{
+				unsigned int renderTarget = RenderCommandCast<SetRenderTargetCommand>(entry.Command).RenderTarget;
+				if (m_StateCache.SetRenderTarget(renderTarget))
+					call(RenderState::RenderTarget, 0, renderTarget);
+				break;
+			}
+			case RenderCommandType::SetViewport:
+				if (m_StateCache.SetViewport(RenderCommandCast<SetViewportCommand>(entry.Command)))
+					call(RenderState::Viewport, 0, 0);
+				break;
+			case RenderCommandType::Draw:
+			{
+				const DrawCommand & draw = RenderCommandCast<DrawCommand>(entry.Command);
+				if (m_StateCache.SetPipeline(draw.Pipeline))
+					call(RenderState::Pipeline, 0, draw.Pipeline);
+				if (m_StateCache.SetVertexBuffer(draw.VertexBuffer))
+					call(RenderState::VertexBuffer, 0, draw.VertexBuffer);
+				if (draw.IndexBuffer != 0 && m_StateCache.SetIndexBuffer(draw.IndexBuffer))
+					call(RenderState::IndexBuffer, 0, draw.IndexBuffer);
+				for (unsigned int i = 0; i < DrawCommand::MaxTextures; i++) {
+					if (m_StateCache.SetTexture(i, draw.Textures[i]))
+						call(RenderState::Texture, i, draw.Textures[i]);
+				}
+				m_Data.SubmittedDraws++;
+				m_Data.SubmittedPrimitives += (unsigned long long)draw.Count * std::max(draw.InstanceCount, 1u);
+				break;
+			}
+			}
+		}
+		m_StateCache.EndFrame();
+	}
+
+	bool NullAPI::WindowSizeChanged(WindowResizeEvent & e) {
+		m_Data.Width = e.GetWidth();
+		m_Data.Height = e.GetHeight();
+		return false;
+	}
+
+}
\ No newline at end of file
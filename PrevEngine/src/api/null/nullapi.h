@@ -0,0 +1,56 @@
+#pragma once
+
+#include "engine/graphicsapi.h"
+
+namespace prev {
+
+	// A state change the null api would have made, Value is the bound id (0 for viewports)
+	struct NullAPICall {
+		RenderState State;
+		unsigned int Slot;
+		unsigned int Value;
+	};
+
+	// Graphics api that makes no GPU calls
+	// Lets the frame loop run on machines without a GPU or a display
+	class NullAPI : public GraphicsAPI {
+	public:
+		NullAPI(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc);
+		~NullAPI();
+
+		virtual void StartFrame() override;
+		virtual void EndFrame() override;
+
+		virtual void OnEvent(Event & e) override;
+		virtual void ChangeResolution(int index) override;
+		virtual void SetFullscreen(bool fullscreen) override;
+		virtual std::vector<std::pair<unsigned int, unsigned int>> GetSupportedResolution() override;
+		// Reads every command and binds through the state cache like a real backend would, without making any calls
+		virtual void Submit(const RenderQueue & queue) override;
+
+		// Keeps the state changes each Submit lets through, to see what the cache filters without a GPU
+		inline void SetRecordCalls(bool record) { m_Data.RecordCalls = record; }
+		inline const std::vector<NullAPICall> & GetRecordedCalls() const { return m_Data.Calls; }
+
+		// Makes EndFrame block like a real Present would, to test frame pipelining without a GPU
+		inline void SetPresentDelay(float milliseconds) { m_Data.PresentDelay = milliseconds; }
+	private:
+		bool WindowSizeChanged(WindowResizeEvent & e);
+	public:
+		struct NullGraphicsData {
+			unsigned int Width;
+			unsigned int Height;
+			bool Vsync;
+			bool Fullscreen;
+			float PresentDelay = 0.0f;	// In ms
+			// Last submitted queue
+			unsigned int SubmittedCommands = 0;
+			unsigned int SubmittedDraws = 0;
+			unsigned long long SubmittedPrimitives = 0;	// Vertices or indices times instances
+			bool RecordCalls = false;
+			std::vector<NullAPICall> Calls;
+		};
+		NullGraphicsData m_Data;
+	};
+
+}
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <glad/glad_wgl.h>
 
 #include "platform/gethwnd.h"
+#include "engine/render/commandbuffer.h"
 
 namespace prev {
 
@@ -62,9 +63,84 @@ namespace prev {
 		SwapBuffers(m_Data.HandleToDeviceContext);
 	}
 
+	void OpenGLAPI::Submit(const RenderQueue & queue) {
+		// ImGui's renderer and resizes bind their own state between submits
+		m_StateCache.Invalidate();
+		for (const RenderSortEntry & entry : queue.GetSorted()) {
+			switch (*entry.Command) {
+			case RenderCommandType::Clear:
+			{
+				const ClearCommand & clear = RenderCommandCast<ClearCommand>(entry.Command);
+				GLbitfield mask = 0;
+				if (clear.Flags & ClearColor) {
+					glClearColor(clear.Color[0], clear.Color[1], clear.Color[2], clear.Color[3]);
+					mask |= GL_COLOR_BUFFER_BIT;
+				}
+				if (clear.Flags & ClearDepth) {
+					glClearDepth(clear.Depth);
+					mask |= GL_DEPTH_BUFFER_BIT;
+				}
+				if (clear.Flags & ClearStencil) {
+					glClearStencil(clear.Stencil);
+					mask |= GL_STENCIL_BUFFER_BIT;
+				}
+				glClear(mask);
+				break;
+			}
+			case RenderCommandType::SetRenderTarget:
+			{
+				unsigned int renderTarget = RenderCommandCast<SetRenderTargetCommand>(entry.Command).RenderTarget;
+				if (m_StateCache.SetRenderTarget(renderTarget))
+					glBindFramebuffer(GL_FRAMEBUFFER, renderTarget);
+				break;
+			}
+			case RenderCommandType::SetViewport:
+			{
+				const SetViewportCommand & viewport = RenderCommandCast<SetViewportCommand>(entry.Command);
+				if (!m_StateCache.SetViewport(viewport))
+					break;
+				glViewport((GLint)viewport.X, (GLint)viewport.Y, (GLsizei)viewport.Width, (GLsizei)viewport.Height);
+				glDepthRange(viewport.MinDepth, viewport.MaxDepth);
+				break;
+			}
+			case RenderCommandType::Draw:
+			{
+				const DrawCommand & draw = RenderCommandCast<DrawCommand>(entry.Command);
+				if (draw.Pipeline == 0)	// Nothing to draw with
+					break;
+				if (m_StateCache.SetPipeline(draw.Pipeline))
+					glUseProgram(draw.Pipeline);
+				// The element buffer binding belongs to the vertex array, rebinding one brings its own back
+				if (m_StateCache.SetVertexBuffer(draw.VertexBuffer)) {
+					glBindVertexArray(draw.VertexBuffer);
+					m_StateCache.Invalidate(RenderState::IndexBuffer);
+				}
+				for (unsigned int i = 0; i < DrawCommand::MaxTextures; i++) {
+					if (!m_StateCache.SetTexture(i, draw.Textures[i]))
+						continue;
+					glActiveTexture(GL_TEXTURE0 + i);
+					glBindTexture(GL_TEXTURE_2D, draw.Textures[i]);
+				}
+
+				GLsizei instances = (GLsizei)std::max(draw.InstanceCount, 1u);
+				if (draw.IndexBuffer != 0) {
+					if (m_StateCache.SetIndexBuffer(draw.IndexBuffer))
+						glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, draw.IndexBuffer);
+					glDrawElementsInstancedBaseVertex(GL_TRIANGLES, draw.Count, GL_UNSIGNED_INT,
+													  (const void *)(draw.First * sizeof(unsigned int)), instances, draw.BaseVertex);
+				} else {
+					glDrawArraysInstanced(GL_TRIANGLES, draw.First, draw.Count, instances);
+				}
+				break;
+			}
+			}
+		}
+		m_StateCache.EndFrame();
+	}
+
 	void OpenGLAPI::OnEvent(Event & e) {
 		EventDispatcher dispatcher(e);
-		dispatcher.Dispatch<WindowResizeEvent>(BIND_EVENT_FN(OpenGLAPI::WindowSizeChanged));
+		dispatcher.Dispatch(this, &OpenGLAPI::WindowSizeChanged);
 	}
 
 	void OpenGLAPI::ChangeResolution(int index) {
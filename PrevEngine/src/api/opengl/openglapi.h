@@ -18,6 +18,10 @@ namespace prev {
 		virtual void ChangeResolution(int index) override;
 		virtual void SetFullscreen(bool fullscreen) override;
 		virtual std::vector<std::pair<unsigned int, unsigned int>> GetSupportedResolution() override;
+		// Ids in the commands are GL object names, vertex buffer is a vertex array object and indices are 32 bit
+		virtual void Submit(const RenderQueue & queue) override;
+		// The GL context stays current on the main thread
+		virtual bool SupportsRenderThread() const override { return false; }
 	private:
 		bool WindowSizeChanged(WindowResizeEvent & e);
 	private:
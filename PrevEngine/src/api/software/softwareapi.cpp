@@ -0,0 +1,172 @@
+#include "pch.h"
+#include "softwareapi.h"
+
+#include "engine/render/commandbuffer.h"
+
+namespace prev {
+
+	static const SoftwarePipelineDesc s_DefaultPipeline;
+
+	GraphicsAPI * GraphicsAPI::UseSoftware(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc) {
+		return new SoftwareAPI(windowRawPointer, windowApi, graphicsDesc);
+	}
+
+	SoftwareAPI::SoftwareAPI(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc) :
+		m_Rasterizer(graphicsDesc.Jobs) {
+		m_Data.Vsync = graphicsDesc.Vsync;
+		m_Data.Fullscreen = graphicsDesc.Fullscreen;
+
+		m_Framebuffer.Resize(graphicsDesc.Width, graphicsDesc.Height);
+		m_Rasterizer.SetTarget(&m_Framebuffer);
+
+		m_RenderingAPI = RenderingAPI::RENDERING_API_SOFTWARE;
+		PV_LOG_INFO("Software rasterizer using %s", SoftwareRasterizer::GetSimdName());
+	}
+
+	SoftwareAPI::~SoftwareAPI() {
+		m_Rasterizer.SetTarget(nullptr);
+	}
+
+	void SoftwareAPI::StartFrame() {
+		const float black[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		m_Rasterizer.Clear(true, true, black, 1.0f);
+	}
+
+	void SoftwareAPI::EndFrame() {
+		m_Rasterizer.Flush();
+	}
+
+	void SoftwareAPI::OnEvent(Event & e) {
+		EventDispatcher dispatcher(e);
+		dispatcher.Dispatch(this, &SoftwareAPI::WindowSizeChanged);
+	}
+
+	void SoftwareAPI::ChangeResolution(int index) {
+	}
+
+	void SoftwareAPI::SetFullscreen(bool fullscreen) {
+		m_Data.Fullscreen = fullscreen;
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int>> SoftwareAPI::GetSupportedResolution() {
+		return { std::make_pair(m_Framebuffer.GetWidth(), m_Framebuffer.GetHeight()) };
+	}
+
+	void SoftwareAPI::Submit(const RenderQueue & queue) {
+		m_Data.SubmittedDraws = 0;
+
+		m_StateCache.Invalidate();
+		for (const RenderSortEntry & entry : queue.GetSorted()) {
+			switch (*entry.Command) {
+			case RenderCommandType::Clear:
+			{
+				const ClearCommand & clear = RenderCommandCast<ClearCommand>(entry.Command);
+				m_Rasterizer.Clear((clear.Flags & ClearColor) != 0, (clear.Flags & ClearDepth) != 0, clear.Color, clear.Depth);
+				break;
+			}
+			case RenderCommandType::SetRenderTarget:
+			{
+				// Only the framebuffer, there are no render target resources
+				unsigned int renderTarget = RenderCommandCast<SetRenderTargetCommand>(entry.Command).RenderTarget;
+				if (renderTarget != 0)
+					PV_LOG_WARN("Software api has no render target %u, drawing to the framebuffer", renderTarget);
+				if (m_StateCache.SetRenderTarget(0))
+					m_Rasterizer.SetTarget(&m_Framebuffer);
+				break;
+			}
+			case RenderCommandType::SetViewport:
+			{
+				const SetViewportCommand & viewport = RenderCommandCast<SetViewportCommand>(entry.Command);
+				if (m_StateCache.SetViewport(viewport))
+					m_Rasterizer.SetViewport(viewport.X, viewport.Y, viewport.Width, viewport.Height, viewport.MinDepth, viewport.MaxDepth);
+				break;
+			}
+			case RenderCommandType::Draw:
+				Draw(RenderCommandCast<DrawCommand>(entry.Command));
+				break;
+			}
+		}
+		m_Rasterizer.Flush();
+		m_StateCache.EndFrame();
+	}
+
+	void SoftwareAPI::Draw(const DrawCommand & draw) {
+		if (draw.VertexBuffer == 0 || draw.VertexBuffer > m_VertexBuffers.size()) {
+			PV_LOG_WARN("Software api draw with unknown vertex buffer %u", draw.VertexBuffer);
+			return;
+		}
+		if (draw.IndexBuffer > m_IndexBuffers.size() || draw.Pipeline > m_Pipelines.size()) {
+			PV_LOG_WARN("Software api draw with unknown index buffer %u or pipeline %u", draw.IndexBuffer, draw.Pipeline);
+			return;
+		}
+
+		// Only for the counters, looking resources up is as cheap as checking the cache
+		m_StateCache.SetPipeline(draw.Pipeline);
+		m_StateCache.SetVertexBuffer(draw.VertexBuffer);
+		if (draw.IndexBuffer != 0)
+			m_StateCache.SetIndexBuffer(draw.IndexBuffer);
+
+		const SoftwarePipelineDesc & pipeline = draw.Pipeline != 0 ? m_Pipelines[draw.Pipeline - 1] : s_DefaultPipeline;
+		const std::vector<SoftwareVertex> & vertices = m_VertexBuffers[draw.VertexBuffer - 1];
+		const std::vector<unsigned int> * indices = draw.IndexBuffer != 0 ? &m_IndexBuffers[draw.IndexBuffer - 1] : nullptr;
+		m_Data.SubmittedDraws++;
+
+		// Positions only, the whole buffer since indices can point anywhere in it
+		const float * m = pipeline.Transform;
+		m_Transformed.resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++) {
+			const SoftwareVertex & v = vertices[i];
+			SoftwareVertex & t = m_Transformed[i];
+			t = v;
+			t.X = m[0] * v.X + m[4] * v.Y + m[8] * v.Z + m[12] * v.W;
+			t.Y = m[1] * v.X + m[5] * v.Y + m[9] * v.Z + m[13] * v.W;
+			t.Z = m[2] * v.X + m[6] * v.Y + m[10] * v.Z + m[14] * v.W;
+			t.W = m[3] * v.X + m[7] * v.Y + m[11] * v.Z + m[15] * v.W;
+		}
+
+		// Instances have no per instance data without shaders, so every instance would land on the same pixels
+		const size_t end = (size_t)draw.First + draw.Count / 3 * 3;
+		const size_t available = indices != nullptr ? indices->size() : vertices.size();
+		if (end > available) {
+			PV_LOG_WARN("Software api draw reads past the end of its buffer");
+			return;
+		}
+		for (size_t i = draw.First; i < end; i += 3) {
+			long long index[3];
+			for (unsigned int k = 0; k < 3; k++)
+				index[k] = (indices != nullptr ? (long long)(*indices)[i + k] : (long long)(i + k)) + draw.BaseVertex;
+			if (std::any_of(index, index + 3, [&](long long x) { return x < 0 || x >= (long long)vertices.size(); }))
+				continue;
+			m_Rasterizer.DrawTriangle(m_Transformed[index[0]], m_Transformed[index[1]], m_Transformed[index[2]], pipeline.State);
+		}
+	}
+
+	unsigned int SoftwareAPI::CreateVertexBuffer(const SoftwareVertex * vertices, unsigned int count) {
+		m_VertexBuffers.emplace_back(vertices, vertices + count);
+		return (unsigned int)m_VertexBuffers.size();
+	}
+
+	unsigned int SoftwareAPI::CreateIndexBuffer(const unsigned int * indices, unsigned int count) {
+		m_IndexBuffers.emplace_back(indices, indices + count);
+		return (unsigned int)m_IndexBuffers.size();
+	}
+
+	unsigned int SoftwareAPI::CreatePipeline(const SoftwarePipelineDesc & desc) {
+		m_Pipelines.push_back(desc);
+		return (unsigned int)m_Pipelines.size();
+	}
+
+	bool SoftwareAPI::SaveFramebuffer(const std::string & path) const {
+		return WritePNG(path, m_Framebuffer.ToImage());
+	}
+
+	bool SoftwareAPI::WindowSizeChanged(WindowResizeEvent & e) {
+		if (e.GetWidth() == 0 || e.GetHeight() == 0)
+			return false;
+		m_Rasterizer.Flush();
+		m_Framebuffer.Resize(e.GetWidth(), e.GetHeight());
+		m_Rasterizer.SetTarget(&m_Framebuffer);
+		return false;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "engine/graphicsapi.h"
+#include "softwarerasterizer.h"
+
+namespace prev {
+
+	struct SoftwarePipelineDesc {
+		// Column major, applied to every position before rasterizing since there are no vertex shaders
+		float Transform[16] = {
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		};
+		SoftwareRasterState State;
+	};
+
+	// Graphics api that rasterizes on the CPU into a framebuffer instead of presenting to a window
+	// Frames can be saved as PNGs and compared against golden images, on machines without a GPU
+	// Command ids are the ones Create* returns, 0 is none. Textures are ignored
+	class SoftwareAPI : public GraphicsAPI {
+	public:
+		SoftwareAPI(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc);
+		~SoftwareAPI();
+
+		virtual void StartFrame() override;
+		virtual void EndFrame() override;
+
+		virtual void OnEvent(Event & e) override;
+		virtual void ChangeResolution(int index) override;
+		virtual void SetFullscreen(bool fullscreen) override;
+		virtual std::vector<std::pair<unsigned int, unsigned int>> GetSupportedResolution() override;
+		// Tiles are spread over the job system, which only the main thread can schedule on
+		virtual bool SupportsRenderThread() const override { return false; }
+		virtual void Submit(const RenderQueue & queue) override;
+
+		// Data is copied, ids stay valid for the lifetime of the api
+		unsigned int CreateVertexBuffer(const SoftwareVertex * vertices, unsigned int count);
+		unsigned int CreateIndexBuffer(const unsigned int * indices, unsigned int count);
+		unsigned int CreatePipeline(const SoftwarePipelineDesc & desc);
+
+		inline void SetJobSystem(JobSystem * jobSystem) { m_Rasterizer.SetJobSystem(jobSystem); }
+		inline const SoftwareRasterStats & GetRasterStats() const { return m_Rasterizer.GetStats(); }
+		// What the last frame drew
+		inline Image ReadFramebuffer() const { return m_Framebuffer.ToImage(); }
+		bool SaveFramebuffer(const std::string & path) const;
+	private:
+		void Draw(const DrawCommand & draw);
+		bool WindowSizeChanged(WindowResizeEvent & e);
+	public:
+		struct SoftwareGraphicsData {
+			bool Vsync;
+			bool Fullscreen;
+			unsigned int SubmittedDraws = 0;	// Last submitted queue
+		};
+		SoftwareGraphicsData m_Data;
+	private:
+		SoftwareFramebuffer m_Framebuffer;
+		SoftwareRasterizer m_Rasterizer;
+		std::vector<std::vector<SoftwareVertex>> m_VertexBuffers;
+		std::vector<std::vector<unsigned int>> m_IndexBuffers;
+		std::vector<SoftwarePipelineDesc> m_Pipelines;
+		std::vector<SoftwareVertex> m_Transformed;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,522 @@
+#include "pch.h"
+#include "softwarerasterizer.h"
+
+#include "engine/jobs/jobsystem.h"
+
+#if defined(__AVX2__)
+	#define PV_SOFTWARE_AVX2
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PV_SOFTWARE_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace prev {
+
+	static const unsigned int s_TileSize = SoftwareFramebuffer::TileSize;
+	static const unsigned int s_EdgeShift = 29;
+	static const unsigned int s_IndexMask = (1u << s_EdgeShift) - 1;
+	// Clip space x and y are kept inside +-GuardBand * w, 4 viewports wide, so snapped coordinates fit the edge functions
+	static const float s_GuardBand = 4.0f;
+
+	// One tile row (8 pixels) at a time. Lanes hold the same IEEE results in every path, so the image doesn't depend on the build
+	// as long as nothing gets contracted into an FMA, premake builds this file with -ffp-contract=off (/fp:strict)
+#if defined(PV_SOFTWARE_AVX2)
+	struct FloatRow { __m256 V; };
+	struct IntRow { __m256i V; };
+
+	static inline FloatRow LoadRow(const float * p) { return { _mm256_loadu_ps(p) }; }
+	static inline IntRow LoadRow(const unsigned int * p) { return { _mm256_loadu_si256((const __m256i *)p) }; }
+	static inline void StoreRow(float * p, FloatRow a) { _mm256_storeu_ps(p, a.V); }
+	static inline void StoreRow(unsigned int * p, IntRow a) { _mm256_storeu_si256((__m256i *)p, a.V); }
+	static inline FloatRow SetRow(float a) { return { _mm256_set1_ps(a) }; }
+	static inline IntRow SetRow(int a) { return { _mm256_set1_epi32(a) }; }
+	static inline FloatRow LaneIndex() { return { _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f) }; }
+	static inline IntRow LaneIndexInt() { return { _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7) }; }
+
+	static inline FloatRow operator+(FloatRow a, FloatRow b) { return { _mm256_add_ps(a.V, b.V) }; }
+	static inline FloatRow operator*(FloatRow a, FloatRow b) { return { _mm256_mul_ps(a.V, b.V) }; }
+	static inline FloatRow operator/(FloatRow a, FloatRow b) { return { _mm256_div_ps(a.V, b.V) }; }
+	static inline FloatRow Min(FloatRow a, FloatRow b) { return { _mm256_min_ps(a.V, b.V) }; }
+	static inline FloatRow Max(FloatRow a, FloatRow b) { return { _mm256_max_ps(a.V, b.V) }; }
+	static inline IntRow operator+(IntRow a, IntRow b) { return { _mm256_add_epi32(a.V, b.V) }; }
+	static inline IntRow operator*(IntRow a, IntRow b) { return { _mm256_mullo_epi32(a.V, b.V) }; }
+	static inline IntRow operator&(IntRow a, IntRow b) { return { _mm256_and_si256(a.V, b.V) }; }
+	static inline IntRow operator|(IntRow a, IntRow b) { return { _mm256_or_si256(a.V, b.V) }; }
+	template<int Bits> static inline IntRow ShiftLeft(IntRow a) { return { _mm256_slli_epi32(a.V, Bits) }; }
+	static inline IntRow Greater(IntRow a, IntRow b) { return { _mm256_cmpgt_epi32(a.V, b.V) }; }
+	static inline IntRow Less(FloatRow a, FloatRow b) { return { _mm256_castps_si256(_mm256_cmp_ps(a.V, b.V, _CMP_LT_OQ)) }; }
+	static inline IntRow Truncate(FloatRow a) { return { _mm256_cvttps_epi32(a.V) }; }
+	static inline bool Any(IntRow mask) { return _mm256_movemask_ps(_mm256_castsi256_ps(mask.V)) != 0; }
+	static inline IntRow Select(IntRow mask, IntRow a, IntRow b) { return { _mm256_blendv_epi8(b.V, a.V, mask.V) }; }
+	static inline FloatRow Select(IntRow mask, FloatRow a, FloatRow b) { return { _mm256_blendv_ps(b.V, a.V, _mm256_castsi256_ps(mask.V)) }; }
+#elif defined(PV_SOFTWARE_SSE2)
+	struct FloatRow { __m128 Lo, Hi; };
+	struct IntRow { __m128i Lo, Hi; };
+
+	static inline FloatRow LoadRow(const float * p) { return { _mm_loadu_ps(p), _mm_loadu_ps(p + 4) }; }
+	static inline IntRow LoadRow(const unsigned int * p) { return { _mm_loadu_si128((const __m128i *)p), _mm_loadu_si128((const __m128i *)(p + 4)) }; }
+	static inline void StoreRow(float * p, FloatRow a) { _mm_storeu_ps(p, a.Lo); _mm_storeu_ps(p + 4, a.Hi); }
+	static inline void StoreRow(unsigned int * p, IntRow a) { _mm_storeu_si128((__m128i *)p, a.Lo); _mm_storeu_si128((__m128i *)(p + 4), a.Hi); }
+	static inline FloatRow SetRow(float a) { return { _mm_set1_ps(a), _mm_set1_ps(a) }; }
+	static inline IntRow SetRow(int a) { return { _mm_set1_epi32(a), _mm_set1_epi32(a) }; }
+	static inline FloatRow LaneIndex() { return { _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), _mm_setr_ps(4.0f, 5.0f, 6.0f, 7.0f) }; }
+	static inline IntRow LaneIndexInt() { return { _mm_setr_epi32(0, 1, 2, 3), _mm_setr_epi32(4, 5, 6, 7) }; }
+
+	static inline FloatRow operator+(FloatRow a, FloatRow b) { return { _mm_add_ps(a.Lo, b.Lo), _mm_add_ps(a.Hi, b.Hi) }; }
+	static inline FloatRow operator*(FloatRow a, FloatRow b) { return { _mm_mul_ps(a.Lo, b.Lo), _mm_mul_ps(a.Hi, b.Hi) }; }
+	static inline FloatRow operator/(FloatRow a, FloatRow b) { return { _mm_div_ps(a.Lo, b.Lo), _mm_div_ps(a.Hi, b.Hi) }; }
+	static inline FloatRow Min(FloatRow a, FloatRow b) { return { _mm_min_ps(a.Lo, b.Lo), _mm_min_ps(a.Hi, b.Hi) }; }
+	static inline FloatRow Max(FloatRow a, FloatRow b) { return { _mm_max_ps(a.Lo, b.Lo), _mm_max_ps(a.Hi, b.Hi) }; }
+	static inline IntRow operator+(IntRow a, IntRow b) { return { _mm_add_epi32(a.Lo, b.Lo), _mm_add_epi32(a.Hi, b.Hi) }; }
+	static inline IntRow operator&(IntRow a, IntRow b) { return { _mm_and_si128(a.Lo, b.Lo), _mm_and_si128(a.Hi, b.Hi) }; }
+	static inline IntRow operator|(IntRow a, IntRow b) { return { _mm_or_si128(a.Lo, b.Lo), _mm_or_si128(a.Hi, b.Hi) }; }
+	template<int Bits> static inline IntRow ShiftLeft(IntRow a) { return { _mm_slli_epi32(a.Lo, Bits), _mm_slli_epi32(a.Hi, Bits) }; }
+	static inline IntRow Greater(IntRow a, IntRow b) { return { _mm_cmpgt_epi32(a.Lo, b.Lo), _mm_cmpgt_epi32(a.Hi, b.Hi) }; }
+	static inline IntRow Less(FloatRow a, FloatRow b) { return { _mm_castps_si128(_mm_cmplt_ps(a.Lo, b.Lo)), _mm_castps_si128(_mm_cmplt_ps(a.Hi, b.Hi)) }; }
+	static inline IntRow Truncate(FloatRow a) { return { _mm_cvttps_epi32(a.Lo), _mm_cvttps_epi32(a.Hi) }; }
+	static inline bool Any(IntRow mask) { return (_mm_movemask_epi8(mask.Lo) | _mm_movemask_epi8(mask.Hi)) != 0; }
+	static inline IntRow Select(IntRow mask, IntRow a, IntRow b) {
+		return { _mm_or_si128(_mm_and_si128(mask.Lo, a.Lo), _mm_andnot_si128(mask.Lo, b.Lo)),
+				 _mm_or_si128(_mm_and_si128(mask.Hi, a.Hi), _mm_andnot_si128(mask.Hi, b.Hi)) };
+	}
+	static inline FloatRow Select(IntRow mask, FloatRow a, FloatRow b) {
+		__m128 lo = _mm_castsi128_ps(mask.Lo), hi = _mm_castsi128_ps(mask.Hi);
+		return { _mm_or_ps(_mm_and_ps(lo, a.Lo), _mm_andnot_ps(lo, b.Lo)), _mm_or_ps(_mm_and_ps(hi, a.Hi), _mm_andnot_ps(hi, b.Hi)) };
+	}
+	// SSE2 has no 32 bit multiply, rows only multiply small lane indices
+	static inline IntRow operator*(IntRow a, IntRow b) {
+		alignas(16) int x[8], y[8];
+		_mm_store_si128((__m128i *)x, a.Lo); _mm_store_si128((__m128i *)(x + 4), a.Hi);
+		_mm_store_si128((__m128i *)y, b.Lo); _mm_store_si128((__m128i *)(y + 4), b.Hi);
+		for (unsigned int i = 0; i < 8; i++)
+			x[i] *= y[i];
+		return { _mm_load_si128((const __m128i *)x), _mm_load_si128((const __m128i *)(x + 4)) };
+	}
+#else
+	struct FloatRow { float V[8]; };
+	struct IntRow { int V[8]; };
+
+	#define PV_ROW_LANES(expr) for (unsigned int i = 0; i < 8; i++) { expr; }
+
+	static inline FloatRow LoadRow(const float * p) { FloatRow r; PV_ROW_LANES(r.V[i] = p[i]) return r; }
+	static inline IntRow LoadRow(const unsigned int * p) { IntRow r; PV_ROW_LANES(r.V[i] = (int)p[i]) return r; }
+	static inline void StoreRow(float * p, FloatRow a) { PV_ROW_LANES(p[i] = a.V[i]) }
+	static inline void StoreRow(unsigned int * p, IntRow a) { PV_ROW_LANES(p[i] = (unsigned int)a.V[i]) }
+	static inline FloatRow SetRow(float a) { FloatRow r; PV_ROW_LANES(r.V[i] = a) return r; }
+	static inline IntRow SetRow(int a) { IntRow r; PV_ROW_LANES(r.V[i] = a) return r; }
+	static inline FloatRow LaneIndex() { FloatRow r; PV_ROW_LANES(r.V[i] = (float)i) return r; }
+	static inline IntRow LaneIndexInt() { IntRow r; PV_ROW_LANES(r.V[i] = (int)i) return r; }
+
+	static inline FloatRow operator+(FloatRow a, FloatRow b) { PV_ROW_LANES(a.V[i] += b.V[i]) return a; }
+	static inline FloatRow operator*(FloatRow a, FloatRow b) { PV_ROW_LANES(a.V[i] *= b.V[i]) return a; }
+	static inline FloatRow operator/(FloatRow a, FloatRow b) { PV_ROW_LANES(a.V[i] /= b.V[i]) return a; }
+	// Second operand on NaN, like minps and maxps
+	static inline FloatRow Min(FloatRow a, FloatRow b) { PV_ROW_LANES(a.V[i] = a.V[i] < b.V[i] ? a.V[i] : b.V[i]) return a; }
+	static inline FloatRow Max(FloatRow a, FloatRow b) { PV_ROW_LANES(a.V[i] = a.V[i] > b.V[i] ? a.V[i] : b.V[i]) return a; }
+	static inline IntRow operator+(IntRow a, IntRow b) { PV_ROW_LANES(a.V[i] = (int)((unsigned int)a.V[i] + (unsigned int)b.V[i])) return a; }
+	static inline IntRow operator*(IntRow a, IntRow b) { PV_ROW_LANES(a.V[i] = (int)((unsigned int)a.V[i] * (unsigned int)b.V[i])) return a; }
+	static inline IntRow operator&(IntRow a, IntRow b) { PV_ROW_LANES(a.V[i] &= b.V[i]) return a; }
+	static inline IntRow operator|(IntRow a, IntRow b) { PV_ROW_LANES(a.V[i] |= b.V[i]) return a; }
+	template<int Bits> static inline IntRow ShiftLeft(IntRow a) { PV_ROW_LANES(a.V[i] = (int)((unsigned int)a.V[i] << Bits)) return a; }
+	static inline IntRow Greater(IntRow a, IntRow b) { IntRow r; PV_ROW_LANES(r.V[i] = a.V[i] > b.V[i] ? -1 : 0) return r; }
+	static inline IntRow Less(FloatRow a, FloatRow b) { IntRow r; PV_ROW_LANES(r.V[i] = a.V[i] < b.V[i] ? -1 : 0) return r; }
+	// Only called on values already clamped to [0, 255.5]
+	static inline IntRow Truncate(FloatRow a) { IntRow r; PV_ROW_LANES(r.V[i] = (int)a.V[i]) return r; }
+	static inline bool Any(IntRow mask) { int any = 0; PV_ROW_LANES(any |= mask.V[i]) return any != 0; }
+	static inline IntRow Select(IntRow mask, IntRow a, IntRow b) { PV_ROW_LANES(a.V[i] = mask.V[i] ? a.V[i] : b.V[i]) return a; }
+	static inline FloatRow Select(IntRow mask, FloatRow a, FloatRow b) { PV_ROW_LANES(a.V[i] = mask.V[i] ? a.V[i] : b.V[i]) return a; }
+
+	#undef PV_ROW_LANES
+#endif
+
+	// Same math as the row kernel, NaN ends up as 1
+	static inline unsigned int PackChannel(float value) {
+		value = value < 1.0f ? value : 1.0f;
+		value = value > 0.0f ? value : 0.0f;
+		return (unsigned int)(value * 255.0f + 0.5f);
+	}
+
+	static inline IntRow PackChannel(FloatRow value) {
+		return Truncate(Max(Min(value, SetRow(1.0f)), SetRow(0.0f)) * SetRow(255.0f) + SetRow(0.5f));
+	}
+
+	const unsigned int SoftwareFramebuffer::TileSize;
+	const unsigned int SoftwareFramebuffer::MaxSize;
+	const int SoftwareRasterizer::SubpixelBits;
+	const int SoftwareRasterizer::SubpixelSteps;
+	const unsigned int SoftwareRasterizer::MaxTriangles;
+
+	void SoftwareFramebuffer::Resize(unsigned int width, unsigned int height) {
+		if (width > MaxSize || height > MaxSize) {
+			PV_LOG_WARN("Software framebuffer %ux%u is clamped to %u", width, height, MaxSize);
+			width = std::min(width, MaxSize);
+			height = std::min(height, MaxSize);
+		}
+		m_Width = width;
+		m_Height = height;
+		m_Stride = (width + TileSize - 1) / TileSize * TileSize;
+		m_PaddedHeight = (height + TileSize - 1) / TileSize * TileSize;
+		m_Color.assign((size_t)m_Stride * m_PaddedHeight, 0);
+		m_Depth.assign((size_t)m_Stride * m_PaddedHeight, 1.0f);
+	}
+
+	void SoftwareFramebuffer::ClearColor(const float color[4]) {
+		std::fill(m_Color.begin(), m_Color.end(), PackColor(color[0], color[1], color[2], color[3]));
+	}
+
+	void SoftwareFramebuffer::ClearDepth(float depth) {
+		std::fill(m_Depth.begin(), m_Depth.end(), depth);
+	}
+
+	Image SoftwareFramebuffer::ToImage() const {
+		Image image;
+		image.Width = m_Width;
+		image.Height = m_Height;
+		image.Pixels.resize((size_t)m_Width * m_Height);
+		for (unsigned int y = 0; y < m_Height; y++)
+			std::copy_n(m_Color.data() + (size_t)y * m_Stride, m_Width, image.Pixels.data() + (size_t)y * m_Width);
+		return image;
+	}
+
+	unsigned int SoftwareFramebuffer::PackColor(float r, float g, float b, float a) {
+		return PackChannel(r) | (PackChannel(g) << 8) | (PackChannel(b) << 16) | (PackChannel(a) << 24);
+	}
+
+	SoftwareRasterizer::SoftwareRasterizer(JobSystem * jobSystem) :
+		m_JobSystem(jobSystem) {
+	}
+
+	void SoftwareRasterizer::SetTarget(SoftwareFramebuffer * framebuffer) {
+		Flush();
+		m_Target = framebuffer;
+		if (m_Target == nullptr) {
+			m_TilesX = m_TilesY = 0;
+			m_Bins.clear();
+			return;
+		}
+		m_TilesX = m_Target->GetStride() / s_TileSize;
+		m_TilesY = (m_Target->GetHeight() + s_TileSize - 1) / s_TileSize;
+		m_Bins.resize((size_t)m_TilesX * m_TilesY);
+		SetViewport(0.0f, 0.0f, (float)m_Target->GetWidth(), (float)m_Target->GetHeight(), 0.0f, 1.0f);
+	}
+
+	void SoftwareRasterizer::SetViewport(float x, float y, float width, float height, float minDepth, float maxDepth) {
+		const float maxSize = (float)SoftwareFramebuffer::MaxSize;
+		m_ViewportX = std::min(std::max(x, 0.0f), maxSize);
+		m_ViewportY = std::min(std::max(y, 0.0f), maxSize);
+		m_ViewportWidth = std::min(std::max(width, 0.0f), maxSize);
+		m_ViewportHeight = std::min(std::max(height, 0.0f), maxSize);
+		m_MinDepth = minDepth;
+		m_MaxDepth = maxDepth;
+
+		// Pixels whose center is inside the viewport and the target
+		int targetWidth = m_Target != nullptr ? (int)m_Target->GetWidth() : 0;
+		int targetHeight = m_Target != nullptr ? (int)m_Target->GetHeight() : 0;
+		m_ScissorMinX = (int)std::ceil(m_ViewportX - 0.5f);
+		m_ScissorMinY = (int)std::ceil(m_ViewportY - 0.5f);
+		m_ScissorMaxX = std::min((int)std::ceil(m_ViewportX + m_ViewportWidth - 0.5f), targetWidth) - 1;
+		m_ScissorMaxY = std::min((int)std::ceil(m_ViewportY + m_ViewportHeight - 0.5f), targetHeight) - 1;
+	}
+
+	void SoftwareRasterizer::Clear(bool color, bool depth, const float clearColor[4], float clearDepth) {
+		if (m_Target == nullptr)
+			return;
+		Flush();
+		if (color)
+			m_Target->ClearColor(clearColor);
+		if (depth)
+			m_Target->ClearDepth(clearDepth);
+	}
+
+	void SoftwareRasterizer::DrawTriangle(const SoftwareVertex & a, const SoftwareVertex & b, const SoftwareVertex & c, const SoftwareRasterState & state) {
+		if (m_Target == nullptr)
+			return;
+
+		// Near plane (z >= 0) and the guard band, w >= 0 follows from the guard band
+		static const unsigned int planeCount = 5;
+		auto distance = [](const SoftwareVertex & v, unsigned int plane) -> float {
+			switch (plane) {
+			case 0: return v.Z;
+			case 1: return s_GuardBand * v.W - v.X;
+			case 2: return s_GuardBand * v.W + v.X;
+			case 3: return s_GuardBand * v.W - v.Y;
+			default: return s_GuardBand * v.W + v.Y;
+			}
+		};
+
+		const SoftwareVertex triangle[3] = { a, b, c };
+		unsigned int outside = 0;
+		for (unsigned int plane = 0; plane < planeCount; plane++) {
+			unsigned int count = 0;
+			for (const SoftwareVertex & v : triangle)
+				count += distance(v, plane) < 0.0f ? 1 : 0;
+			if (count == 3)
+				return;
+			outside += count;
+		}
+		if (outside == 0) {
+			SetupTriangle(triangle, state);
+			return;
+		}
+
+		// Sutherland-Hodgman, every plane adds at most one vertex
+		SoftwareVertex polygons[2][3 + planeCount];
+		unsigned int count = 3;
+		std::copy_n(triangle, 3, polygons[0]);
+		for (unsigned int plane = 0; plane < planeCount && count >= 3; plane++) {
+			const SoftwareVertex * in = polygons[plane & 1];
+			SoftwareVertex * out = polygons[(plane + 1) & 1];
+			unsigned int outCount = 0;
+			for (unsigned int i = 0; i < count; i++) {
+				const SoftwareVertex & v0 = in[i];
+				const SoftwareVertex & v1 = in[(i + 1) % count];
+				float d0 = distance(v0, plane), d1 = distance(v1, plane);
+				if (d0 >= 0.0f)
+					out[outCount++] = v0;
+				if ((d0 >= 0.0f) != (d1 >= 0.0f)) {
+					float t = d0 / (d0 - d1);
+					const float * p0 = &v0.X;
+					const float * p1 = &v1.X;
+					float * p = &out[outCount++].X;
+					for (unsigned int k = 0; k < 8; k++)
+						p[k] = p0[k] + (p1[k] - p0[k]) * t;
+				}
+			}
+			count = outCount;
+		}
+
+		m_Stats.Clipped++;
+		const SoftwareVertex * polygon = polygons[planeCount & 1];
+		for (unsigned int i = 2; i < count; i++) {
+			const SoftwareVertex fan[3] = { polygon[0], polygon[i - 1], polygon[i] };
+			SetupTriangle(fan, state);
+		}
+	}
+
+	void SoftwareRasterizer::SetupTriangle(const SoftwareVertex * vertices, const SoftwareRasterState & state) {
+		int x[3], y[3];
+		float invW[3];
+		for (unsigned int i = 0; i < 3; i++) {
+			if (vertices[i].W <= 0.0f)
+				return;
+			invW[i] = 1.0f / vertices[i].W;
+			float screenX = m_ViewportX + (vertices[i].X * invW[i] * 0.5f + 0.5f) * m_ViewportWidth;
+			float screenY = m_ViewportY + (0.5f - vertices[i].Y * invW[i] * 0.5f) * m_ViewportHeight;
+			x[i] = (int)std::floor(screenX * SubpixelSteps + 0.5f);
+			y[i] = (int)std::floor(screenY * SubpixelSteps + 0.5f);
+		}
+
+		// Positive is clockwise on the render target
+		long long area = (long long)(x[1] - x[0]) * (y[2] - y[0]) - (long long)(y[1] - y[0]) * (x[2] - x[0]);
+		if (area == 0 || (state.Cull == CullMode::Back && area < 0) || (state.Cull == CullMode::Front && area > 0)) {
+			m_Stats.Culled++;
+			return;
+		}
+		unsigned int order[3] = { 0, 1, 2 };
+		if (area < 0) {
+			std::swap(order[1], order[2]);
+			area = -area;
+		}
+
+		Triangle triangle;
+		int minX = std::min({ x[0], x[1], x[2] }), maxX = std::max({ x[0], x[1], x[2] });
+		int minY = std::min({ y[0], y[1], y[2] }), maxY = std::max({ y[0], y[1], y[2] });
+		// Pixels whose center is inside the bounds
+		triangle.MinX = std::max((minX - SubpixelSteps / 2 + SubpixelSteps - 1) >> SubpixelBits, m_ScissorMinX);
+		triangle.MinY = std::max((minY - SubpixelSteps / 2 + SubpixelSteps - 1) >> SubpixelBits, m_ScissorMinY);
+		triangle.MaxX = std::min((maxX - SubpixelSteps / 2) >> SubpixelBits, m_ScissorMaxX);
+		triangle.MaxY = std::min((maxY - SubpixelSteps / 2) >> SubpixelBits, m_ScissorMaxY);
+		if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+			return;
+
+		for (unsigned int k = 0; k < 3; k++) {
+			unsigned int i0 = order[k], i1 = order[(k + 1) % 3];
+			int dx = x[i1] - x[i0], dy = y[i1] - y[i0];
+			triangle.EdgeA[k] = -dy * SubpixelSteps;
+			triangle.EdgeB[k] = dx * SubpixelSteps;
+			triangle.EdgeC[k] = (long long)dx * (SubpixelSteps / 2 - y[i0]) - (long long)dy * (SubpixelSteps / 2 - x[i0]);
+			// Top left fill rule, pixel centers exactly on other edges belong to the neighbouring triangle
+			bool topLeft = dy < 0 || (dy == 0 && dx > 0);
+			if (!topLeft)
+				triangle.EdgeC[k]--;
+		}
+
+		// Planes through the snapped vertices, in pixels
+		double px[3], py[3];
+		for (unsigned int k = 0; k < 3; k++) {
+			px[k] = (double)x[order[k]] / SubpixelSteps;
+			py[k] = (double)y[order[k]] / SubpixelSteps;
+		}
+		const double pixelArea = (double)area / (SubpixelSteps * SubpixelSteps);
+		auto plane = [&](float f0, float f1, float f2) -> Plane {
+			double dx = ((f1 - f0) * (py[2] - py[0]) - (f2 - f0) * (py[1] - py[0])) / pixelArea;
+			double dy = ((f2 - f0) * (px[1] - px[0]) - (f1 - f0) * (px[2] - px[0])) / pixelArea;
+			double c = f0 + dx * (0.5 - px[0]) + dy * (0.5 - py[0]);
+			return { (float)c, (float)dx, (float)dy };
+		};
+		auto attribute = [&](auto get) -> Plane {
+			return plane(get(order[0]), get(order[1]), get(order[2]));
+		};
+
+		const float depthRange = m_MaxDepth - m_MinDepth;
+		triangle.Z = attribute([&](unsigned int i) { return m_MinDepth + vertices[i].Z * invW[i] * depthRange; });
+		triangle.InvW = attribute([&](unsigned int i) { return invW[i]; });
+		for (unsigned int channel = 0; channel < 4; channel++)
+			triangle.Color[channel] = attribute([&](unsigned int i) { return (&vertices[i].R)[channel] * invW[i]; });
+		triangle.DepthTest = state.DepthTest;
+		triangle.DepthWrite = state.DepthWrite;
+
+		if (m_Triangles.size() == MaxTriangles)
+			Flush();
+		m_Triangles.push_back(triangle);
+		m_Stats.Triangles++;
+		BinTriangle((unsigned int)m_Triangles.size() - 1);
+	}
+
+	void SoftwareRasterizer::BinTriangle(unsigned int index) {
+		const Triangle & triangle = m_Triangles[index];
+		const long long tileEnd = s_TileSize - 1;
+
+		for (int tileY = triangle.MinY / (int)s_TileSize; tileY <= triangle.MaxY / (int)s_TileSize; tileY++) {
+			for (int tileX = triangle.MinX / (int)s_TileSize; tileX <= triangle.MaxX / (int)s_TileSize; tileX++) {
+				// Smallest and largest value of each edge over the tile's pixel centers
+				unsigned int partial = 0;
+				bool outside = false;
+				for (unsigned int k = 0; k < 3 && !outside; k++) {
+					long long a = triangle.EdgeA[k], b = triangle.EdgeB[k];
+					long long corner = triangle.EdgeC[k] + a * tileX * s_TileSize + b * tileY * s_TileSize;
+					long long low = corner + std::min(0ll, a * tileEnd) + std::min(0ll, b * tileEnd);
+					long long high = corner + std::max(0ll, a * tileEnd) + std::max(0ll, b * tileEnd);
+					outside = high < 0;
+					if (low < 0)
+						partial |= 1u << k;
+				}
+				if (outside)
+					continue;
+
+				auto & bin = m_Bins[(size_t)tileY * m_TilesX + tileX];
+				if (bin.empty())
+					m_BusyTiles.push_back((unsigned int)tileY * m_TilesX + tileX);
+				bin.push_back(index | (partial << s_EdgeShift));
+				m_Stats.TileEntries++;
+			}
+		}
+	}
+
+	void SoftwareRasterizer::Flush() {
+		if (m_BusyTiles.empty()) {
+			m_Triangles.clear();
+			return;
+		}
+		PV_PROFILE_FUNCTION();
+
+		const unsigned int count = (unsigned int)m_BusyTiles.size();
+		if (m_JobSystem != nullptr) {
+			unsigned int batchSize = std::max(4u, count / (m_JobSystem->GetWorkerCount() * 16));
+			m_JobSystem->ParallelFor(count, batchSize, [this](unsigned int i) {
+				RasterizeTile(m_BusyTiles[i]);
+			});
+		} else {
+			for (unsigned int i = 0; i < count; i++)
+				RasterizeTile(m_BusyTiles[i]);
+		}
+
+		for (unsigned int tile : m_BusyTiles)
+			m_Bins[tile].clear();
+		m_BusyTiles.clear();
+		m_Triangles.clear();
+	}
+
+	void SoftwareRasterizer::RasterizeTile(unsigned int tile) {
+		const int tileX = (int)(tile % m_TilesX) * s_TileSize;
+		const int tileY = (int)(tile / m_TilesX) * s_TileSize;
+		const unsigned int stride = m_Target->GetStride();
+		unsigned int * colorBuffer = m_Target->GetColor() + (size_t)tileY * stride + tileX;
+		float * depthBuffer = m_Target->GetDepth() + (size_t)tileY * stride + tileX;
+
+		const FloatRow lanes = LaneIndex();
+		const IntRow laneInts = LaneIndexInt();
+		const IntRow allLanes = SetRow(-1);
+		const IntRow minusOne = SetRow(-1);
+
+		for (unsigned int entry : m_Bins[tile]) {
+			const Triangle & triangle = m_Triangles[entry & s_IndexMask];
+			const unsigned int partial = entry >> s_EdgeShift;
+
+			const int rowBegin = std::max(triangle.MinY - tileY, 0);
+			const int rowEnd = std::min(triangle.MaxY - tileY, (int)s_TileSize - 1);
+			IntRow columns = allLanes;
+			if (triangle.MinX > tileX || triangle.MaxX < tileX + (int)s_TileSize - 1) {
+				IntRow x = laneInts + SetRow(tileX);
+				columns = Greater(x, SetRow(triangle.MinX - 1)) & Greater(SetRow(triangle.MaxX + 1), x);
+			}
+
+			// Values at the first lane of the first row, edges fit in 32 bits inside a tile they cross
+			IntRow edges[3], edgeSteps[3];
+			unsigned int edgeCount = 0;
+			for (unsigned int k = 0; k < 3; k++) {
+				if ((partial & (1u << k)) == 0)
+					continue;
+				long long start = triangle.EdgeC[k] + (long long)triangle.EdgeA[k] * tileX + (long long)triangle.EdgeB[k] * (tileY + rowBegin);
+				edges[edgeCount] = SetRow((int)start) + laneInts * SetRow(triangle.EdgeA[k]);
+				edgeSteps[edgeCount] = SetRow(triangle.EdgeB[k]);
+				edgeCount++;
+			}
+
+			auto origin = [&](const Plane & plane) -> float {
+				return plane.C + plane.DX * (float)tileX;
+			};
+			const float zOrigin = origin(triangle.Z), invWOrigin = origin(triangle.InvW);
+			const FloatRow zLanes = SetRow(triangle.Z.DX) * lanes, invWLanes = SetRow(triangle.InvW.DX) * lanes;
+			float colorOrigin[4];
+			FloatRow colorLanes[4];
+			for (unsigned int channel = 0; channel < 4; channel++) {
+				colorOrigin[channel] = origin(triangle.Color[channel]);
+				colorLanes[channel] = SetRow(triangle.Color[channel].DX) * lanes;
+			}
+
+			for (int row = rowBegin; row <= rowEnd; row++) {
+				IntRow mask = columns;
+				for (unsigned int k = 0; k < edgeCount; k++) {
+					mask = mask & Greater(edges[k], minusOne);
+					edges[k] = edges[k] + edgeSteps[k];
+				}
+				if (!Any(mask))
+					continue;
+
+				const float y = (float)(tileY + row);
+				unsigned int * color = colorBuffer + (size_t)row * stride;
+				float * depth = depthBuffer + (size_t)row * stride;
+
+				FloatRow z = SetRow(zOrigin + triangle.Z.DY * y) + zLanes;
+				FloatRow storedDepth = LoadRow(depth);
+				if (triangle.DepthTest) {
+					mask = mask & Less(z, storedDepth);
+					if (!Any(mask))
+						continue;
+				}
+				if (triangle.DepthWrite)
+					StoreRow(depth, Select(mask, z, storedDepth));
+
+				FloatRow w = SetRow(1.0f) / (SetRow(invWOrigin + triangle.InvW.DY * y) + invWLanes);
+				IntRow packed = PackChannel((SetRow(colorOrigin[0] + triangle.Color[0].DY * y) + colorLanes[0]) * w);
+				packed = packed | ShiftLeft<8>(PackChannel((SetRow(colorOrigin[1] + triangle.Color[1].DY * y) + colorLanes[1]) * w));
+				packed = packed | ShiftLeft<16>(PackChannel((SetRow(colorOrigin[2] + triangle.Color[2].DY * y) + colorLanes[2]) * w));
+				packed = packed | ShiftLeft<24>(PackChannel((SetRow(colorOrigin[3] + triangle.Color[3].DY * y) + colorLanes[3]) * w));
+				StoreRow(color, Select(mask, packed, LoadRow(color)));
+			}
+		}
+	}
+
+	const char * SoftwareRasterizer::GetSimdName() {
+#if defined(PV_SOFTWARE_AVX2)
+		return "avx2";
+#elif defined(PV_SOFTWARE_SSE2)
+		return "sse2";
+#else
+		return "scalar";
+#endif
+	}
+
+}
\ No newline at end of file
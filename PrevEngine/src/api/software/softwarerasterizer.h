@@ -0,0 +1,133 @@
+#pragma once
+
+#include "engine/memory/memorytracker.h"
+#include "engine/render/image.h"
+
+namespace prev {
+
+	class JobSystem;
+
+	enum class CullMode : unsigned char {
+		None,
+		Back,
+		Front
+	};
+
+	// Clockwise on the render target is the front face, like the DirectX rasterizer state
+	struct SoftwareRasterState {
+		CullMode Cull = CullMode::Back;
+		bool DepthTest = true;		// Less
+		bool DepthWrite = true;
+	};
+
+	// Clip space position (DirectX convention, 0 <= z <= w) and a color
+	struct SoftwareVertex {
+		float X, Y, Z, W;
+		float R, G, B, A;
+	};
+
+	// Color and depth, rows are padded to whole tiles so a tile row is always 8 pixels in memory
+	class SoftwareFramebuffer {
+	public:
+		static const unsigned int TileSize = 8;
+		static const unsigned int MaxSize = 4096;	// Keeps snapped coordinates inside the guard band in 32 bit edge functions
+	public:
+		void Resize(unsigned int width, unsigned int height);
+		void ClearColor(const float color[4]);
+		void ClearDepth(float depth);
+
+		inline unsigned int GetWidth() const { return m_Width; }
+		inline unsigned int GetHeight() const { return m_Height; }
+		inline unsigned int GetStride() const { return m_Stride; }
+		inline unsigned int * GetColor() { return m_Color.data(); }
+		inline float * GetDepth() { return m_Depth.data(); }
+
+		// Without the padding
+		Image ToImage() const;
+
+		static unsigned int PackColor(float r, float g, float b, float a);
+	private:
+		unsigned int m_Width = 0;
+		unsigned int m_Height = 0;
+		unsigned int m_Stride = 0;
+		unsigned int m_PaddedHeight = 0;
+		TaggedVector<unsigned int, MemTag::Render> m_Color;
+		TaggedVector<float, MemTag::Render> m_Depth;
+	};
+
+	struct SoftwareRasterStats {
+		unsigned long long Triangles = 0;	// Set up and binned
+		unsigned long long Culled = 0;		// Back or front faces, and ones with no area
+		unsigned long long Clipped = 0;		// Crossed the near plane or the guard band and were cut
+		unsigned long long TileEntries = 0;	// Triangle and tile pairs that got rasterized
+	};
+
+	// Triangles are set up and binned into 8x8 tiles as they come, Flush rasterizes every tile that has any
+	// Tiles run in parallel on the job system, each one in submission order, so the image doesn't depend on the thread count
+	// Edge functions are 32 bit integers with 4 bits of subpixel precision, evaluated for a whole tile row at once (AVX2, SSE2 or scalar)
+	class SoftwareRasterizer {
+	public:
+		static const int SubpixelBits = 4;
+		static const int SubpixelSteps = 1 << SubpixelBits;
+		static const unsigned int MaxTriangles = 1u << 29;	// Per flush, tile entries keep 3 bits for edge flags
+	public:
+		SoftwareRasterizer(JobSystem * jobSystem = nullptr);
+
+		// Only the main thread (worker 0) can spread tiles over the job system, others rasterize alone
+		inline void SetJobSystem(JobSystem * jobSystem) { m_JobSystem = jobSystem; }
+		// Flushes what was binned for the previous target, resets the viewport to the whole target
+		void SetTarget(SoftwareFramebuffer * framebuffer);
+		void SetViewport(float x, float y, float width, float height, float minDepth, float maxDepth);
+
+		// Clears the whole target, after what was drawn before it
+		void Clear(bool color, bool depth, const float clearColor[4], float clearDepth);
+		void DrawTriangle(const SoftwareVertex & a, const SoftwareVertex & b, const SoftwareVertex & c, const SoftwareRasterState & state);
+		void Flush();
+
+		inline const SoftwareRasterStats & GetStats() const { return m_Stats; }
+		inline void ResetStats() { m_Stats = SoftwareRasterStats(); }
+		// Which row kernel was compiled in
+		static const char * GetSimdName();
+	private:
+		// Value at pixel (x, y) is C + DX * x + DY * y, sampled at the pixel center
+		struct Plane {
+			float C, DX, DY;
+		};
+
+		struct Triangle {
+			// Edge value at pixel (x, y) is C + A * x + B * y, inside when >= 0, fill rule bias folded into C
+			long long EdgeC[3];
+			int EdgeA[3];
+			int EdgeB[3];
+			int MinX, MinY, MaxX, MaxY;	// Pixels, inside the viewport
+			Plane Z;
+			Plane InvW;
+			Plane Color[4];				// Divided by w, for perspective correct colors
+			bool DepthTest;
+			bool DepthWrite;
+		};
+
+		void SetupTriangle(const SoftwareVertex * vertices, const SoftwareRasterState & state);
+		void BinTriangle(unsigned int index);
+		void RasterizeTile(unsigned int tile);
+	private:
+		JobSystem * m_JobSystem;
+		SoftwareFramebuffer * m_Target = nullptr;
+		unsigned int m_TilesX = 0;
+		unsigned int m_TilesY = 0;
+
+		float m_ViewportX = 0.0f, m_ViewportY = 0.0f;
+		float m_ViewportWidth = 0.0f, m_ViewportHeight = 0.0f;
+		float m_MinDepth = 0.0f, m_MaxDepth = 1.0f;
+		int m_ScissorMinX = 0, m_ScissorMinY = 0;
+		int m_ScissorMaxX = -1, m_ScissorMaxY = -1;	// Inclusive
+
+		TaggedVector<Triangle, MemTag::Render> m_Triangles;
+		// Per tile, triangle index with the edges that still need testing in the top 3 bits
+		std::vector<TaggedVector<unsigned int, MemTag::Render>> m_Bins;
+		TaggedVector<unsigned int, MemTag::Render> m_BusyTiles;
+
+		SoftwareRasterStats m_Stats;
+	};
+
+}
\ No newline at end of file
@@ -6,16 +6,47 @@
 
 #include "engine/imgui/imguilogger.h"
 #include "engine/imgui/imguiconsole.h"
+#include "engine/imgui/imguiprofiler.h"
+#include "engine/imgui/imguiframestats.h"
+#include "engine/imgui/imguimemory.h"
+#include "engine/essentials/framestats.h"
+#include "engine/essentials/tracer.h"
+#include "engine/essentials/logfilesink.h"
+#include "platform/nullwindow.h"
 
 namespace prev {
 
 	Window * s_Window = nullptr;
 	GraphicsAPI * s_GraphicsAPI = nullptr;
 
-	Application::Application() {
+	// Headless builds only have the null backends
+#if defined(PV_WINDOWING_API_NULL)
+	static const WindowAPI s_DefaultWindowAPI = WindowAPI::WINDOWING_API_NULL;
+#else
+	static const WindowAPI s_DefaultWindowAPI = WindowAPI::WINDOWING_API_GLFW;
+#endif
+
+#if defined(PV_RENDERING_API_NULL)
+	static const RenderingAPI s_DefaultRenderingAPI = RenderingAPI::RENDERING_API_NULL;
+#else
+	static const RenderingAPI s_DefaultRenderingAPI = RenderingAPI::RENDERING_API_DIRECTX;
+#endif
+
+	Application::Application() :
+		Application(s_DefaultWindowAPI, s_DefaultRenderingAPI) {
+	}
+
+	Application::Application(WindowAPI windowAPI, RenderingAPI renderingAPI) {
+	#ifdef PV_PROFILER_ENABLED
+		// Takes the first profiler slot before the workers start
+		Profiler::SetThreadName("Main Thread");
+	#endif
+
+		m_JobSystem = std::make_unique<JobSystem>();
+		Layer::s_JobSystem = m_JobSystem.get();
 
 		WindowDesc winDesc;
-		s_Window = Window::Create(winDesc, WindowAPI::WINDOWING_API_GLFW);
+		s_Window = Window::Create(winDesc, windowAPI);
 		if (s_Window == nullptr) {
 			IsAppReady = false;
 			return;
@@ -24,17 +55,29 @@ namespace prev {
 		GraphicsDesc graphicsDesc(winDesc.Width, winDesc.Height);
 		graphicsDesc.Vsync = false;
 		graphicsDesc.Fullscreen = true;
-		s_GraphicsAPI = GraphicsAPI::Create(s_Window->GetRawPointer(), s_Window->m_WindowAPI, graphicsDesc, RenderingAPI::RENDERING_API_DIRECTX);
+		graphicsDesc.Jobs = m_JobSystem.get();
+		s_GraphicsAPI = GraphicsAPI::Create(s_Window->GetRawPointer(), s_Window->m_WindowAPI, graphicsDesc, renderingAPI);
 		if (s_GraphicsAPI == nullptr) {
 			IsAppReady = false;
 			return;
 		}
+		m_FramePipeline = std::make_unique<FramePipeline>(s_GraphicsAPI, m_JobSystem.get());
 
-		s_Window->SetEventCallbackFunc(BIND_EVENT_FN(Application::EventCallbackFunc));
+		// Window events are queued and handed to the layers once per frame, see Run
+		s_Window->SetEventCallbackFunc([this](Event & e) -> void {
+			m_EventQueue.Push(e);
+		});
 		Timer::FPSCounter(false);
 
 		IMGUI_CALL(m_ImGuiLayer = new ImGuiLayer(s_Window->m_WindowAPI, s_GraphicsAPI->m_RenderingAPI));
 		IMGUI_CALL(m_LayerStack.PushOverlay(new ImGuiLogger()));
+		IMGUI_CALL(m_LayerStack.PushOverlay(new ImGuiFrameStats()));
+	#ifdef PV_PROFILER_ENABLED
+		IMGUI_CALL(m_LayerStack.PushOverlay(new ImGuiProfiler()));
+	#endif
+	#ifdef PV_MEMORY_TRACKING_ENABLED
+		IMGUI_CALL(m_LayerStack.PushOverlay(new ImGuiMemory()));
+	#endif
 		IMGUI_CALL(
 
 			auto imguiconsole = new ImGuiConsole(); 
@@ -61,6 +104,7 @@ namespace prev {
 				}
 				int index = std::atoi(cmdParam[1].c_str());
 
+				m_FramePipeline->WaitIdle();
 				s_GraphicsAPI->ChangeResolution(index);
 			});
 			imguiconsole->AddConsoleCommand("window_fullscreen",
@@ -73,12 +117,160 @@ namespace prev {
 													return;
 												}
 												bool fullscreen = std::atoi(cmdParam[1].c_str());
+												m_FramePipeline->WaitIdle();
 												s_GraphicsAPI->SetFullscreen(fullscreen);
 											});
+			imguiconsole->AddConsoleCommand("frame_latency",
+											"Frames simulated ahead of the one being presented\n"
+											"------------------------------------------------\n"
+											"1 : no render thread\n"
+											"2 or 3 : present on a render thread\n",
+											[this](const std::vector<std::string> & cmdParam) -> void {
+												if (cmdParam.size() != 2) {
+													PV_LOG_INFO("Frame latency : %u", GetFrameLatency());
+													return;
+												}
+												SetFrameLatency((unsigned int)std::atoi(cmdParam[1].c_str()));
+											});
+			imguiconsole->AddConsoleCommand("frame_stats",
+											"Frame time percentiles over the last N frames\n"
+											"---------------------------------------------\n"
+											"frame_stats : log every window\n"
+											"frame_stats reset\n"
+											"frame_stats hitch [ms] (0 : twice the median)\n"
+											"frame_stats window [index] [frames]\n"
+											"frame_stats overlay [0 or 1]\n",
+											[this](const std::vector<std::string> & cmdParam) -> void {
+												if (cmdParam.size() == 1) {
+													PV_LOG_INFO("Frame times in ms, hitch threshold %.2f ms (0 : twice the median)", FrameStats::GetHitchThreshold());
+													for (unsigned int i = 0; i < FrameStats::GetWindowCount(); i++) {
+														FrameTimeStats stats = FrameStats::GetStats(i);
+														PV_LOG_INFO("[%u frames] mean %.2f, p50 %.2f, p95 %.2f, p99 %.2f, p99.9 %.2f, max %.2f ms, %u hitches",
+																	stats.Frames, stats.MeanMs, stats.P50Ms, stats.P95Ms, stats.P99Ms, stats.P999Ms, stats.MaxMs, stats.Hitches);
+													}
+												} else if (cmdParam[1] == "reset") {
+													FrameStats::Reset();
+												} else if (cmdParam[1] == "hitch" && cmdParam.size() == 3) {
+													FrameStats::SetHitchThreshold((float)std::atof(cmdParam[2].c_str()));
+												} else if (cmdParam[1] == "window" && cmdParam.size() == 4) {
+													FrameStats::SetWindow((unsigned int)std::atoi(cmdParam[2].c_str()), (unsigned int)std::atoi(cmdParam[3].c_str()));
+												} else if (cmdParam[1] == "overlay" && cmdParam.size() == 3) {
+													ImGuiFrameStats::SetVisible(std::atoi(cmdParam[2].c_str()) != 0);
+												}
+											});
+			imguiconsole->AddConsoleCommand("frame_pacer",
+											"Cap the frame rate instead of spinning the cpu\n"
+											"----------------------------------------------\n"
+											"frame_pacer : log the pacing stats\n"
+											"frame_pacer off\n"
+											"frame_pacer cap [fps]\n"
+											"frame_pacer adaptive [fps] : start each frame as late as possible\n"
+											"frame_pacer reset\n",
+											[this](const std::vector<std::string> & cmdParam) -> void {
+												if (cmdParam.size() == 1) {
+													FramePacingStats stats = m_FramePacer.GetStats();
+													PV_LOG_INFO("%llu frames, %llu missed, wake error mean %.1f max %.1f us, deadline error %.1f us, sleep granularity %.1f us",
+																stats.Frames, stats.MissedDeadlines, stats.MeanWakeErrorUs, stats.MaxWakeErrorUs, stats.MeanDeadlineErrorUs, stats.SleepGranularityUs);
+													PV_LOG_INFO("Predicted cost %.2f ms, slept %.1f ms, spun %.1f ms", stats.PredictedCostMs, stats.SleptMs, stats.SpunMs);
+												} else if (cmdParam[1] == "off") {
+													m_FramePacer.SetMode(FramePacingMode::Off);
+												} else if (cmdParam[1] == "reset") {
+													m_FramePacer.ResetStats();
+												} else if ((cmdParam[1] == "cap" || cmdParam[1] == "adaptive") && cmdParam.size() == 3) {
+													m_FramePacer.SetMode(cmdParam[1] == "cap" ? FramePacingMode::Cap : FramePacingMode::Adaptive);
+													m_FramePacer.SetTargetFPS((float)std::atof(cmdParam[2].c_str()));
+												}
+											});
+			imguiconsole->AddConsoleCommand("frame_memory", "Log how much of the per frame arena the last frame used", [this](const std::vector<std::string> & cmdParam) -> void {
+				const FrameAllocatorStats & stats = m_FrameAllocator.GetLastFrameStats();
+				PV_LOG_INFO("Frame arena : %llu allocations, %llu / %llu bytes, %llu overflows (%llu bytes), %llu overflows total",
+							stats.Allocations, stats.Used, stats.Capacity, stats.Overflows, stats.OverflowBytes, m_FrameAllocator.GetTotalOverflows());
+			});
+			imguiconsole->AddConsoleCommand("render_state", "Log the state changes the last submitted frame made and the ones the state cache skipped", [this](const std::vector<std::string> & cmdParam) -> void {
+				RenderStateCounters counters = s_GraphicsAPI->GetStateCounters();
+				for (unsigned int i = 0; i < (unsigned int)RenderState::Count; i++)
+					PV_LOG_INFO("%-12s %8u issued %8u filtered", RenderStateCache::GetStateName((RenderState)i), counters.Issued[i], counters.Filtered[i]);
+				PV_LOG_INFO("%-12s %8u issued %8u filtered (%.1f%%)", "Total", counters.GetIssued(), counters.GetFiltered(), counters.GetFilterRate() * 100.0f);
+			});
+			imguiconsole->AddConsoleCommand("log_file_start",
+											"Write the log to a file from a background thread\n"
+											"-----------------------------------------------\n"
+											"log_file_start [file] [binary] (default : log.txt)\n"
+											"binary 1 writes the compact format, read it with PrevLogDecode\n",
+											[this](const std::vector<std::string> & cmdParam) -> void {
+												LogFileSinkDesc desc(cmdParam.size() > 1 ? cmdParam[1] : "log.txt");
+												desc.Binary = cmdParam.size() > 2 && std::atoi(cmdParam[2].c_str());
+												m_LogFileSink.reset();
+												m_LogFileSink = std::make_unique<LogFileSink>(desc);
+												if (m_LogFileSink->IsOpen())
+													PV_LOG_INFO("Logging to %s", desc.FilePath);
+												else
+													m_LogFileSink.reset();
+											});
+			imguiconsole->AddConsoleCommand("log_file_stop", "Stop writing the log to a file", [this](const std::vector<std::string> & cmdParam) -> void {
+				m_LogFileSink.reset();
+			});
+			imguiconsole->AddConsoleCommand("input_record_start",
+											"Record every handled event to a file, replay it with the null window\n"
+											"--------------------------------------------------------------------\n"
+											"input_record_start [file] (default : input.pvinput)\n",
+											[this](const std::vector<std::string> & cmdParam) -> void {
+												std::string file = cmdParam.size() > 1 ? cmdParam[1] : "input.pvinput";
+												if (StartInputRecording(file))
+													PV_LOG_INFO("Recording input to %s", file);
+											});
+			imguiconsole->AddConsoleCommand("input_record_stop", "Stop recording input", [this](const std::vector<std::string> & cmdParam) -> void {
+				StopInputRecording();
+			});
 		);
+	#ifdef PV_MEMORY_TRACKING_ENABLED
+		IMGUI_CALL(
+			imguiconsole->AddConsoleCommand("memory",
+											"Memory owned by each subsystem (MemTag)\n"
+											"---------------------------------------\n"
+											"memory : log live, peak, count and rate of every tag\n"
+											"memory reset : peaks start over from what is live\n"
+											"memory panel [0 or 1]\n",
+											[this](const std::vector<std::string> & cmdParam) -> void {
+												if (cmdParam.size() == 1)
+													MemoryTracker::LogStats();
+												else if (cmdParam[1] == "reset")
+													MemoryTracker::ResetPeaks();
+												else if (cmdParam[1] == "panel" && cmdParam.size() == 3)
+													ImGuiMemory::SetVisible(std::atoi(cmdParam[2].c_str()) != 0);
+											});
+		);
+	#endif
+	#ifdef PV_PROFILER_ENABLED
+		IMGUI_CALL(
+			imguiconsole->AddConsoleCommand("trace_start",
+											"Start writing profiled frames to a chrome://tracing file\n"
+											"--------------------------------------------------------\n"
+											"trace_start [file] (default : trace.json)\n",
+											[this](const std::vector<std::string> & cmdParam) -> void {
+												std::string file = cmdParam.size() > 1 ? cmdParam[1] : "trace.json";
+												if (Tracer::Start(file))
+													PV_LOG_INFO("Tracing to %s", file);
+												else
+													PV_LOG_ERROR("Unable to start trace to %s", file);
+											});
+			imguiconsole->AddConsoleCommand("trace_stop", "Stop the running trace and close the file", [this](const std::vector<std::string> & cmdParam) -> void {
+				Tracer::Stop();
+				PV_IMGUI_LOG("Trace stopped", LogLevel::PV_INFO);
+			});
+		);
+	#endif
 	}
 
 	Application::~Application() {
+		// Render thread goes first, it uses the graphics api and the ImGui draw data
+		m_FramePipeline.reset();
+	#ifdef PV_PROFILER_ENABLED
+		Tracer::Stop();
+	#endif
+		m_InputRecorder.Stop();
+		Log::Drain();
+		m_LogFileSink.reset();
 		if (s_Window != nullptr) {
 			delete s_Window;
 			s_Window = nullptr;
@@ -96,32 +288,75 @@ namespace prev {
 
 	void Application::Run() {
 		while (IsAppRunning) {
+			PV_PROFILE_FRAME();
+			{
+				// Before input is read, so adaptive pacing gets the freshest input it can
+				PV_PROFILE_SCOPE("FramePacer::BeginFrame");
+				m_FramePacer.BeginFrame();
+			}
+			PV_PROFILE_SCOPE("Application::Run");
+
+			// The render thread may still read what frame N - BufferCount put in the arena we're about to reset
+			if (m_FrameIndex >= FrameAllocator::BufferCount)
+				m_FramePipeline->WaitForFrame(m_FrameIndex - FrameAllocator::BufferCount);
+			m_FrameAllocator.BeginFrame(m_FrameIndex);
+
 			Timer::Update();
-			s_Window->Update();
-			s_GraphicsAPI->StartFrame();
+		#ifdef PV_MEMORY_TRACKING_ENABLED
+			MemoryTracker::Update();
+		#endif
+			Log::Drain();
+			{
+				PV_PROFILE_SCOPE("Window::Update");
+				s_Window->Update();
+			}
+			{
+				PV_PROFILE_SCOPE("Application::DispatchEvents");
+				m_EventQueue.Dispatch(BIND_EVENT_FN(Application::EventCallbackFunc));
+			}
 
+			if (m_RequestedFrameLatency != m_FramePipeline->GetFrameLatency())
+				m_FramePipeline->SetFrameLatency(m_RequestedFrameLatency);
+			FramePacket & packet = m_FramePipeline->BeginPacket(m_FrameIndex, Timer::GetDeltaTime());
+			Layer::s_FramePacket = &packet;
+
+			while (Timer::ConsumeFixedStep())
+				m_LayerStack.OnFixedUpdate();
 			m_LayerStack.OnUpdate();
 
-			IMGUI_CALL (
-				m_ImGuiLayer->StartFrame();
-				m_LayerStack.OnImGuiUpdate();
-				m_ImGuiLayer->EndFrame();
-			);
+			{
+				PV_PROFILE_SCOPE("ImGui");
+				IMGUI_CALL (
+					m_ImGuiLayer->StartFrame();
+					m_LayerStack.OnImGuiUpdate();
+					m_ImGuiLayer->EndFrame(packet);
+				);
+			}
 
-			s_GraphicsAPI->EndFrame();
+			// StartFrame, render commands and EndFrame, here or on the render thread
+			m_FramePipeline->SubmitPacket();
+			m_FramePacer.EndFrame();
+
+			m_FrameIndex++;
 		}
 	}
 
 	void Application::EventCallbackFunc(Event & e) {
+		PV_PROFILE_SCOPE("Application::EventCallbackFunc");
+
+		if (m_InputRecorder.IsRecording())
+			m_InputRecorder.Record(m_FrameIndex, Timer::GetTime(), e);
 
 		m_LayerStack.OnEvent(e);
 		m_ImGuiLayer->OnEvent(e);
 
-		if (e.GetCategoryFlags() & EventCategoryApplication)
+		if (e.GetCategoryFlags() & EventCategoryApplication) {
+			m_FramePipeline->WaitIdle();
 			s_GraphicsAPI->OnEvent(e);
+		}
 
 		EventDispatcher dispatcher(e);
-		dispatcher.Dispatch<WindowCloseEvent>(BIND_EVENT_FN(Application::WindowCloseFunc));
+		dispatcher.Dispatch(this, &Application::WindowCloseFunc);
 
 		//PV_DEBUG_LOG(e.ToString().c_str());
 	}
@@ -131,6 +366,42 @@ namespace prev {
 		return true;
 	}
 
+	void Application::SetFrameLatency(unsigned int frameLatency) {
+		frameLatency = std::min(std::max(frameLatency, 1u), FramePipeline::MaxFrameLatency);
+		if (frameLatency > 1 && !s_GraphicsAPI->SupportsRenderThread()) {
+			PV_LOG_WARN("This graphics api can't present from a render thread, frame latency stays at 1");
+			frameLatency = 1;
+		}
+		m_RequestedFrameLatency = frameLatency;
+	}
+
+	unsigned int Application::GetFrameLatency() const {
+		return m_RequestedFrameLatency;
+	}
+
+	bool Application::StartInputRecording(const std::string & filePath) {
+		return m_InputRecorder.Start(filePath, m_FrameIndex);
+	}
+
+	void Application::StopInputRecording() {
+		m_InputRecorder.Stop();
+	}
+
+	bool Application::StartInputReplay(const std::string & filePath) {
+		if (s_Window->m_WindowAPI != WindowAPI::WINDOWING_API_NULL) {
+			PV_LOG_ERROR("Input replay needs the null window");
+			return false;
+		}
+
+		auto replay = std::make_unique<InputReplay>();
+		if (!replay->Load(filePath))
+			return false;
+		replay->Attach((NullWindow *)s_Window);
+		m_InputReplay = std::move(replay);
+		PV_LOG_INFO("Replaying %zu events from %s", m_InputReplay->GetEventCount(), filePath);
+		return true;
+	}
+
 	void * Application::GetGraphicsAPI() {
 		return s_GraphicsAPI;
 	}
@@ -1,33 +1,69 @@
 #pragma once
 
-//#include <vld.h> //Use vld to check memory leaks
-
 #include "engine/events/event.h"
 #include "engine/events/applicationevent.h"
+#include "engine/events/eventqueue.h"
 #include "engine/layer/layerstack.h"
 #include "engine/imgui/imguilayer.h"
+#include "engine/input/inputrecorder.h"
+#include "engine/jobs/jobsystem.h"
+#include "engine/framepipeline.h"
+#include "engine/framepacer.h"
+#include "engine/memory/frameallocator.h"
+#include "engine/memory/memorytracker.h"
 
 namespace prev {
 
+	class LogFileSink;
+
 	class Application {
 		friend class ImGuiLayer;
 	public:
 		Application();
 		~Application();
+	protected:
+		// Lets tools (benchmarks, tests) choose the backends, e.g. the null ones
+		Application(WindowAPI windowAPI, RenderingAPI renderingAPI);
 	public:
 		void Run();
 		void EventCallbackFunc(Event & e);
 		bool WindowCloseFunc(WindowCloseEvent & e);
 		inline LayerStack & GetLayerStack() noexcept { return m_LayerStack; }
-	private:
+		inline EventQueue & GetEventQueue() noexcept { return m_EventQueue; }
+		inline JobSystem & GetJobSystem() noexcept { return *m_JobSystem; }
+		inline unsigned long long GetFrameIndex() const noexcept { return m_FrameIndex; }
+		inline FramePacer & GetFramePacer() noexcept { return m_FramePacer; }
+		inline FrameAllocator & GetFrameAllocator() noexcept { return m_FrameAllocator; }
+
+		bool StartInputRecording(const std::string & filePath);
+		void StopInputRecording();
+		// Only with the null window, the recorded events replace whatever the window would send
+		bool StartInputReplay(const std::string & filePath);
+		inline const InputReplay * GetInputReplay() const { return m_InputReplay.get(); }
+
+		// 1 presents inline, 2 or 3 lets a render thread present while the next frames simulate. Applied at the start of the next frame
+		void SetFrameLatency(unsigned int frameLatency);
+		unsigned int GetFrameLatency() const;
+	protected:
 		static void * GetGraphicsAPI();
 		static void * GetWindow();
 	public:
 		bool IsAppReady = true;
 		bool IsAppRunning = true;
 	private:
+		// Declared first so it outlives the layers
+		std::unique_ptr<JobSystem> m_JobSystem;
 		LayerStack m_LayerStack;
+		EventQueue m_EventQueue;
+		unsigned long long m_FrameIndex = 0;
+		InputRecorder m_InputRecorder;
+		std::unique_ptr<InputReplay> m_InputReplay;
+		std::unique_ptr<FramePipeline> m_FramePipeline;
+		unsigned int m_RequestedFrameLatency = 1;
+		FramePacer m_FramePacer;
+		FrameAllocator m_FrameAllocator;
 		ImGuiLayer * m_ImGuiLayer = nullptr;
+		std::unique_ptr<LogFileSink> m_LogFileSink;
 	};
 
 }
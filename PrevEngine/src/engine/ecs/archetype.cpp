@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "archetype.h"
+
+namespace prev {
+
+	static_assert(sizeof(Chunk) <= Archetype::CacheLineSize, "Chunk header must fit in a cache line");
+
+	const size_t Archetype::ChunkSize;
+	const size_t Archetype::CacheLineSize;
+	const unsigned int Archetype::NoOffset;
+
+	static size_t AlignUp(size_t value, size_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	Archetype::Archetype(ComponentMask mask, FixedPool & chunkPool) :
+		m_Mask(mask), m_ChunkPool(chunkPool) {
+		m_Offsets.fill(NoOffset);
+		m_AddEdges.fill(nullptr);
+		m_RemoveEdges.fill(nullptr);
+		size_t rowSize = sizeof(Entity);
+		for (ComponentId id = 0; id < ComponentRegistry::MaxComponents; id++) {
+			if (Has(id)) {
+				m_Components.push_back(id);
+				rowSize += ComponentRegistry::GetInfo(id).Size;
+			}
+		}
+
+		// As many rows as fit without padding, then fewer until every array can start on a cache line
+		unsigned int capacity = std::max(1u, (unsigned int)((ChunkSize - CacheLineSize) / rowSize));
+		for (;; capacity--) {
+			size_t offset = AlignUp(CacheLineSize + capacity * sizeof(Entity), CacheLineSize);
+			for (ComponentId id : m_Components) {
+				m_Offsets[id] = (unsigned int)offset;
+				offset = AlignUp(offset + capacity * ComponentRegistry::GetInfo(id).Size, CacheLineSize);
+			}
+			if (offset <= ChunkSize)
+				break;
+			if (capacity == 1) {
+				PV_LOG_FATAL("Archetype %llx doesn't fit one entity in a %u byte chunk", mask, (unsigned int)ChunkSize);
+				std::abort();
+			}
+		}
+		m_ChunkCapacity = capacity;
+	}
+
+	Archetype::~Archetype() {
+		for (Chunk * chunk : m_Chunks)
+			m_ChunkPool.Free(chunk);
+	}
+
+	void Archetype::Push(Entity entity, unsigned int & chunkIndex, unsigned int & row) {
+		if (m_Chunks.empty() || m_Chunks.back()->Count == m_ChunkCapacity) {
+			Chunk * chunk = (Chunk *)m_ChunkPool.Allocate();
+			chunk->Owner = this;
+			chunk->Count = 0;
+			m_Chunks.push_back(chunk);
+		}
+
+		Chunk * chunk = m_Chunks.back();
+		chunkIndex = (unsigned int)m_Chunks.size() - 1;
+		row = chunk->Count++;
+		chunk->GetEntities()[row] = entity;
+		m_EntityCount++;
+	}
+
+	Entity Archetype::Erase(unsigned int chunkIndex, unsigned int row) {
+		Chunk * chunk = m_Chunks[chunkIndex];
+		Chunk * last = m_Chunks.back();
+		unsigned int lastRow = last->Count - 1;
+
+		Entity moved;
+		if (chunk != last || row != lastRow) {
+			moved = last->GetEntities()[lastRow];
+			chunk->GetEntities()[row] = moved;
+			for (ComponentId id : m_Components) {
+				size_t size = ComponentRegistry::GetInfo(id).Size;
+				std::memcpy(chunk->GetBytes() + m_Offsets[id] + row * size, last->GetBytes() + m_Offsets[id] + lastRow * size, size);
+			}
+		}
+
+		m_EntityCount--;
+		if (--last->Count == 0) {
+			m_ChunkPool.Free(last);
+			m_Chunks.pop_back();
+		}
+		return moved;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "component.h"
+#include "engine/memory/poolallocator.h"
+
+#include <array>
+
+namespace prev {
+
+	class Archetype;
+
+	// A 16 KB block holding entities of one archetype. This header takes the first cache line,
+	// then come the entity handles and one array per component, each starting on a cache line of its own
+	struct Chunk {
+		Archetype * Owner;
+		unsigned int Count;
+
+		inline char * GetBytes() { return (char *)this; }
+		inline Entity * GetEntities();
+		// nullptr when the archetype doesn't have the component
+		inline void * GetArray(ComponentId id);
+		template<typename T>
+		inline T * Get() { return (T *)GetArray(GetComponentId<T>()); }
+	};
+
+	// Every entity with exactly the same set of components, packed into chunks
+	// Only the last chunk has room, removing an entity moves the last one into its place
+	class Archetype {
+	public:
+		static const size_t ChunkSize = 16 * 1024;
+		static const size_t CacheLineSize = 64;
+		static const unsigned int NoOffset = ~0u;
+	public:
+		Archetype(ComponentMask mask, FixedPool & chunkPool);
+		~Archetype();
+
+		Archetype(const Archetype &) = delete;
+		Archetype & operator=(const Archetype &) = delete;
+
+		// Appends the entity, its components are left for the caller to fill in
+		void Push(Entity entity, unsigned int & chunkIndex, unsigned int & row);
+		// Returns the entity that was moved into the hole, an invalid one when the last entity was removed
+		Entity Erase(unsigned int chunkIndex, unsigned int row);
+
+		inline ComponentMask GetMask() const { return m_Mask; }
+		inline bool Has(ComponentId id) const { return (m_Mask >> id) & 1; }
+		inline unsigned int GetOffset(ComponentId id) const { return m_Offsets[id]; }
+		inline void * GetComponent(unsigned int chunkIndex, unsigned int row, ComponentId id) const {
+			return m_Chunks[chunkIndex]->GetBytes() + m_Offsets[id] + row * ComponentRegistry::GetInfo(id).Size;
+		}
+
+		// Where adding or removing a component takes an entity, filled in by the world the first time it's needed
+		inline Archetype * GetAddEdge(ComponentId id) const { return m_AddEdges[id]; }
+		inline Archetype * GetRemoveEdge(ComponentId id) const { return m_RemoveEdges[id]; }
+		inline void SetAddEdge(ComponentId id, Archetype * archetype) { m_AddEdges[id] = archetype; }
+		inline void SetRemoveEdge(ComponentId id, Archetype * archetype) { m_RemoveEdges[id] = archetype; }
+
+		inline unsigned int GetChunkCapacity() const { return m_ChunkCapacity; }
+		inline unsigned int GetChunkCount() const { return (unsigned int)m_Chunks.size(); }
+		inline Chunk * GetChunk(unsigned int chunkIndex) const { return m_Chunks[chunkIndex]; }
+		inline unsigned int GetEntityCount() const { return m_EntityCount; }
+		inline const TaggedVector<ComponentId, MemTag::Entity> & GetComponents() const { return m_Components; }
+	private:
+		ComponentMask m_Mask;
+		TaggedVector<ComponentId, MemTag::Entity> m_Components;	// Ascending ids
+		std::array<unsigned int, ComponentRegistry::MaxComponents> m_Offsets;	// From the start of a chunk, NoOffset when missing
+		unsigned int m_ChunkCapacity;
+		std::array<Archetype *, ComponentRegistry::MaxComponents> m_AddEdges;
+		std::array<Archetype *, ComponentRegistry::MaxComponents> m_RemoveEdges;
+
+		FixedPool & m_ChunkPool;
+		TaggedVector<Chunk *, MemTag::Entity> m_Chunks;
+		unsigned int m_EntityCount = 0;
+	};
+
+	inline Entity * Chunk::GetEntities() {
+		return (Entity *)(GetBytes() + Archetype::CacheLineSize);
+	}
+
+	inline void * Chunk::GetArray(ComponentId id) {
+		unsigned int offset = Owner->GetOffset(id);
+		return offset != Archetype::NoOffset ? GetBytes() + offset : nullptr;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "pch.h"
+#include "component.h"
+
+namespace prev {
+
+	const unsigned int ComponentRegistry::MaxComponents;
+	const size_t ComponentRegistry::MaxAlignment;
+
+	static ComponentInfo s_Components[ComponentRegistry::MaxComponents];
+	static unsigned int s_ComponentCount = 0;
+	static std::mutex s_ComponentMutex;
+
+	ComponentId ComponentRegistry::Register(const char * name, size_t size, size_t alignment) {
+		std::lock_guard<std::mutex> lock(s_ComponentMutex);
+		if (s_ComponentCount == MaxComponents) {
+			PV_LOG_FATAL("More than %u component types, %s can't be registered", MaxComponents, name);
+			std::abort();
+		}
+		s_Components[s_ComponentCount] = { name, size, alignment };
+		return s_ComponentCount++;
+	}
+
+	const ComponentInfo & ComponentRegistry::GetInfo(ComponentId id) {
+		return s_Components[id];
+	}
+
+	unsigned int ComponentRegistry::GetCount() {
+		std::lock_guard<std::mutex> lock(s_ComponentMutex);
+		return s_ComponentCount;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <typeinfo>
+
+namespace prev {
+
+	// Refers to an entity in a World, goes stale (World::IsAlive returns false) once the entity is destroyed
+	struct Entity {
+		unsigned int Index = ~0u;
+		unsigned int Generation = 0;
+
+		inline bool IsValid() const { return Index != ~0u; }
+		inline bool operator==(const Entity & other) const { return Index == other.Index && Generation == other.Generation; }
+		inline bool operator!=(const Entity & other) const { return !(*this == other); }
+	};
+
+	typedef unsigned int ComponentId;
+	// One bit per ComponentId, an archetype is the set of components its entities have
+	typedef unsigned long long ComponentMask;
+
+	struct ComponentInfo {
+		const char * Name;
+		size_t Size;
+		size_t Alignment;
+	};
+
+	// Component types get an id the first time they are used, in whatever order that happens
+	// Components are plain data, they are moved between chunks with memcpy and never destroyed
+	class ComponentRegistry {
+	public:
+		static const unsigned int MaxComponents = 64;
+		static const size_t MaxAlignment = 64;	// Component arrays start on a cache line
+	public:
+		template<typename T>
+		static ComponentId GetId() {
+			static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Components must be plain data");
+			static_assert(alignof(T) <= MaxAlignment, "Component is over aligned");
+			static const ComponentId id = Register(typeid(T).name(), sizeof(T), alignof(T));
+			return id;
+		}
+
+		static const ComponentInfo & GetInfo(ComponentId id);
+		static unsigned int GetCount();
+	private:
+		static ComponentId Register(const char * name, size_t size, size_t alignment);
+	};
+
+	// const T is the same component as T
+	template<typename T>
+	inline ComponentId GetComponentId() {
+		return ComponentRegistry::GetId<std::remove_const_t<T>>();
+	}
+
+	template<typename... Ts>
+	inline ComponentMask GetComponentMask() {
+		return (0ull | ... | (1ull << GetComponentId<Ts>()));
+	}
+
+	// True when no component shows up twice, a mask can't tell them apart
+	template<typename... Ts>
+	struct AreDistinctComponents : std::true_type {};
+
+	template<typename T, typename... Ts>
+	struct AreDistinctComponents<T, Ts...> : std::bool_constant<!(std::is_same_v<std::remove_const_t<T>, std::remove_const_t<Ts>> || ...) && AreDistinctComponents<Ts...>::value> {};
+
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "entitycommandbuffer.h"
+
+#include "world.h"
+
+namespace prev {
+
+	static thread_local unsigned long long t_SortKey = 0;
+
+	void EntityCommandBuffer::SetSortKey(unsigned long long key) {
+		t_SortKey = key;
+	}
+
+	unsigned long long EntityCommandBuffer::GetSortKey() {
+		return t_SortKey;
+	}
+
+	void EntityCommandBuffer::Write(const void * data, size_t size) {
+		m_Data.insert(m_Data.end(), (const char *)data, (const char *)data + size);
+	}
+
+	void EntityCommandBuffer::WriteHeader(CommandType type, Entity target, ComponentId component, ComponentMask mask) {
+		Header header;
+		header.Type = type;
+		header.Component = component;
+		header.Target = target;
+		header.Mask = mask;
+		m_Commands.push_back({ t_SortKey, m_Data.size() });
+		Write(&header, sizeof(Header));
+	}
+
+	void EntityCommandBuffer::WriteComponent(ComponentId id, const void * data, size_t size) {
+		Write(&id, sizeof(ComponentId));
+		Write(data, size);
+	}
+
+	void EntityCommandBuffer::PlayBack(World & world) {
+		for (const Command & command : m_Commands)
+			Apply(world, command.Offset);
+		Reset();
+	}
+
+	void EntityCommandBuffer::Apply(World & world, size_t offset) const {
+		const char * data = m_Data.data() + offset;
+		Header header;
+		std::memcpy(&header, data, sizeof(Header));
+		data += sizeof(Header);
+
+		switch (header.Type) {
+			case CommandType::Create: {
+				Entity entity = world.CreateEntity(header.Mask);
+				for (ComponentMask left = header.Mask; left != 0; left &= left - 1) {
+					ComponentId id;
+					std::memcpy(&id, data, sizeof(ComponentId));
+					data += sizeof(ComponentId);
+					size_t size = ComponentRegistry::GetInfo(id).Size;
+					std::memcpy(world.GetComponent(entity, id), data, size);
+					data += size;
+				}
+				break;
+			}
+			case CommandType::Destroy:
+				world.Destroy(header.Target);
+				break;
+			case CommandType::Add: {
+				size_t size = ComponentRegistry::GetInfo(header.Component).Size;
+				if (void * component = world.AddComponent(header.Target, header.Component))
+					std::memcpy(component, data, size);
+				break;
+			}
+			case CommandType::Remove:
+				world.RemoveComponent(header.Target, header.Component);
+				break;
+		}
+	}
+
+	void EntityCommandBuffer::Reset() {
+		m_Data.clear();
+		m_Commands.clear();
+	}
+
+}
\ No newline at end of file
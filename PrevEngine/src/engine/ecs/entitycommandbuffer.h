@@ -0,0 +1,83 @@
+#pragma once
+
+#include "component.h"
+#include "engine/memory/memorytracker.h"
+
+namespace prev {
+
+	class World;
+
+	// Structural changes recorded while systems run, World::PlayBack applies them once they are done
+	// Not thread safe, get one per thread from World::GetCommandBuffer
+	class EntityCommandBuffer {
+		friend class World;
+	public:
+		EntityCommandBuffer() = default;
+
+		EntityCommandBuffer(const EntityCommandBuffer &) = delete;
+		EntityCommandBuffer & operator=(const EntityCommandBuffer &) = delete;
+
+		// Each component type once
+		template<typename... Ts>
+		void Create(const Ts &... components) {
+			static_assert(AreDistinctComponents<Ts...>::value, "Each component type once");
+			WriteHeader(CommandType::Create, Entity(), 0, GetComponentMask<Ts...>());
+			(WriteComponent(GetComponentId<Ts>(), &components, sizeof(Ts)), ...);
+		}
+
+		// Commands for an entity that is gone by the time they are played back are skipped
+		void Destroy(Entity entity) {
+			WriteHeader(CommandType::Destroy, entity, 0, 0);
+		}
+
+		// Replaces the component when the entity already has it
+		template<typename T>
+		void Add(Entity entity, const T & component) {
+			WriteHeader(CommandType::Add, entity, GetComponentId<T>(), 0);
+			Write(&component, sizeof(T));
+		}
+
+		template<typename T>
+		void Remove(Entity entity) {
+			WriteHeader(CommandType::Remove, entity, GetComponentId<T>(), 0);
+		}
+
+		// Applies the commands in the order they were recorded and empties the buffer, keeps its memory
+		void PlayBack(World & world);
+		void Reset();
+
+		// Commands are recorded with the calling thread's key, World::PlayBack sorts every buffer's commands by it
+		// SystemScheduler gives each system its own range and Query::ParallelForEach each chunk its own key inside it
+		static void SetSortKey(unsigned long long key);
+		static unsigned long long GetSortKey();
+
+		inline unsigned int GetCommandCount() const { return (unsigned int)m_Commands.size(); }
+		inline bool IsEmpty() const { return m_Commands.empty(); }
+	private:
+		enum class CommandType : unsigned char {
+			Create, Destroy, Add, Remove
+		};
+
+		// Component data follows unaligned, it's memcpy'd straight into a chunk
+		struct Header {
+			CommandType Type;
+			ComponentId Component;
+			Entity Target;
+			ComponentMask Mask;
+		};
+
+		struct Command {
+			unsigned long long Key;
+			size_t Offset;		// Of its header in m_Data
+		};
+
+		void WriteHeader(CommandType type, Entity target, ComponentId component, ComponentMask mask);
+		void WriteComponent(ComponentId id, const void * data, size_t size);
+		void Write(const void * data, size_t size);
+		void Apply(World & world, size_t offset) const;
+	private:
+		TaggedVector<char, MemTag::Entity> m_Data;
+		TaggedVector<Command, MemTag::Entity> m_Commands;
+	};
+
+}
\ No newline at end of file
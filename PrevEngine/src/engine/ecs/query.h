@@ -0,0 +1,124 @@
+#pragma once
+
+#include "world.h"
+#include "engine/jobs/jobsystem.h"
+
+#include <type_traits>
+
+namespace prev {
+
+	// Every entity that has all of Ts, const Ts are only read. Walks the matching chunks one after the other
+	// A query remembers which archetypes matched, keep it around (a member of a system) instead of making one per frame
+	// Don't change the world's structure while a query walks it, record the changes in a command buffer
+	template<typename... Ts>
+	class Query {
+	public:
+		Query() : m_Required(GetComponentMask<Ts...>()) { }
+
+		// Entities that also have any of these are skipped
+		template<typename... Us>
+		Query & Without() {
+			m_Excluded |= GetComponentMask<Us...>();
+			m_World = nullptr;
+			return *this;
+		}
+
+		// func(Ts &...) or func(Entity, Ts &...) for every matching entity
+		template<typename F>
+		void ForEach(World & world, F && func) {
+			Refresh(world);
+			for (Archetype * archetype : m_Archetypes) {
+				for (unsigned int i = 0; i < archetype->GetChunkCount(); i++)
+					RunChunk(*archetype->GetChunk(i), func);
+			}
+		}
+
+		// func(Chunk &) for every matching chunk, chunk.Get<T>() is the array of Count components
+		template<typename F>
+		void ForEachChunk(World & world, F && func) {
+			Refresh(world);
+			for (Archetype * archetype : m_Archetypes) {
+				for (unsigned int i = 0; i < archetype->GetChunkCount(); i++)
+					func(*archetype->GetChunk(i));
+			}
+		}
+
+		// Like ForEach, chunks are spread over the world's job system. func is called from several threads at once
+		// Each chunk records commands with its own sort key after the caller's, so they play back in chunk order
+		template<typename F>
+		void ParallelForEach(World & world, F && func, unsigned int chunksPerJob = 1) {
+			JobSystem * jobSystem = world.GetJobSystem();
+			if (jobSystem == nullptr) {
+				ForEach(world, func);
+				return;
+			}
+
+			GatherChunks(world);
+			Chunk * const * chunks = m_Chunks.data();
+			auto * function = &func;
+			unsigned long long key = EntityCommandBuffer::GetSortKey();
+			jobSystem->ParallelFor((unsigned int)m_Chunks.size(), chunksPerJob, [chunks, function, key](unsigned int i) -> void {
+				unsigned long long previousKey = EntityCommandBuffer::GetSortKey();
+				EntityCommandBuffer::SetSortKey(key + 1 + i);
+				RunChunk(*chunks[i], *function);
+				EntityCommandBuffer::SetSortKey(previousKey);
+			});
+			// Whatever the caller records next comes after the chunks
+			EntityCommandBuffer::SetSortKey(key + 1 + m_Chunks.size());
+		}
+
+		unsigned int GetEntityCount(World & world) {
+			Refresh(world);
+			unsigned int count = 0;
+			for (Archetype * archetype : m_Archetypes)
+				count += archetype->GetEntityCount();
+			return count;
+		}
+	private:
+		void Refresh(World & world) {
+			if (m_World != &world) {
+				m_World = &world;
+				m_Archetypes.clear();
+				m_ArchetypesSeen = 0;
+			}
+			for (; m_ArchetypesSeen < world.GetArchetypeCount(); m_ArchetypesSeen++) {
+				Archetype & archetype = world.GetArchetype(m_ArchetypesSeen);
+				if ((archetype.GetMask() & m_Required) == m_Required && (archetype.GetMask() & m_Excluded) == 0)
+					m_Archetypes.push_back(&archetype);
+			}
+		}
+
+		void GatherChunks(World & world) {
+			Refresh(world);
+			m_Chunks.clear();
+			for (Archetype * archetype : m_Archetypes) {
+				for (unsigned int i = 0; i < archetype->GetChunkCount(); i++)
+					m_Chunks.push_back(archetype->GetChunk(i));
+			}
+		}
+
+		template<typename F>
+		static void RunChunk(Chunk & chunk, F & func) {
+			RunRows(func, chunk.GetEntities(), chunk.Count, chunk.Get<std::remove_const_t<Ts>>()...);
+		}
+
+		template<typename F>
+		static void RunRows(F & func, const Entity * entities, unsigned int count, Ts *... arrays) {
+			for (unsigned int i = 0; i < count; i++) {
+				if constexpr (std::is_invocable_v<F &, Entity, Ts &...>)
+					func(entities[i], arrays[i]...);
+				else
+					func(arrays[i]...);
+			}
+		}
+	private:
+		ComponentMask m_Required;
+		ComponentMask m_Excluded = 0;
+
+		World * m_World = nullptr;
+		unsigned int m_ArchetypesSeen = 0;
+		std::vector<Archetype *> m_Archetypes;
+		std::vector<Chunk *> m_Chunks;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "system.h"
+
+namespace prev {
+
+	static const char * InternName(const std::string & name) {
+		static std::mutex mutex;
+		static std::unordered_set<std::string> names;
+		std::lock_guard<std::mutex> lock(mutex);
+		return names.insert(name).first->c_str();
+	}
+
+	System::System(const std::string & name) :
+		m_Name(name), m_ProfileName(InternName(name)) {
+	}
+
+	System::~System() {
+	}
+
+	void System::DeclareIndependent() {
+		m_DeclaresAccess = true;
+	}
+
+	SystemScheduler::SystemScheduler() {
+	}
+
+	SystemScheduler::~SystemScheduler() {
+	}
+
+	// True when b has to wait for a (a was added first)
+	bool SystemScheduler::Conflicts(const System * a, const System * b) {
+		if (!a->m_DeclaresAccess || !b->m_DeclaresAccess)
+			return true;
+		return (a->m_Writes & (b->m_Reads | b->m_Writes)) != 0 || (a->m_Reads & b->m_Writes) != 0;
+	}
+
+	void SystemScheduler::RebuildSchedule() {
+		// Level of a system is one past the deepest earlier system it conflicts with
+		// An undeclared system conflicts with everything, so it gets a level of its own
+		std::vector<unsigned int> levels(m_Systems.size(), 0);
+		unsigned int levelCount = 0;
+		unsigned int barrier = 0; // Nothing can be placed below the last undeclared system
+		for (unsigned int j = 0; j < m_Systems.size(); j++) {
+			const System * system = m_Systems[j].get();
+			unsigned int level = barrier;
+			if (!system->m_DeclaresAccess) {
+				level = levelCount;
+			} else {
+				for (unsigned int i = 0; i < j; i++) {
+					if (levels[i] >= level && Conflicts(m_Systems[i].get(), system))
+						level = levels[i] + 1;
+				}
+			}
+			levels[j] = level;
+			levelCount = std::max(levelCount, level + 1);
+			if (!system->m_DeclaresAccess)
+				barrier = level + 1;
+		}
+
+		// Stable bucket by level keeps the order they were added in inside a level
+		m_LevelStarts.assign(levelCount + 1, 0);
+		for (unsigned int level : levels)
+			m_LevelStarts[level + 1]++;
+		for (unsigned int i = 0; i < levelCount; i++)
+			m_LevelStarts[i + 1] += m_LevelStarts[i];
+		m_Schedule.resize(m_Systems.size());
+		std::vector<unsigned int> next(m_LevelStarts.begin(), m_LevelStarts.end() - 1);
+		for (unsigned int j = 0; j < m_Systems.size(); j++)
+			m_Schedule[next[levels[j]]++] = m_Systems[j].get();
+
+		m_ScheduleDirty = false;
+	}
+
+	// What the system records sorts after the systems added before it, whichever thread it runs on
+	void SystemScheduler::RunSystem(System * system, World & world, float deltaTime) {
+		PV_PROFILE_SCOPE(system->m_ProfileName);
+		unsigned long long previousKey = EntityCommandBuffer::GetSortKey();
+		EntityCommandBuffer::SetSortKey((unsigned long long)(system->m_Index + 1) << 32);
+		system->OnUpdate(world, deltaTime);
+		EntityCommandBuffer::SetSortKey(previousKey);
+	}
+
+	void SystemScheduler::Run(World & world, float deltaTime) {
+		PV_PROFILE_FUNCTION();
+
+		if (m_ScheduleDirty)
+			RebuildSchedule();
+
+		JobSystem * jobSystem = world.GetJobSystem();
+		world.m_Locked = true;
+		for (unsigned int level = 0; level + 1 < m_LevelStarts.size(); level++) {
+			unsigned int begin = m_LevelStarts[level];
+			unsigned int end = m_LevelStarts[level + 1];
+
+			if (end - begin == 1 || jobSystem == nullptr) {
+				for (unsigned int i = begin; i < end; i++)
+					RunSystem(m_Schedule[i], world, deltaTime);
+				continue;
+			}
+
+			System * const * systems = m_Schedule.data() + begin;
+			World * target = &world;
+			jobSystem->ParallelFor(end - begin, 1, [systems, target, deltaTime](unsigned int i) -> void {
+				RunSystem(systems[i], *target, deltaTime);
+			});
+		}
+		world.m_Locked = false;
+
+		world.PlayBack();
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "query.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace prev {
+
+	// Logic that runs over a World every update, keeps its queries as members
+	// Declaring the components it reads and writes lets it run on a worker next to systems it doesn't conflict with,
+	// a system that declares nothing runs alone, in the order it was added
+	class System {
+		friend class SystemScheduler;
+	public:
+		System(const std::string & name = "System");
+		virtual ~System();
+
+		inline const std::string & GetName() const { return m_Name; }
+	protected:
+		// Call these from the constructor
+		template<typename... Ts>
+		void Reads() {
+			m_Reads |= GetComponentMask<Ts...>();
+			m_DeclaresAccess = true;
+		}
+
+		template<typename... Ts>
+		void Writes() {
+			m_Writes |= GetComponentMask<Ts...>();
+			m_DeclaresAccess = true;
+		}
+
+		// For systems that only record into command buffers
+		void DeclareIndependent();
+	private:
+		// Creating, destroying, adding and removing goes through world.GetCommandBuffer(), it's played back after every system ran
+		virtual void OnUpdate(World & world, float deltaTime) = 0;
+	private:
+		std::string m_Name;
+		const char * m_ProfileName;		// Interned, profiled frames can outlive the system
+
+		ComponentMask m_Reads = 0;
+		ComponentMask m_Writes = 0;
+		bool m_DeclaresAccess = false;
+
+		unsigned int m_Index = 0;		// In the order systems were added, the high half of its command buffer sort key
+	};
+
+	// Owns systems and runs them in levels, like the layer stack runs layers: a level only waits for the ones before it,
+	// the systems inside a level don't conflict and run as jobs in parallel
+	class SystemScheduler {
+	public:
+		SystemScheduler();
+		~SystemScheduler();
+
+		SystemScheduler(const SystemScheduler &) = delete;
+		SystemScheduler & operator=(const SystemScheduler &) = delete;
+
+		template<typename T, typename... Args>
+		T * Add(Args &&... args) {
+			T * system = new T(std::forward<Args>(args)...);
+			system->m_Index = (unsigned int)m_Systems.size();
+			m_Systems.emplace_back(system);
+			m_ScheduleDirty = true;
+			return system;
+		}
+
+		// Runs every system once on the world's job system, then plays back the world's command buffers
+		void Run(World & world, float deltaTime);
+
+		inline unsigned int GetSystemCount() const { return (unsigned int)m_Systems.size(); }
+		// After Run, how many levels the systems were split into
+		inline unsigned int GetLevelCount() const { return m_LevelStarts.empty() ? 0 : (unsigned int)m_LevelStarts.size() - 1; }
+	private:
+		void RebuildSchedule();
+		static void RunSystem(System * system, World & world, float deltaTime);
+		static bool Conflicts(const System * a, const System * b);
+	private:
+		std::vector<std::unique_ptr<System>> m_Systems;		// Order they were added
+
+		std::vector<System *> m_Schedule;					// Grouped by level
+		std::vector<unsigned int> m_LevelStarts;
+		bool m_ScheduleDirty = true;
+	};
+
+}
\ No newline at end of file
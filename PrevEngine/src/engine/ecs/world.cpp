@@ -0,0 +1,214 @@
+#include "pch.h"
+#include "world.h"
+
+#include "engine/jobs/jobsystem.h"
+
+namespace prev {
+
+	static PoolDesc GetChunkPoolDesc() {
+		PoolDesc desc;
+		desc.Tag = MemTag::Entity;
+		desc.BlocksPerSlab = 16;
+		desc.ThreadCaches = false;	// Chunks only come and go on the main thread
+		return desc;
+	}
+
+	World::World(JobSystem * jobSystem) :
+		m_JobSystem(jobSystem), m_ChunkPool(Archetype::ChunkSize, Archetype::CacheLineSize, GetChunkPoolDesc()),
+		m_WorkerBuffers(std::make_unique<EntityCommandBuffer[]>(JobSystem::MaxWorkers)) {
+		FindOrAddArchetype(0);
+	}
+
+	World::~World() {
+	}
+
+	Archetype * World::FindOrAddArchetype(ComponentMask mask) {
+		auto it = m_ArchetypeMasks.find(mask);
+		if (it != m_ArchetypeMasks.end())
+			return it->second;
+
+		m_Archetypes.push_back(std::make_unique<Archetype>(mask, m_ChunkPool));
+		Archetype * archetype = m_Archetypes.back().get();
+		m_ArchetypeMasks.emplace(mask, archetype);
+		return archetype;
+	}
+
+	const World::EntityRecord * World::GetRecord(Entity entity) const {
+		if (entity.Index >= m_Records.size())
+			return nullptr;
+		const EntityRecord & record = m_Records[entity.Index];
+		if (record.Owner == nullptr || record.Generation != entity.Generation)
+			return nullptr;
+		return &record;
+	}
+
+	bool World::CanChangeStructure(const char * operation) const {
+		if (!m_Locked)
+			return true;
+		PV_LOG_ERROR("World::%s while systems are running, use World::GetCommandBuffer instead", operation);
+		return false;
+	}
+
+	bool World::IsAlive(Entity entity) const {
+		return GetRecord(entity) != nullptr;
+	}
+
+	Archetype * World::GetTransition(Archetype * source, ComponentId id, bool add) {
+		Archetype * target = add ? source->GetAddEdge(id) : source->GetRemoveEdge(id);
+		if (target != nullptr)
+			return target;
+
+		target = FindOrAddArchetype(add ? source->GetMask() | (1ull << id) : source->GetMask() & ~(1ull << id));
+		if (add) {
+			source->SetAddEdge(id, target);
+			target->SetRemoveEdge(id, source);
+		} else {
+			source->SetRemoveEdge(id, target);
+			target->SetAddEdge(id, source);
+		}
+		return target;
+	}
+
+	Entity World::CreateEntity(ComponentMask mask) {
+		Entity entity;
+		AddRecord(mask, entity);
+		return entity;
+	}
+
+	World::EntityRecord * World::AddRecord(ComponentMask mask, Entity & entity) {
+		if (!CanChangeStructure("CreateEntity"))
+			return nullptr;
+
+		if (!m_FreeIndices.empty()) {
+			entity.Index = m_FreeIndices.back();
+			m_FreeIndices.pop_back();
+		} else {
+			entity.Index = (unsigned int)m_Records.size();
+			m_Records.emplace_back();
+		}
+
+		EntityRecord & record = m_Records[entity.Index];
+		entity.Generation = record.Generation;
+		// Entities tend to be created in runs of one kind
+		if (m_LastCreated == nullptr || m_LastCreated->GetMask() != mask)
+			m_LastCreated = FindOrAddArchetype(mask);
+		record.Owner = m_LastCreated;
+		record.Owner->Push(entity, record.Chunk, record.Row);
+		m_EntityCount++;
+		return &record;
+	}
+
+	void World::Destroy(Entity entity) {
+		if (!CanChangeStructure("Destroy") || !IsAlive(entity))
+			return;
+
+		EntityRecord & record = m_Records[entity.Index];
+		Erase(record.Owner, record.Chunk, record.Row);
+		record.Owner = nullptr;
+		record.Generation++;
+		m_FreeIndices.push_back(entity.Index);
+		m_EntityCount--;
+	}
+
+	void * World::AddComponent(Entity entity, ComponentId id) {
+		if (!CanChangeStructure("AddComponent") || !IsAlive(entity))
+			return nullptr;
+
+		EntityRecord & record = m_Records[entity.Index];
+		if (!record.Owner->Has(id))
+			Move(record, GetTransition(record.Owner, id, true));
+		return record.Owner->GetComponent(record.Chunk, record.Row, id);
+	}
+
+	void World::RemoveComponent(Entity entity, ComponentId id) {
+		if (!CanChangeStructure("RemoveComponent") || !IsAlive(entity))
+			return;
+
+		EntityRecord & record = m_Records[entity.Index];
+		if (record.Owner->Has(id))
+			Move(record, GetTransition(record.Owner, id, false));
+	}
+
+	void * World::GetComponent(Entity entity, ComponentId id) const {
+		const EntityRecord * record = GetRecord(entity);
+		if (record == nullptr || !record->Owner->Has(id))
+			return nullptr;
+		return record->Owner->GetComponent(record->Chunk, record->Row, id);
+	}
+
+	void World::Move(EntityRecord & record, Archetype * target) {
+		Archetype * source = record.Owner;
+		unsigned int chunk, row;
+		target->Push(source->GetChunk(record.Chunk)->GetEntities()[record.Row], chunk, row);
+		for (ComponentId id : source->GetComponents()) {
+			if (target->Has(id))
+				std::memcpy(target->GetComponent(chunk, row, id), source->GetComponent(record.Chunk, record.Row, id), ComponentRegistry::GetInfo(id).Size);
+		}
+
+		Erase(source, record.Chunk, record.Row);
+		record.Owner = target;
+		record.Chunk = chunk;
+		record.Row = row;
+	}
+
+	void World::Erase(Archetype * archetype, unsigned int chunk, unsigned int row) {
+		Entity moved = archetype->Erase(chunk, row);
+		if (moved.IsValid()) {
+			m_Records[moved.Index].Chunk = chunk;
+			m_Records[moved.Index].Row = row;
+		}
+	}
+
+	unsigned int World::GetChunkCount() const {
+		unsigned int count = 0;
+		for (const auto & archetype : m_Archetypes)
+			count += archetype->GetChunkCount();
+		return count;
+	}
+
+	EntityCommandBuffer & World::GetCommandBuffer() {
+		unsigned int workerIndex = m_JobSystem != nullptr ? m_JobSystem->GetWorkerIndex() : JobSystem::MaxWorkers;
+		if (workerIndex < JobSystem::MaxWorkers)
+			return m_WorkerBuffers[workerIndex];
+
+		std::thread::id id = std::this_thread::get_id();
+		std::lock_guard<std::mutex> lock(m_ThreadBuffersMutex);
+		for (auto & buffer : m_ThreadBuffers) {
+			if (buffer.first == id)
+				return *buffer.second;
+		}
+		m_ThreadBuffers.emplace_back(id, std::make_unique<EntityCommandBuffer>());
+		return *m_ThreadBuffers.back().second;
+	}
+
+	void World::PlayBack() {
+		PV_PROFILE_FUNCTION();
+
+		if (!CanChangeStructure("PlayBack"))
+			return;
+
+		auto gather = [this](EntityCommandBuffer & buffer) -> void {
+			for (const EntityCommandBuffer::Command & command : buffer.m_Commands)
+				m_PlayBackOrder.push_back({ command.Key, &buffer, command.Offset });
+		};
+		m_PlayBackOrder.clear();
+		for (unsigned int i = 0; i < JobSystem::MaxWorkers; i++)
+			gather(m_WorkerBuffers[i]);
+		for (auto & buffer : m_ThreadBuffers)
+			gather(*buffer.second);
+
+		// Stable, so a buffer's commands with the same key stay in recording order
+		auto byKey = [](const PlayBackCommand & a, const PlayBackCommand & b) -> bool { return a.Key < b.Key; };
+		if (!std::is_sorted(m_PlayBackOrder.begin(), m_PlayBackOrder.end(), byKey))
+			std::stable_sort(m_PlayBackOrder.begin(), m_PlayBackOrder.end(), byKey);
+		for (const PlayBackCommand & command : m_PlayBackOrder)
+			command.Buffer->Apply(*this, command.Offset);
+
+		for (unsigned int i = 0; i < JobSystem::MaxWorkers; i++)
+			m_WorkerBuffers[i].Reset();
+		for (auto & buffer : m_ThreadBuffers)
+			buffer.second->Reset();
+		EntityCommandBuffer::SetSortKey(0);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "archetype.h"
+#include "entitycommandbuffer.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace prev {
+
+	class JobSystem;
+
+	// Entities and their components, stored by archetype in 16 KB chunks
+	// Structural changes (create, destroy, add, remove) go straight through on the main thread when no systems are running,
+	// systems record them in a command buffer instead. Reading and writing components is fine from anywhere that declared it
+	class World {
+		friend class SystemScheduler;
+	public:
+		World(JobSystem * jobSystem = nullptr);
+		~World();
+
+		World(const World &) = delete;
+		World & operator=(const World &) = delete;
+
+		// Each component type once
+		template<typename... Ts>
+		Entity Create(const Ts &... components) {
+			static_assert(AreDistinctComponents<Ts...>::value, "Each component type once");
+			Entity entity;
+			if (EntityRecord * record = AddRecord(GetComponentMask<Ts...>(), entity)) {
+				Chunk * chunk = record->Owner->GetChunk(record->Chunk);
+				(std::memcpy(chunk->Get<Ts>() + record->Row, &components, sizeof(Ts)), ...);
+			}
+			return entity;
+		}
+
+		void Destroy(Entity entity);
+		bool IsAlive(Entity entity) const;
+
+		// Replaces the component when the entity already has it
+		template<typename T>
+		void Add(Entity entity, const T & component) {
+			if (void * data = AddComponent(entity, GetComponentId<T>()))
+				std::memcpy(data, &component, sizeof(T));
+		}
+
+		template<typename T>
+		void Remove(Entity entity) {
+			RemoveComponent(entity, GetComponentId<T>());
+		}
+
+		// nullptr when the entity is gone or doesn't have it, good until the next structural change
+		template<typename T>
+		T * Get(Entity entity) const {
+			return (T *)GetComponent(entity, GetComponentId<T>());
+		}
+
+		template<typename T>
+		bool Has(Entity entity) const {
+			return GetComponent(entity, GetComponentId<T>()) != nullptr;
+		}
+
+		// Untyped versions of the above, the typed ones go through these. Components added here are left uninitialized
+		Entity CreateEntity(ComponentMask mask);
+		void * AddComponent(Entity entity, ComponentId id);
+		void RemoveComponent(Entity entity, ComponentId id);
+		void * GetComponent(Entity entity, ComponentId id) const;
+
+		// Workers of the job system get their own buffer without a lock, other threads take one the first time they ask
+		EntityCommandBuffer & GetCommandBuffer();
+		// Applies every command buffer's commands sorted by their key (EntityCommandBuffer::SetSortKey): systems in the order
+		// they were added, chunks in query order, so the result doesn't depend on which thread ran what. Commands with the same key
+		// keep the order they were recorded in, unless different threads recorded them. Main thread, no systems running
+		void PlayBack();
+
+		// Archetypes are never removed, queries only look at the ones added since they last looked
+		inline unsigned int GetArchetypeCount() const { return (unsigned int)m_Archetypes.size(); }
+		inline Archetype & GetArchetype(unsigned int index) const { return *m_Archetypes[index]; }
+		inline unsigned int GetEntityCount() const { return m_EntityCount; }
+		unsigned int GetChunkCount() const;
+
+		inline void SetJobSystem(JobSystem * jobSystem) { m_JobSystem = jobSystem; }
+		inline JobSystem * GetJobSystem() const { return m_JobSystem; }
+		// True while a SystemScheduler is running systems on this world
+		inline bool IsLocked() const { return m_Locked; }
+	private:
+		struct EntityRecord {
+			Archetype * Owner = nullptr;	// nullptr while the index is free
+			unsigned int Chunk = 0;
+			unsigned int Row = 0;
+			unsigned int Generation = 0;
+		};
+
+		// nullptr when the structure can't change now
+		EntityRecord * AddRecord(ComponentMask mask, Entity & entity);
+		Archetype * FindOrAddArchetype(ComponentMask mask);
+		Archetype * GetTransition(Archetype * source, ComponentId id, bool add);
+		const EntityRecord * GetRecord(Entity entity) const;
+		// Moves the entity's components that both archetypes have, the rest of the new ones are left uninitialized
+		void Move(EntityRecord & record, Archetype * target);
+		void Erase(Archetype * archetype, unsigned int chunk, unsigned int row);
+		bool CanChangeStructure(const char * operation) const;
+	private:
+		JobSystem * m_JobSystem;
+		FixedPool m_ChunkPool;		// Before the archetypes, they give their chunks back to it
+
+		TaggedVector<std::unique_ptr<Archetype>, MemTag::Entity> m_Archetypes;
+		std::unordered_map<ComponentMask, Archetype *> m_ArchetypeMasks;
+		Archetype * m_LastCreated = nullptr;
+
+		TaggedVector<EntityRecord, MemTag::Entity> m_Records;
+		TaggedVector<unsigned int, MemTag::Entity> m_FreeIndices;
+		unsigned int m_EntityCount = 0;
+
+		std::unique_ptr<EntityCommandBuffer[]> m_WorkerBuffers;	// One per possible job system worker
+		std::mutex m_ThreadBuffersMutex;
+		std::vector<std::pair<std::thread::id, std::unique_ptr<EntityCommandBuffer>>> m_ThreadBuffers;
+
+		struct PlayBackCommand {
+			unsigned long long Key;
+			EntityCommandBuffer * Buffer;
+			size_t Offset;
+		};
+		TaggedVector<PlayBackCommand, MemTag::Entity> m_PlayBackOrder;	// Kept to reuse its memory
+
+		bool m_Locked = false;
+	};
+
+}
\ No newline at end of file
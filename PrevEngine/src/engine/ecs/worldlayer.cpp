@@ -0,0 +1,21 @@
+#include "pch.h"
+#include "worldlayer.h"
+
+namespace prev {
+
+	WorldLayer::WorldLayer(const std::string & name) :
+		Layer(name) {
+	}
+
+	WorldLayer::~WorldLayer() {
+	}
+
+	void WorldLayer::OnAttach() {
+		m_World.SetJobSystem(&GetJobSystem());
+	}
+
+	void WorldLayer::OnUpdate() {
+		m_Systems.Run(m_World, Timer::GetDeltaTime());
+	}
+
+}
\ No newline at end of file
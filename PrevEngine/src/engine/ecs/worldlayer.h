@@ -0,0 +1,33 @@
+#pragma once
+
+#include "system.h"
+#include "engine/layer/layer.h"
+
+namespace prev {
+
+	// A World and the systems that run on it, driven from the layer stack's OnUpdate
+	// Push one per simulation instead of keeping game state in layer subclasses. It declares no resources,
+	// so it runs alone in the stack and its systems get every worker
+	class WorldLayer : public Layer {
+		PV_LAYER_HOOKS(WorldLayer)
+	public:
+		WorldLayer(const std::string & name = "World");
+		virtual ~WorldLayer();
+
+		// Systems run in the order they are added, unless what they declare lets them run side by side
+		template<typename T, typename... Args>
+		T * AddSystem(Args &&... args) {
+			return m_Systems.Add<T>(std::forward<Args>(args)...);
+		}
+
+		inline World & GetWorld() { return m_World; }
+		inline SystemScheduler & GetSystems() { return m_Systems; }
+	private:
+		virtual void OnAttach() override;
+		virtual void OnUpdate() override;
+	private:
+		World m_World;
+		SystemScheduler m_Systems;
+	};
+
+}
\ No newline at end of file
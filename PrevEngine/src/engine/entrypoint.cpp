@@ -6,7 +6,11 @@ using namespace prev;
 
 extern prev::Application * CreateApplication();
 
+#ifdef PV_PLATFORM_WINDOWS
 int CALLBACK WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nShowCmd) {
+#else
+int main(int argc, char ** argv) {
+#endif
 	prev::Application * app = CreateApplication();
 
 	if (!app->IsAppReady) {
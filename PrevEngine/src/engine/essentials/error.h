@@ -16,7 +16,8 @@ namespace prev {
 		PV_FATAL
 	};
 
-	static void GiveError(std::string message, ErrorLevel errorlevel) {
+#ifdef PV_PLATFORM_WINDOWS
+	inline void GiveError(std::string message, ErrorLevel errorlevel) {
 
 		std::string caption;
 		UINT flags = 0;
@@ -46,5 +47,31 @@ namespace prev {
 
 		MessageBoxA(nullptr, message.c_str(), caption.c_str(), flags);
 	}
+#else
+	// No message boxes on headless machines, errors go to stderr
+	inline void GiveError(std::string message, ErrorLevel errorlevel) {
+
+		const char * caption = "";
+
+		switch (errorlevel) {
+		case prev::ErrorLevel::PV_INFO:
+			caption = "INFO";
+			break;
+		case prev::ErrorLevel::PV_WARN:
+			caption = "WARNING";
+			break;
+		case prev::ErrorLevel::PV_ERROR:
+			caption = "ERROR";
+			break;
+		case prev::ErrorLevel::PV_FATAL:
+			caption = "FATAL";
+			break;
+		default:
+			break;
+		}
+
+		std::fprintf(stderr, "[%s] %s\n", caption, message.c_str());
+	}
+#endif
 
 }
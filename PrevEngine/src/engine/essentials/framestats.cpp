@@ -0,0 +1,178 @@
+#include "pch.h"
+#include "framestats.h"
+
+namespace prev {
+
+	static unsigned int HighestBit(unsigned int value) {
+		unsigned int bit = 0;
+		while (value >>= 1)
+			bit++;
+		return bit;
+	}
+
+	unsigned int FrameTimeHistogram::GetBucketIndex(unsigned int microseconds) {
+		if (microseconds > MaxValue)
+			microseconds = MaxValue;
+		if (microseconds < SubBucketCount)
+			return microseconds;
+		unsigned int shift = HighestBit(microseconds) - (SubBucketBits - 1);
+		unsigned int subBucket = microseconds >> shift;
+		return SubBucketCount + (shift - 1) * SubBucketHalfCount + (subBucket - SubBucketHalfCount);
+	}
+
+	unsigned int FrameTimeHistogram::GetBucketValue(unsigned int bucketIndex) {
+		if (bucketIndex < SubBucketCount)
+			return bucketIndex;
+		bucketIndex -= SubBucketCount;
+		unsigned int shift = bucketIndex / SubBucketHalfCount + 1;
+		unsigned int subBucket = bucketIndex % SubBucketHalfCount + SubBucketHalfCount;
+		return ((subBucket + 1) << shift) - 1;
+	}
+
+	void FrameTimeHistogram::Add(unsigned int microseconds) {
+		m_Buckets[GetBucketIndex(microseconds)]++;
+		m_Count++;
+	}
+
+	void FrameTimeHistogram::Remove(unsigned int microseconds) {
+		m_Buckets[GetBucketIndex(microseconds)]--;
+		m_Count--;
+	}
+
+	void FrameTimeHistogram::Clear() {
+		m_Buckets.fill(0);
+		m_Count = 0;
+	}
+
+	unsigned int FrameTimeHistogram::GetPercentile(double percentile) const {
+		if (m_Count == 0)
+			return 0;
+		double target = std::ceil(percentile / 100.0 * m_Count);
+		unsigned int wanted = target < 1.0 ? 1 : (target > m_Count ? m_Count : (unsigned int)target);
+		unsigned int seen = 0;
+		for (unsigned int i = 0; i < BucketCount; i++) {
+			seen += m_Buckets[i];
+			if (seen >= wanted)
+				return GetBucketValue(i);
+		}
+		return MaxValue;
+	}
+
+	unsigned int FrameTimeHistogram::CountAbove(unsigned int microseconds) const {
+		unsigned int count = 0;
+		for (unsigned int i = GetBucketIndex(microseconds) + 1; i < BucketCount; i++)
+			count += m_Buckets[i];
+		return count;
+	}
+
+	// Frame times in us, indexed by frame number
+	static std::array<unsigned int, FrameStats::MaxFrames> s_Frames;
+	static unsigned long long s_FrameCount = 0;
+
+	static std::array<unsigned int, FrameStats::MaxWindows> s_Windows = { 60, 600, 6000, FrameStats::MaxFrames };
+	static std::array<FrameTimeHistogram, FrameStats::MaxWindows> s_Histograms;
+	static std::array<unsigned long long, FrameStats::MaxWindows> s_Sums = {};
+
+	static std::array<float, FrameStats::HistorySize> s_History = {};
+	static float s_HitchThreshold = 0.0f;
+
+	void FrameStats::Record(unsigned long long frameTicks) {
+		unsigned long long microseconds = frameTicks / 1000;
+		unsigned int value = microseconds > FrameTimeHistogram::MaxValue ? FrameTimeHistogram::MaxValue : (unsigned int)microseconds;
+
+		// Drop the frame leaving each window before the slot gets overwritten, the biggest window shares it
+		for (unsigned int i = 0; i < MaxWindows; i++) {
+			if (s_FrameCount >= s_Windows[i]) {
+				unsigned int old = s_Frames[(s_FrameCount - s_Windows[i]) & (MaxFrames - 1)];
+				s_Histograms[i].Remove(old);
+				s_Sums[i] -= old;
+			}
+			s_Histograms[i].Add(value);
+			s_Sums[i] += value;
+		}
+
+		s_Frames[s_FrameCount & (MaxFrames - 1)] = value;
+		s_History[s_FrameCount % HistorySize] = (float)value / 1000.0f;
+		s_FrameCount++;
+	}
+
+	void FrameStats::Reset() {
+		s_FrameCount = 0;
+		for (unsigned int i = 0; i < MaxWindows; i++) {
+			s_Histograms[i].Clear();
+			s_Sums[i] = 0;
+		}
+		s_History.fill(0.0f);
+	}
+
+	void FrameStats::SetWindow(unsigned int windowIndex, unsigned int frames) {
+		if (windowIndex >= MaxWindows)
+			return;
+		frames = std::min(std::max(frames, 1u), (unsigned int)MaxFrames);
+		s_Windows[windowIndex] = frames;
+
+		FrameTimeHistogram & histogram = s_Histograms[windowIndex];
+		histogram.Clear();
+		s_Sums[windowIndex] = 0;
+		unsigned long long count = std::min<unsigned long long>(s_FrameCount, frames);
+		for (unsigned long long frame = s_FrameCount - count; frame < s_FrameCount; frame++) {
+			unsigned int value = s_Frames[frame & (MaxFrames - 1)];
+			histogram.Add(value);
+			s_Sums[windowIndex] += value;
+		}
+	}
+
+	unsigned int FrameStats::GetWindow(unsigned int windowIndex) {
+		return windowIndex < MaxWindows ? s_Windows[windowIndex] : 0;
+	}
+
+	void FrameStats::SetHitchThreshold(float milliseconds) {
+		s_HitchThreshold = milliseconds > 0.0f ? milliseconds : 0.0f;
+	}
+
+	float FrameStats::GetHitchThreshold() {
+		return s_HitchThreshold;
+	}
+
+	FrameTimeStats FrameStats::GetStats(unsigned int windowIndex) {
+		FrameTimeStats stats;
+		if (windowIndex >= MaxWindows)
+			return stats;
+
+		const FrameTimeHistogram & histogram = s_Histograms[windowIndex];
+		stats.WindowFrames = s_Windows[windowIndex];
+		stats.Frames = histogram.GetCount();
+		if (stats.Frames == 0)
+			return stats;
+
+		stats.MeanMs = (float)((double)s_Sums[windowIndex] / stats.Frames / 1000.0);
+
+		// Exact max, the histogram only knows the bucket. Percentiles are the top of their bucket so clamp them to it
+		unsigned int maxValue = 0;
+		for (unsigned long long frame = s_FrameCount - stats.Frames; frame < s_FrameCount; frame++)
+			maxValue = std::max(maxValue, s_Frames[frame & (MaxFrames - 1)]);
+		stats.MaxMs = (float)maxValue / 1000.0f;
+
+		stats.P50Ms = (float)std::min(histogram.GetPercentile(50.0), maxValue) / 1000.0f;
+		stats.P95Ms = (float)std::min(histogram.GetPercentile(95.0), maxValue) / 1000.0f;
+		stats.P99Ms = (float)std::min(histogram.GetPercentile(99.0), maxValue) / 1000.0f;
+		stats.P999Ms = (float)std::min(histogram.GetPercentile(99.9), maxValue) / 1000.0f;
+
+		stats.HitchThresholdMs = s_HitchThreshold > 0.0f ? s_HitchThreshold : stats.P50Ms * 2.0f;
+		stats.Hitches = histogram.CountAbove((unsigned int)(stats.HitchThresholdMs * 1000.0f));
+		return stats;
+	}
+
+	unsigned long long FrameStats::GetFrameCount() {
+		return s_FrameCount;
+	}
+
+	const float * FrameStats::GetHistory() {
+		return s_History.data();
+	}
+
+	unsigned int FrameStats::GetHistoryOffset() {
+		return (unsigned int)(s_FrameCount % HistorySize);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+
+namespace prev {
+
+	// Log-linear histogram of frame times in microseconds (HdrHistogram layout)
+	// Values under SubBucketCount are exact, above that every power of 2 is split in SubBucketCount / 2 steps, so the error stays under 1%
+	class FrameTimeHistogram {
+	public:
+		static const unsigned int SubBucketBits = 7;
+		static const unsigned int SubBucketCount = 1u << SubBucketBits;
+		static const unsigned int SubBucketHalfCount = SubBucketCount / 2;
+		static const unsigned int MaxShift = 20;	// Up to 2^27 us, about two minutes
+		static const unsigned int BucketCount = SubBucketCount + MaxShift * SubBucketHalfCount;
+		static const unsigned int MaxValue = (1u << (SubBucketBits + MaxShift)) - 1;
+	public:
+		void Add(unsigned int microseconds);
+		void Remove(unsigned int microseconds);
+		void Clear();
+
+		// Smallest value that at least percentile % of the samples are less than or equal to, p in [0, 100]
+		unsigned int GetPercentile(double percentile) const;
+		unsigned int CountAbove(unsigned int microseconds) const;
+		inline unsigned int GetCount() const { return m_Count; }
+
+		static unsigned int GetBucketIndex(unsigned int microseconds);
+		// Highest value that lands in the same bucket
+		static unsigned int GetBucketValue(unsigned int bucketIndex);
+	private:
+		std::array<unsigned int, BucketCount> m_Buckets{};
+		unsigned int m_Count = 0;
+	};
+
+	struct FrameTimeStats {
+		unsigned int WindowFrames = 0;	// Size of the window
+		unsigned int Frames = 0;		// Frames in the window so far
+		float MeanMs = 0.0f;
+		float P50Ms = 0.0f;
+		float P95Ms = 0.0f;
+		float P99Ms = 0.0f;
+		float P999Ms = 0.0f;
+		float MaxMs = 0.0f;
+		float HitchThresholdMs = 0.0f;
+		unsigned int Hitches = 0;
+	};
+
+	// Rolling frame times over a few windows of the last N frames, fed by Timer::Update with the real clock
+	// Everything is preallocated, recording a frame doesn't allocate. Main thread only
+	class FrameStats {
+	public:
+		static const unsigned int MaxFrames = 16384;	// Power of 2, the biggest window
+		static const unsigned int MaxWindows = 4;
+		static const unsigned int HistorySize = 256;	// Frames kept as floats for graphs
+	public:
+		static void Record(unsigned long long frameTicks);
+		static void Reset();
+
+		// Windows are frame counts, clamped to MaxFrames. Rebuilt from the recorded frames
+		static void SetWindow(unsigned int windowIndex, unsigned int frames);
+		static unsigned int GetWindow(unsigned int windowIndex);
+		static inline unsigned int GetWindowCount() { return MaxWindows; }
+
+		// Frames longer than this count as hitches, 0 means twice the median of the window
+		static void SetHitchThreshold(float milliseconds);
+		static float GetHitchThreshold();
+
+		static FrameTimeStats GetStats(unsigned int windowIndex);
+		static unsigned long long GetFrameCount();
+
+		// Last HistorySize frame times in ms, oldest first starting at GetHistoryOffset (ImGui::PlotLines layout)
+		static const float * GetHistory();
+		static unsigned int GetHistoryOffset();
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "pch.h"
+#include "log.h"
+
+namespace prev {
+
+	// Bounded multi producer, single consumer queue (Vyukov style, one sequence number per slot)
+	// Producers claim a slot with a single CAS and never wait, when the queue is full the message is dropped
+	struct LogQueue {
+		static const unsigned int Capacity = 1024; // Power of 2
+
+		LogQueue() {
+			for (unsigned int i = 0; i < Capacity; i++)
+				Records[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+
+		std::array<LogRecord, Capacity> Records;
+		alignas(64) std::atomic<unsigned int> Tail{ 0 };
+		alignas(64) unsigned int Head = 0;
+		std::atomic<unsigned int> Dropped{ 0 };
+	};
+
+	struct LogSink {
+		unsigned int Id;
+		std::function<void(std::string_view, LogLevel)> Function;
+	};
+
+	std::function<void(std::string_view, LogLevel)> Log::m_LogFunction;
+	static std::vector<LogSink> s_Sinks;
+	static unsigned int s_NextSinkId = 1;
+
+	static const char s_TruncationSuffix[] = "...";
+
+	static LogQueue & GetQueue() {
+		static LogQueue queue;
+		return queue;
+	}
+
+	LogRecord * Log::BeginRecord() {
+		LogQueue & queue = GetQueue();
+		unsigned int position = queue.Tail.load(std::memory_order_relaxed);
+		while (true) {
+			LogRecord & record = queue.Records[position & (LogQueue::Capacity - 1)];
+			unsigned int sequence = record.Sequence.load(std::memory_order_acquire);
+			int diff = (int)(sequence - position);
+			if (diff == 0) {
+				if (queue.Tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					record.Position = position;
+					record.Format = nullptr;
+					record.ArgCount = 0;
+					record.PayloadUsed = 0;
+					return &record;
+				}
+			} else if (diff < 0) {
+				queue.Dropped.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			} else {
+				position = queue.Tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void Log::CommitRecord(LogRecord * record) {
+		record->Sequence.store(record->Position + 1, std::memory_order_release);
+	}
+
+	void Log::PackString(LogRecord & record, const char * str, size_t length) {
+		// Long strings are cut and end with "...", the record never grows
+		// With no room left at all the argument is still added so the ones after it keep their place in the format
+		LogArg & arg = record.Args[record.ArgCount++];
+		size_t available = LogRecord::PayloadSize - record.PayloadUsed;
+		if (available < sizeof(s_TruncationSuffix) + 1) {
+			arg.ArgType = LogArg::Type::Truncated;
+			return;
+		}
+
+		arg.ArgType = LogArg::Type::String;
+		arg.StringOffset = record.PayloadUsed;
+		char * payload = record.Payload + record.PayloadUsed;
+		if (length > available - 1) {
+			length = available - sizeof(s_TruncationSuffix);
+			std::memcpy(payload, str, length);
+			std::memcpy(payload + length, s_TruncationSuffix, sizeof(s_TruncationSuffix) - 1);
+			length += sizeof(s_TruncationSuffix) - 1;
+		} else {
+			std::memcpy(payload, str, length);
+		}
+		payload[length] = '\0';
+		record.PayloadUsed += (unsigned int)length + 1;
+	}
+
+	void Log::ImGuiLog(std::string_view message, LogLevel errorLevel) {
+		LogRecord * record = BeginRecord();
+		if (record == nullptr)
+			return;
+		record->Level = errorLevel;
+		PackString(*record, message.data(), message.size());
+		CommitRecord(record);
+	}
+
+	// Flags, width and precision of one conversion, without its length modifiers (we add our own) and the conversion itself
+	// A * takes its value from the next argument like printf does. False when that argument isn't an integer
+	static bool ExpandSpec(char * spec, size_t & length, const char * specBegin, const char * specEnd, const LogRecord & record, unsigned int & argIndex) {
+		length = 0;
+		for (const char * c = specBegin; c < specEnd - 1 && length < 16; c++) {
+			if (*c != '*') {
+				if (std::strchr("hljztL", *c) == nullptr)
+					spec[length++] = *c;
+				continue;
+			}
+
+			if (argIndex >= record.ArgCount)
+				return false;
+			const LogArg & arg = record.Args[argIndex++];
+			if (arg.ArgType != LogArg::Type::Int && arg.ArgType != LogArg::Type::UInt)
+				return false;
+			long long value = arg.ArgType == LogArg::Type::Int ? arg.Int : (long long)std::min(arg.UInt, 0x7fffffffull);
+			bool precision = length > 0 && spec[length - 1] == '.';
+			// A negative precision counts as none, a negative width left justifies
+			if (precision && value < 0) {
+				length--;
+				continue;
+			}
+			value = std::max(std::min(value, 4096ll), -4096ll);
+			length += (size_t)std::snprintf(spec + length, 8, "%lld", value);
+		}
+		return true;
+	}
+
+	// Formats one printf style conversion with the argument type that was actually captured
+	// so a mismatched format can't read garbage
+	static int FormatArg(char * out, size_t size, char * spec, size_t length, char conversion, const LogRecord & record, const LogArg & arg) {
+		switch (arg.ArgType) {
+		case LogArg::Type::Int:
+		case LogArg::Type::UInt:
+			if (conversion == 'c') {
+				spec[length++] = 'c';
+				spec[length] = '\0';
+				return std::snprintf(out, size, spec, (int)arg.Int);
+			}
+			if (std::strchr("diouxX", conversion) == nullptr)
+				conversion = arg.ArgType == LogArg::Type::Int ? 'd' : 'u';
+			spec[length++] = 'l';
+			spec[length++] = 'l';
+			spec[length++] = conversion;
+			spec[length] = '\0';
+			if (arg.ArgType == LogArg::Type::Int)
+				return std::snprintf(out, size, spec, arg.Int);
+			return std::snprintf(out, size, spec, arg.UInt);
+		case LogArg::Type::Double:
+			if (std::strchr("fFeEgGaA", conversion) == nullptr)
+				conversion = 'f';
+			spec[length++] = conversion;
+			spec[length] = '\0';
+			return std::snprintf(out, size, spec, arg.Double);
+		case LogArg::Type::String:
+			spec[length++] = 's';
+			spec[length] = '\0';
+			return std::snprintf(out, size, spec, record.Payload + arg.StringOffset);
+		case LogArg::Type::Pointer:
+			return std::snprintf(out, size, "%p", arg.Pointer);
+		case LogArg::Type::Truncated:
+			return std::snprintf(out, size, "<truncated>");
+		default:
+			return 0;
+		}
+	}
+
+	static size_t FormatRecord(char * out, size_t size, const LogRecord & record) {
+		size_t written = 0;
+		if (record.Format == nullptr) {
+			if (record.ArgCount == 0)
+				return 0;
+			int n = std::snprintf(out, size, "%s", record.Payload + record.Args[0].StringOffset);
+			written = n > 0 ? (size_t)n : 0;
+		} else {
+			unsigned int argIndex = 0;
+			const char * c = record.Format;
+			while (*c && written < size - 1) {
+				if (*c != '%') {
+					out[written++] = *c++;
+					continue;
+				}
+				if (*(c + 1) == '%') {
+					out[written++] = '%';
+					c += 2;
+					continue;
+				}
+
+				const char * specBegin = c;
+				c++;
+				while (*c && std::strchr("diouxXcsfFeEgGaAp", *c) == nullptr)
+					c++;
+				if (*c == '\0')
+					break;
+				c++;
+
+				char spec[32];
+				size_t length;
+				int n;
+				if (!ExpandSpec(spec, length, specBegin, c, record, argIndex) || argIndex >= record.ArgCount)
+					n = std::snprintf(out + written, size - written, "<missing>");
+				else
+					n = FormatArg(out + written, size - written, spec, length, *(c - 1), record, record.Args[argIndex++]);
+				written += n > 0 ? (size_t)n : 0;
+			}
+			if (*c != '\0')
+				written = size;
+		}
+
+		// Didn't fit, end with the same marker cut strings get
+		if (written > size - 1) {
+			written = size - 1;
+			std::memcpy(out + written - (sizeof(s_TruncationSuffix) - 1), s_TruncationSuffix, sizeof(s_TruncationSuffix) - 1);
+		}
+		out[written] = '\0';
+		return written;
+	}
+
+	void Log::Dispatch(std::string_view message, LogLevel level) {
+		if (m_LogFunction)
+			m_LogFunction(message, level);
+		for (auto & sink : s_Sinks)
+			sink.Function(message, level);
+	}
+
+	void Log::Drain() {
+		LogQueue & queue = GetQueue();
+		char buffer[1024];
+
+		while (true) {
+			LogRecord & record = queue.Records[queue.Head & (LogQueue::Capacity - 1)];
+			unsigned int sequence = record.Sequence.load(std::memory_order_acquire);
+			if (sequence != queue.Head + 1)
+				break;
+
+			size_t length = FormatRecord(buffer, sizeof(buffer), record);
+			LogLevel level = record.Level;
+
+			// Give the slot back before calling out, sinks are allowed to log
+			record.Sequence.store(queue.Head + LogQueue::Capacity, std::memory_order_release);
+			queue.Head++;
+
+			Dispatch(std::string_view(buffer, length), level);
+		}
+
+		unsigned int dropped = queue.Dropped.exchange(0, std::memory_order_relaxed);
+		if (dropped > 0) {
+			int length = std::snprintf(buffer, sizeof(buffer), "%u log messages were dropped, the log queue was full", dropped);
+			Dispatch(std::string_view(buffer, length), LogLevel::PV_WARN);
+		}
+	}
+
+	unsigned int Log::AddSink(std::function<void(std::string_view, LogLevel)> sink) {
+		s_Sinks.push_back({ s_NextSinkId, sink });
+		return s_NextSinkId++;
+	}
+
+	void Log::RemoveSink(unsigned int sinkId) {
+		for (unsigned int i = 0; i < s_Sinks.size(); i++) {
+			if (s_Sinks[i].Id == sinkId) {
+				s_Sinks.erase(s_Sinks.begin() + i);
+				return;
+			}
+		}
+	}
+
+}
\ No newline at end of file
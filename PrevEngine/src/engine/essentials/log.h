@@ -2,6 +2,9 @@
 
 #include <functional>
 #include <string>
+#include <string_view>
+#include <atomic>
+#include <type_traits>
 
 namespace prev {
 
@@ -12,18 +15,126 @@ namespace prev {
 		PV_FATAL
 	};
 
+	// One argument of a deferred log message, strings are copied into the record payload
+	struct LogArg {
+		enum class Type : unsigned char {
+			Int, UInt, Double, String, Pointer,
+			Truncated	// A string that didn't fit in the payload at all, formatted as <truncated>
+		};
+
+		Type ArgType;
+		union {
+			long long Int;
+			unsigned long long UInt;
+			double Double;
+			unsigned int StringOffset;
+			const void * Pointer;
+		};
+	};
+
+	// Fixed size slot in the log queue, nothing in here owns heap memory
+	// Strings that don't fit in the payload are cut and end with "..."
+	struct LogRecord {
+		static const unsigned int MaxArgs = 8;
+		static const unsigned int PayloadSize = 176;
+
+		std::atomic<unsigned int> Sequence;
+		unsigned int Position;
+		LogLevel Level;
+		const char * Format;		// printf style, must be a string literal. nullptr means Payload is the message
+		unsigned int ArgCount;
+		unsigned int PayloadUsed;
+		LogArg Args[MaxArgs];
+		char Payload[PayloadSize];
+	};
+
 	struct Log {
 		friend class ImGuiLogger;
-		static void ImGuiLog(std::string message, LogLevel errorLevel) {
-			if (m_LogFunction) {
-				m_LogFunction(message, errorLevel);
+	public:
+		// Copies the message, safe to call from any thread
+		static void ImGuiLog(std::string_view message, LogLevel errorLevel);
+
+		// Stores format and arguments, formatting happens when the queue is drained. Safe to call from any thread
+		template<typename... Args>
+		static void Write(LogLevel level, const char * format, const Args &... args) {
+			static_assert(sizeof...(Args) <= LogRecord::MaxArgs, "Too many log arguments");
+			LogRecord * record = BeginRecord();
+			if (record == nullptr)
+				return;
+			record->Level = level;
+			record->Format = format;
+			(PackArg(*record, args), ...);
+			CommitRecord(record);
+		}
+
+		// Formats everything queued so far and hands it to the ImGui logger and the sinks
+		// There must only ever be one thread draining, the engine does it once per frame on the main thread
+		static void Drain();
+
+		// Sinks are called from the draining thread, add and remove them from that thread too
+		// For files and stdout use LogFileSink, it does the writing on its own thread
+		static unsigned int AddSink(std::function<void(std::string_view, LogLevel)> sink);
+		static void RemoveSink(unsigned int sinkId);
+	private:
+		static LogRecord * BeginRecord();
+		static void CommitRecord(LogRecord * record);
+		static void PackString(LogRecord & record, const char * str, size_t length);
+		static void Dispatch(std::string_view message, LogLevel level);
+
+		template<typename T>
+		static void PackArg(LogRecord & record, const T & value) {
+			if (record.ArgCount >= LogRecord::MaxArgs)
+				return;
+			LogArg & arg = record.Args[record.ArgCount];
+			if constexpr (std::is_same_v<T, bool>) {
+				arg.ArgType = LogArg::Type::Int;
+				arg.Int = value ? 1 : 0;
+			} else if constexpr (std::is_enum_v<T>) {
+				arg.ArgType = LogArg::Type::Int;
+				arg.Int = (long long)value;
+			} else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+				arg.ArgType = LogArg::Type::Int;
+				arg.Int = value;
+			} else if constexpr (std::is_integral_v<T>) {
+				arg.ArgType = LogArg::Type::UInt;
+				arg.UInt = value;
+			} else if constexpr (std::is_floating_point_v<T>) {
+				arg.ArgType = LogArg::Type::Double;
+				arg.Double = value;
+			} else if constexpr (std::is_convertible_v<T, std::string_view>) {
+				if constexpr (std::is_pointer_v<T>) {
+					if (value == nullptr) {
+						PackString(record, "(null)", 6);
+						return;
+					}
+				}
+				std::string_view str(value);
+				PackString(record, str.data(), str.size());
+				return;
+			} else if constexpr (std::is_pointer_v<T>) {
+				arg.ArgType = LogArg::Type::Pointer;
+				arg.Pointer = (const void *)value;
+			} else {
+				static_assert(std::is_pointer_v<T>, "Unsupported log argument type");
 			}
+			record.ArgCount++;
 		}
 	private:
-		static std::function<void(std::string, LogLevel)> m_LogFunction;
+		static std::function<void(std::string_view, LogLevel)> m_LogFunction;
 	};
 
 }
 
-#define PV_DEBUG_LOG(string) OutputDebugStringA(string); OutputDebugStringA("\n")
-#define PV_IMGUI_LOG(string, errorLevel) prev::Log::ImGuiLog(string, errorLevel)
\ No newline at end of file
+#ifdef PV_PLATFORM_WINDOWS
+	#define PV_DEBUG_LOG(string) OutputDebugStringA(string); OutputDebugStringA("\n")
+#else
+	#define PV_DEBUG_LOG(string) std::fputs(string, stderr); std::fputs("\n", stderr)
+#endif
+#define PV_IMGUI_LOG(string, errorLevel) prev::Log::ImGuiLog(string, errorLevel)
+
+// printf style, formatted later on the draining thread
+#define PV_LOG(errorLevel, ...)	prev::Log::Write(errorLevel, __VA_ARGS__)
+#define PV_LOG_INFO(...)		PV_LOG(prev::LogLevel::PV_INFO, __VA_ARGS__)
+#define PV_LOG_WARN(...)		PV_LOG(prev::LogLevel::PV_WARN, __VA_ARGS__)
+#define PV_LOG_ERROR(...)		PV_LOG(prev::LogLevel::PV_ERROR, __VA_ARGS__)
+#define PV_LOG_FATAL(...)		PV_LOG(prev::LogLevel::PV_FATAL, __VA_ARGS__)
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "pch.h"
+#include "logfilesink.h"
+#include "logformat.h"
+
+namespace prev {
+
+	// Batches bigger than this wake the writer before the flush interval
+	static const size_t s_WakeThreshold = 64 * 1024;
+
+	LogFileSink::LogFileSink(const LogFileSinkDesc & desc) :
+		m_Desc(desc) {
+
+		if (!m_Desc.FilePath.empty() && !OpenFile()) {
+			PV_LOG_ERROR("Unable to open log file %s", m_Desc.FilePath);
+			return;
+		}
+
+		m_Pending.reserve(s_WakeThreshold * 2);
+		m_Writing.reserve(s_WakeThreshold * 2);
+		m_Thread = std::thread(&LogFileSink::WriterThread, this);
+		m_SinkId = Log::AddSink([this](std::string_view message, LogLevel level) -> void {
+			Push(message, level);
+		});
+		m_Status = true;
+	}
+
+	LogFileSink::~LogFileSink() {
+		if (m_SinkId != 0)
+			Log::RemoveSink(m_SinkId);
+
+		if (m_Thread.joinable()) {
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Stop = true;
+			}
+			m_WakeWriter.notify_one();
+			m_Thread.join();
+		}
+
+		if (m_File != nullptr)
+			std::fclose(m_File);
+	}
+
+	void LogFileSink::Flush() {
+		if (!m_Status)
+			return;
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_FlushRequested = true;
+		m_WakeWriter.notify_one();
+		m_Written.wait(lock, [this]() { return m_Pending.empty() && !m_IsWriting; });
+	}
+
+	void LogFileSink::Push(std::string_view message, LogLevel level) {
+		// Only a memcpy on the calling thread, formatting to text happens on the writer
+		LogBinaryRecordHeader header = {};
+		header.Timestamp = (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		header.Length = (std::uint32_t)message.size();
+		header.Level = (std::uint8_t)level;
+
+		bool wake;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			size_t offset = m_Pending.size();
+			m_Pending.resize(offset + sizeof(header) + message.size());
+			std::memcpy(m_Pending.data() + offset, &header, sizeof(header));
+			std::memcpy(m_Pending.data() + offset + sizeof(header), message.data(), message.size());
+			wake = m_Pending.size() >= s_WakeThreshold;
+		}
+		if (wake)
+			m_WakeWriter.notify_one();
+	}
+
+	void LogFileSink::WriterThread() {
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while (true) {
+			m_WakeWriter.wait_for(lock, std::chrono::milliseconds(m_Desc.FlushIntervalMs), [this]() {
+				return m_Stop || m_FlushRequested || m_Pending.size() >= s_WakeThreshold;
+			});
+			m_FlushRequested = false;
+
+			if (m_Pending.empty()) {
+				m_Written.notify_all();
+				if (m_Stop)
+					return;
+				continue;
+			}
+
+			m_Pending.swap(m_Writing);
+			m_IsWriting = true;
+			lock.unlock();
+
+			WriteBatch(m_Writing);
+			m_Writing.clear();
+
+			lock.lock();
+			m_IsWriting = false;
+			m_Written.notify_all();
+		}
+	}
+
+	void LogFileSink::WriteBatch(const TaggedVector<char, MemTag::Log> & batch) {
+		const char * text = nullptr;
+		size_t textSize = 0;
+
+		if (!m_Desc.Binary || m_Desc.Stdout) {
+			// Turn the whole batch into text once, then write it with a single call per target
+			m_TextBuffer.clear();
+			size_t offset = 0;
+			while (offset + sizeof(LogBinaryRecordHeader) <= batch.size()) {
+				LogBinaryRecordHeader header;
+				std::memcpy(&header, batch.data() + offset, sizeof(header));
+				offset += sizeof(header);
+
+				std::time_t seconds = (std::time_t)(header.Timestamp / 1000000000ull);
+				unsigned int millis = (unsigned int)(header.Timestamp / 1000000ull % 1000ull);
+				std::tm time = {};
+			#ifdef PV_PLATFORM_WINDOWS
+				localtime_s(&time, &seconds);
+			#else
+				localtime_r(&seconds, &time);
+			#endif
+				char prefix[64];
+				int prefixLength = std::snprintf(prefix, sizeof(prefix), "[%02d:%02d:%02d.%03u] [%s] ",
+												 time.tm_hour, time.tm_min, time.tm_sec, millis, LogLevelNames[header.Level & 3]);
+				m_TextBuffer.insert(m_TextBuffer.end(), prefix, prefix + prefixLength);
+				m_TextBuffer.insert(m_TextBuffer.end(), batch.data() + offset, batch.data() + offset + header.Length);
+				m_TextBuffer.push_back('\n');
+				offset += header.Length;
+			}
+			text = m_TextBuffer.data();
+			textSize = m_TextBuffer.size();
+		}
+
+		if (m_Desc.Stdout) {
+			std::fwrite(text, 1, textSize, stdout);
+			std::fflush(stdout);
+		}
+
+		if (m_File == nullptr)
+			return;
+
+		const char * data = m_Desc.Binary ? batch.data() : text;
+		size_t size = m_Desc.Binary ? batch.size() : textSize;
+		if (m_Desc.MaxFileSize > 0 && m_FileSize > 0 && m_FileSize + size > m_Desc.MaxFileSize)
+			Rotate();
+		if (m_File == nullptr)
+			return;
+
+		m_FileSize += std::fwrite(data, 1, size, m_File);
+		std::fflush(m_File);
+	}
+
+	bool LogFileSink::OpenFile() {
+		m_File = std::fopen(m_Desc.FilePath.c_str(), "wb");
+		if (m_File == nullptr)
+			return false;
+		// Batches are already big, stdio buffering would only add a copy
+		std::setvbuf(m_File, nullptr, _IONBF, 0);
+		m_FileSize = 0;
+		if (m_Desc.Binary)
+			m_FileSize += std::fwrite(LogBinaryMagic, 1, sizeof(LogBinaryMagic), m_File);
+		return true;
+	}
+
+	void LogFileSink::Rotate() {
+		std::fclose(m_File);
+		m_File = nullptr;
+
+		// file.(n-2) -> file.(n-1) ... file -> file.1, the oldest one falls off
+		if (m_Desc.MaxFiles > 1) {
+			std::string oldest = m_Desc.FilePath + "." + std::to_string(m_Desc.MaxFiles - 1);
+			std::remove(oldest.c_str());
+			for (unsigned int i = m_Desc.MaxFiles - 1; i > 1; i--) {
+				std::string from = m_Desc.FilePath + "." + std::to_string(i - 1);
+				std::string to = m_Desc.FilePath + "." + std::to_string(i);
+				std::rename(from.c_str(), to.c_str());
+			}
+			std::string first = m_Desc.FilePath + ".1";
+			std::rename(m_Desc.FilePath.c_str(), first.c_str());
+		}
+
+		OpenFile();
+	}
+
+}
\ No newline at end of file
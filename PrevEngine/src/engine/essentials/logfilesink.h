@@ -0,0 +1,64 @@
+#pragma once
+
+#include "engine/essentials/log.h"
+#include "engine/memory/memorytracker.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace prev {
+
+	struct LogFileSinkDesc {
+		LogFileSinkDesc(const std::string & filePath = "", bool binary = false) :
+			FilePath(filePath), Binary(binary) {
+		}
+		std::string FilePath;							// Empty for no file
+		bool Binary;									// Compact records, decode with PrevLogDecode
+		bool Stdout = false;							// Also print text to stdout
+		unsigned long long MaxFileSize = 64ull << 20;	// Rotate when the file would grow past this, 0 to never rotate
+		unsigned int MaxFiles = 5;						// FilePath, FilePath.1 ... FilePath.(MaxFiles - 1)
+		unsigned int FlushIntervalMs = 100;
+	};
+
+	// Log sink for long headless runs
+	// Messages are batched in memory on the draining thread and written by a background thread
+	class LogFileSink {
+	public:
+		LogFileSink(const LogFileSinkDesc & desc);
+		~LogFileSink();
+
+		LogFileSink(const LogFileSink &) = delete;
+		LogFileSink & operator=(const LogFileSink &) = delete;
+
+		inline bool IsOpen() const { return m_Status; }
+		// Blocks until everything pushed so far is written
+		void Flush();
+	private:
+		void Push(std::string_view message, LogLevel level);
+		void WriterThread();
+		void WriteBatch(const TaggedVector<char, MemTag::Log> & batch);
+		bool OpenFile();
+		void Rotate();
+	private:
+		LogFileSinkDesc m_Desc;
+		bool m_Status = false;
+		unsigned int m_SinkId = 0;
+
+		std::FILE * m_File = nullptr;
+		unsigned long long m_FileSize = 0;
+
+		// Pending is filled by Push, the writer swaps it with Writing and writes that
+		TaggedVector<char, MemTag::Log> m_Pending;
+		TaggedVector<char, MemTag::Log> m_Writing;
+		TaggedVector<char, MemTag::Log> m_TextBuffer;
+		std::mutex m_Mutex;
+		std::condition_variable m_WakeWriter;
+		std::condition_variable m_Written;
+		bool m_Stop = false;
+		bool m_FlushRequested = false;
+		bool m_IsWriting = false;
+		std::thread m_Thread;
+	};
+
+}
\ No newline at end of file
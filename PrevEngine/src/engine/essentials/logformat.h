@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+namespace prev {
+
+	// Layout of the binary log files written by LogFileSink and read by PrevLogDecode
+	// The file starts with LogBinaryMagic, followed by records : LogBinaryRecordHeader then Length bytes of text
+	static const char LogBinaryMagic[8] = { 'P', 'V', 'L', 'O', 'G', '0', '0', '1' };
+
+	struct LogBinaryRecordHeader {
+		std::uint64_t Timestamp;	// ns since unix epoch
+		std::uint32_t Length;
+		std::uint8_t Level;			// prev::LogLevel
+		std::uint8_t Padding[3];
+	};
+
+	static_assert(sizeof(LogBinaryRecordHeader) == 16, "LogBinaryRecordHeader layout is part of the file format");
+
+	static const char * LogLevelNames[] = { "INFO", "WARN", "ERROR", "FATAL" };
+
+}
\ No newline at end of file
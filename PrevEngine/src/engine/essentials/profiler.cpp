@@ -0,0 +1,235 @@
+#include "pch.h"
+#include "profiler.h"
+#include "tracer.h"
+
+#include "engine/jobs/jobsystem.h"
+
+#ifdef PV_PROFILER_ENABLED
+
+namespace prev {
+
+	static_assert(Profiler::MaxThreads >= JobSystem::MaxWorkers + 8, "Every job system worker needs a profiler slot, with a few to spare");
+
+	// Written only by the owning thread, read by the main thread in NewFrame
+	// A zone is a seqlock, Sequence is 0 while it's being written and its ring index + 1 once published,
+	// the reader checks it again after reading so a zone overwritten meanwhile is dropped
+	struct ThreadZone {
+		std::atomic<unsigned int> Sequence;
+		std::atomic<const char *> Name;
+		std::atomic<unsigned long long> Start;
+		std::atomic<unsigned long long> End;
+		std::atomic<unsigned int> Depth;
+	};
+
+	struct ThreadZoneBuffer {
+		std::array<ThreadZone, Profiler::ZonesPerThread> Zones;
+		std::atomic<unsigned int> Head;		// Never goes back, not even when the slot changes hands
+		unsigned int Depth;
+		std::atomic<const char *> Name;
+	};
+
+	// Everything is preallocated, recording a zone never touches the heap or a lock
+	// Taking a slot locks once per thread, a slot goes back to the free list when its thread exits
+	static std::array<ThreadZoneBuffer, Profiler::MaxThreads> s_ThreadBuffers;
+	static ThreadZoneBuffer s_OverflowBuffer; // Shared by threads past MaxThreads, never read
+	static std::atomic<unsigned int> s_ThreadCount(0);	// Slots ever used, NewFrame reads that many
+	static std::array<bool, Profiler::MaxThreads> s_SlotUsed;
+	static std::mutex s_SlotMutex;
+	static thread_local ThreadZoneBuffer * t_ThreadBuffer = nullptr;
+
+	// Frames are built into the back one, the front one is what GetLastFrame shows (it stays put while paused)
+	static std::array<ProfileFrame, 2> s_Frames;
+	static unsigned int s_FrontFrame = 0;
+	static unsigned long long s_FrameStart = 0;
+	static unsigned long long s_FrameIndex = 0;
+
+	bool Profiler::s_Paused = false;
+	std::atomic<bool> Profiler::s_Enabled(true);
+
+	static ThreadZoneBuffer * AcquireSlot() {
+		std::lock_guard<std::mutex> lock(s_SlotMutex);
+		for (unsigned int index = 0; index < Profiler::MaxThreads; index++) {
+			if (s_SlotUsed[index])
+				continue;
+			s_SlotUsed[index] = true;
+			ThreadZoneBuffer & buffer = s_ThreadBuffers[index];
+			buffer.Depth = 0;
+			buffer.Name.store(nullptr, std::memory_order_relaxed);
+			if (index >= s_ThreadCount.load(std::memory_order_relaxed))
+				s_ThreadCount.store(index + 1, std::memory_order_release);
+			return &buffer;
+		}
+		return nullptr;
+	}
+
+	// What the slot already recorded stays readable, the next thread carries on from its head
+	static void ReleaseSlot(ThreadZoneBuffer * buffer) {
+		std::lock_guard<std::mutex> lock(s_SlotMutex);
+		s_SlotUsed[buffer - s_ThreadBuffers.data()] = false;
+	}
+
+	struct ThreadSlotOwner {
+		ThreadZoneBuffer * Buffer;
+		~ThreadSlotOwner() {
+			if (Buffer != nullptr)
+				ReleaseSlot(Buffer);
+			// Zones recorded from here on (other thread_local destructors) can't take a slot again
+			t_ThreadBuffer = &s_OverflowBuffer;
+		}
+	};
+
+	static ThreadZoneBuffer & GetThreadBuffer() {
+		if (t_ThreadBuffer == nullptr) {
+			// Constructed the first time a thread gets here, so only the registering path pays for the thread exit hook
+			static thread_local ThreadSlotOwner owner{ AcquireSlot() };
+			t_ThreadBuffer = owner.Buffer != nullptr ? owner.Buffer : &s_OverflowBuffer;
+		}
+		return *t_ThreadBuffer;
+	}
+
+	unsigned long long Profiler::Now() {
+		auto now = std::chrono::steady_clock::now().time_since_epoch();
+		return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+	}
+
+	unsigned int Profiler::BeginZone(const char * name) {
+		if (!s_Enabled.load(std::memory_order_relaxed))
+			return NoZone;
+
+		ThreadZoneBuffer & buffer = GetThreadBuffer();
+		unsigned int index = buffer.Head.load(std::memory_order_relaxed);
+		ThreadZone & zone = buffer.Zones[index & (ZonesPerThread - 1)];
+		zone.Sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		zone.End.store(0, std::memory_order_relaxed);
+		zone.Name.store(name, std::memory_order_relaxed);
+		zone.Depth.store(buffer.Depth++, std::memory_order_relaxed);
+		zone.Start.store(Now(), std::memory_order_relaxed);
+		zone.Sequence.store(index + 1, std::memory_order_release);
+		buffer.Head.store(index + 1, std::memory_order_release);
+		return index;
+	}
+
+	void Profiler::EndZone(unsigned int zoneIndex) {
+		if (zoneIndex == NoZone)
+			return;
+
+		ThreadZoneBuffer & buffer = GetThreadBuffer();
+		buffer.Zones[zoneIndex & (ZonesPerThread - 1)].End.store(Now(), std::memory_order_release);
+		buffer.Depth--;
+	}
+
+	void Profiler::SetThreadName(const char * name) {
+		GetThreadBuffer().Name.store(name, std::memory_order_relaxed);
+	}
+
+	const char * Profiler::GetThreadName(unsigned int threadIndex) {
+		const char * name = threadIndex < GetThreadCount() ? s_ThreadBuffers[threadIndex].Name.load(std::memory_order_relaxed) : nullptr;
+		return name != nullptr ? name : "Thread";
+	}
+
+	unsigned int Profiler::GetThreadCount() {
+		return s_ThreadCount.load(std::memory_order_acquire);
+	}
+
+	const ProfileFrame & Profiler::GetLastFrame() {
+		return s_Frames[s_FrontFrame];
+	}
+
+	void Profiler::SetPaused(bool paused) {
+		s_Paused = paused;
+	}
+
+	void Profiler::SetEnabled(bool enabled) {
+		s_Enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	void Profiler::NewFrame() {
+		unsigned long long now = Now();
+
+		// Application names it before starting the job system so it's usually thread 0, this covers frames run without one
+		if (t_ThreadBuffer == nullptr)
+			SetThreadName("Main Thread");
+
+		if (s_FrameStart != 0 && IsEnabled() && (!s_Paused || Tracer::IsTracing())) {
+			ProfileFrame & frame = s_Frames[1 - s_FrontFrame];
+			frame.FrameIndex = s_FrameIndex;
+			frame.Start = s_FrameStart;
+			frame.End = now;
+			frame.ZoneCount = 0;
+
+			unsigned int threadCount = GetThreadCount();
+			for (unsigned int t = 0; t < threadCount; t++) {
+				ThreadZoneBuffer & buffer = s_ThreadBuffers[t];
+				unsigned int head = buffer.Head.load(std::memory_order_acquire);
+
+				// A zone belongs to the frame it ends in. Zones are written in begin order, so walk back past the ones that
+				// started in this frame and the ones that were still open when it started. A zone that ended before the frame
+				// means only shallower zones before it can still be open, at depth 0 nothing can
+				// A zone that doesn't have the sequence it should has been overwritten (or is being), nothing before it is left
+				unsigned int first = head;
+				unsigned int openDepth = MaxDepth;
+				for (unsigned int i = head; head - i < ZonesPerThread && i != 0 && openDepth > 0; i--) {
+					const ThreadZone & zone = buffer.Zones[(i - 1) & (ZonesPerThread - 1)];
+					unsigned int sequence = zone.Sequence.load(std::memory_order_acquire);
+					unsigned long long start = zone.Start.load(std::memory_order_relaxed);
+					unsigned long long end = zone.End.load(std::memory_order_relaxed);
+					unsigned int depth = zone.Depth.load(std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (sequence != i || zone.Sequence.load(std::memory_order_relaxed) != sequence)
+						break;
+					if (start < frame.Start && end != 0 && end <= frame.Start) {
+						openDepth = std::min(openDepth, depth);
+						continue;
+					}
+					first = i - 1;
+				}
+
+				std::array<int, MaxDepth> parents;
+				parents.fill(-1);
+
+				for (unsigned int i = first; i != head && frame.ZoneCount < ProfileFrame::MaxZones; i++) {
+					const ThreadZone & zone = buffer.Zones[i & (ZonesPerThread - 1)];
+					unsigned int sequence = zone.Sequence.load(std::memory_order_acquire);
+					const char * name = zone.Name.load(std::memory_order_relaxed);
+					unsigned long long start = zone.Start.load(std::memory_order_relaxed);
+					unsigned long long end = zone.End.load(std::memory_order_acquire);
+					unsigned int depth = zone.Depth.load(std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (sequence != i + 1 || zone.Sequence.load(std::memory_order_relaxed) != sequence) {
+						parents.fill(-1);
+						continue;
+					}
+					depth = depth < MaxDepth ? depth : MaxDepth - 1;
+
+					// Still open (or finished after the frame ended) it's part of a later frame, ended before it an earlier one
+					if (end == 0 || end > frame.End || end <= frame.Start || start > end) {
+						parents[depth] = -1;
+						continue;
+					}
+
+					ProfileZoneNode & node = frame.Zones[frame.ZoneCount];
+					node.Name = name;
+					node.Start = (long long)(start - frame.Start);
+					node.End = end - frame.Start;
+					node.Depth = (unsigned short)depth;
+					node.ThreadIndex = (unsigned short)t;
+					node.Parent = depth > 0 ? parents[depth - 1] : -1;
+					parents[depth] = (int)frame.ZoneCount;
+					frame.ZoneCount++;
+				}
+			}
+
+			if (Tracer::IsTracing())
+				Tracer::SubmitFrame(frame);
+			if (!s_Paused)
+				s_FrontFrame = 1 - s_FrontFrame;
+		}
+
+		s_FrameStart = now;
+		s_FrameIndex++;
+	}
+
+}
+
+#endif
\ No newline at end of file
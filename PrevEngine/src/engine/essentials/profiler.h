@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+
+#define PV_PROFILE_CONCAT_IMPL(a, b) a##b
+#define PV_PROFILE_CONCAT(a, b) PV_PROFILE_CONCAT_IMPL(a, b)
+
+#ifndef PV_DIST
+	#define PV_PROFILER_ENABLED
+	// Name must outlive the frame it was recorded in, use string literals
+	#define PV_PROFILE_SCOPE(name)	prev::ProfileScope PV_PROFILE_CONCAT(profileScope, __LINE__)(name)
+	#define PV_PROFILE_FUNCTION()	PV_PROFILE_SCOPE(__FUNCTION__)
+	#define PV_PROFILE_FRAME()		prev::Profiler::NewFrame()
+#else
+	#define PV_PROFILE_SCOPE(name)
+	#define PV_PROFILE_FUNCTION()
+	#define PV_PROFILE_FRAME()
+#endif
+
+#ifdef PV_PROFILER_ENABLED
+
+namespace prev {
+
+	// One zone as seen in a completed frame, zones are stored in begin order per thread
+	// so Depth and Parent together give the zone tree
+	struct ProfileZoneNode {
+		const char * Name;
+		long long Start;			// ns from frame start, negative for zones that began in an earlier frame
+		unsigned long long End;		// ns from frame start
+		unsigned short Depth;
+		unsigned short ThreadIndex;
+		int Parent;					// Index in ProfileFrame::Zones, -1 for root zones
+	};
+
+	struct ProfileFrame {
+		static const unsigned int MaxZones = 8192;
+
+		unsigned long long FrameIndex = 0;
+		unsigned long long Start = 0;	// ns, Profiler::Now
+		unsigned long long End = 0;		// ns, Profiler::Now
+		unsigned int ZoneCount = 0;
+		std::array<ProfileZoneNode, MaxZones> Zones;
+
+		inline float GetDurationMs() const { return (float)(End - Start) / 1000000.0f; }
+	};
+
+	class Profiler {
+	public:
+		static const unsigned int MaxThreads = 80; // Every job system worker and a few more, a thread gives its slot back when it exits
+		static const unsigned int ZonesPerThread = 4096; // Power of 2
+		static const unsigned int MaxDepth = 64;
+	public:
+		// Closes the current frame and makes it available through GetLastFrame, call from the main thread
+		static void NewFrame();
+		static const ProfileFrame & GetLastFrame();
+		static void SetPaused(bool paused);
+		inline static bool IsPaused() { return s_Paused; }
+		// Disabled, zones cost a load and a branch and frames stop being built (benchmarks turn it off while measuring)
+		static void SetEnabled(bool enabled);
+		inline static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+
+		// Name must be a string literal (or outlive the profiler)
+		static void SetThreadName(const char * name);
+		static const char * GetThreadName(unsigned int threadIndex);
+		static unsigned int GetThreadCount();
+
+		static unsigned long long Now();
+		static unsigned int BeginZone(const char * name);
+		// NoZone when the profiler is disabled, EndZone ignores it
+		static void EndZone(unsigned int zoneIndex);
+
+		static const unsigned int NoZone = ~0u;
+	private:
+		static bool s_Paused;
+		static std::atomic<bool> s_Enabled;
+	};
+
+	class ProfileScope {
+	public:
+		ProfileScope(const char * name) : m_ZoneIndex(Profiler::BeginZone(name)) {}
+		~ProfileScope() { Profiler::EndZone(m_ZoneIndex); }
+
+		ProfileScope(const ProfileScope &) = delete;
+		ProfileScope & operator=(const ProfileScope &) = delete;
+	private:
+		unsigned int m_ZoneIndex;
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -1,33 +1,69 @@
 #include "pch.h"
 #include "timer.h"
+#include "framestats.h"
 
 namespace prev {
 
 	std::chrono::duration<float> Timer::m_DeltaTime;
-	std::chrono::time_point<std::chrono::steady_clock> Timer::m_Time = std::chrono::high_resolution_clock::now();
-	std::chrono::time_point<std::chrono::steady_clock> Timer::m_StartTime = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<float> Timer::m_FixedDeltaTime(0.0f);
+	std::chrono::time_point<std::chrono::steady_clock> Timer::m_Time = std::chrono::steady_clock::now();
+	std::chrono::time_point<std::chrono::steady_clock> Timer::m_StartTime = std::chrono::steady_clock::now();
+	std::chrono::time_point<std::chrono::steady_clock> Timer::m_LastFrameTime;
 
 	unsigned int Timer::m_FPS = 0;
 	unsigned long long int Timer::m_LastTimeSec = 0;
 	bool Timer::shouldShowFPS = false;
 
+	unsigned long long Timer::m_FixedStepTicks = 1000000000ull / 60;
+	unsigned long long Timer::m_Accumulator = 0;
+	unsigned long long Timer::m_FixedStepIndex = 0;
+	unsigned long long Timer::m_DroppedFixedSteps = 0;
+	unsigned int Timer::m_MaxFixedSteps = 8;
+
 	void Timer::Update() {
-		auto currentTime = std::chrono::high_resolution_clock::now();
+		auto currentTime = std::chrono::steady_clock::now();
+		// Frame stats always see the real clock, even with a fixed delta time. The first frame includes startup so it's skipped
+		bool firstFrame = m_LastFrameTime.time_since_epoch().count() == 0;
+		if (!firstFrame)
+			FrameStats::Record((unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(currentTime - m_LastFrameTime).count());
+		m_LastFrameTime = currentTime;
+		bool fixedDelta = m_FixedDeltaTime.count() > 0.0f;
+		if (fixedDelta)
+			currentTime = m_Time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(m_FixedDeltaTime);
 		m_DeltaTime = currentTime - m_Time;
+
+		// Same for the fixed steps, otherwise the first frame runs m_MaxFixedSteps of them and drops the rest of startup
+		if (m_FixedStepTicks > 0 && (fixedDelta || !firstFrame)) {
+			m_Accumulator += (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(currentTime - m_Time).count();
+			unsigned long long maxAccumulator = m_FixedStepTicks * m_MaxFixedSteps;
+			if (m_Accumulator > maxAccumulator) {
+				m_DroppedFixedSteps += (m_Accumulator - maxAccumulator) / m_FixedStepTicks;
+				m_Accumulator = maxAccumulator;
+			}
+		}
+
 		m_Time = currentTime;
 		m_FPS++;
 		if ((unsigned long long int)GetTime() > m_LastTimeSec) {
 			m_LastTimeSec++;
 			if (shouldShowFPS) {
-				PV_IMGUI_LOG(std::string("[FPS = " + std::to_string(m_FPS) + "]").c_str(), LogLevel::PV_INFO);
+				FrameTimeStats stats = FrameStats::GetStats(0);
+				PV_LOG_INFO("[FPS = %u] p50 %.2f ms, p99 %.2f ms, max %.2f ms, %u hitches", m_FPS, stats.P50Ms, stats.P99Ms, stats.MaxMs, stats.Hitches);
 			}
 			m_FPS = 0;
 		}
 	}
 
 	float Timer::GetTime() {
-		auto duration = std::chrono::duration_cast<std::chrono::microseconds>(m_Time - m_StartTime);
-		return (float)duration.count() / 1000000;
+		return (float)GetTimeSeconds();
+	}
+
+	unsigned long long Timer::GetTicks() {
+		return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(m_Time - m_StartTime).count();
+	}
+
+	double Timer::GetTimeSeconds() {
+		return (double)GetTicks() / 1000000000.0;
 	}
 
 	float Timer::GetDeltaTime() {
@@ -38,18 +74,27 @@ namespace prev {
 		shouldShowFPS = isVisible;
 	}
 
-	TimeThis::TimeThis(bool timeInMs) {
-		m_Start = std::chrono::high_resolution_clock::now();
-		isMS = timeInMs;
+	void Timer::SetFixedDeltaTime(float deltaTime) {
+		m_FixedDeltaTime = std::chrono::duration<float>(deltaTime);
 	}
 
-	TimeThis::~TimeThis() {
-		std::chrono::duration<float> deltaTime = std::chrono::high_resolution_clock::now() - m_Start;
-		if (isMS) {
-			PV_DEBUG_LOG(("This Scope Took : " + std::to_string(deltaTime.count() * 1000) + "ms").c_str());
-		} else {
-			PV_DEBUG_LOG(("This Scope Took : " + std::to_string(deltaTime.count()) + "s").c_str());
-		}
+	void Timer::SetFixedUpdateRate(unsigned int hz) {
+		m_FixedStepTicks = hz > 0 ? 1000000000ull / hz : 0;
+		m_Accumulator = 0;
+	}
+
+	bool Timer::ConsumeFixedStep() {
+		if (m_FixedStepTicks == 0 || m_Accumulator < m_FixedStepTicks)
+			return false;
+		m_Accumulator -= m_FixedStepTicks;
+		m_FixedStepIndex++;
+		return true;
+	}
+
+	float Timer::GetInterpolationAlpha() {
+		if (m_FixedStepTicks == 0)
+			return 1.0f;
+		return (float)((double)m_Accumulator / (double)m_FixedStepTicks);
 	}
 
-}
+}
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 
-#define TIME_THIS_SCOPE		prev::TimeThis timer;
-#define TIME_THIS_SCOPE_MS	prev::TimeThis timer(true);
+#include "engine/essentials/profiler.h"
+
+// Kept for old code, scopes now show up in the profiler instead of the debug output
+#define TIME_THIS_SCOPE		PV_PROFILE_FUNCTION();
+#define TIME_THIS_SCOPE_MS	PV_PROFILE_FUNCTION();
 
 namespace prev {
 
@@ -10,24 +13,40 @@ namespace prev {
 		static void Update();
 		static float GetTime();
 		static float GetDeltaTime();
+		// 64-bit nanosecond ticks since start, use these for anything that runs for hours
+		static unsigned long long GetTicks();
+		static double GetTimeSeconds();
 		static void FPSCounter(bool isVisible);
 		inline static bool IsLoggingFPSCounter() {return shouldShowFPS; }
+		// Advance time by a fixed amount every Update instead of reading the clock, 0 to use the clock again
+		static void SetFixedDeltaTime(float deltaTime);
+		inline static float GetFixedDeltaTime() { return m_FixedDeltaTime.count(); }
+
+		// Fixed step simulation, Layer::OnFixedUpdate runs at this rate no matter the frame rate, 0 to turn it off
+		static void SetFixedUpdateRate(unsigned int hz);
+		inline static float GetFixedStep() { return (float)m_FixedStepTicks / 1000000000.0f; }
+		// More steps than this in one frame are dropped (spiral of death), the simulation slows down instead
+		inline static void SetMaxFixedSteps(unsigned int steps) { m_MaxFixedSteps = steps > 0 ? steps : 1; }
+		// Called by the application, true while a whole step is left in the accumulator
+		static bool ConsumeFixedStep();
+		// How far we are between the last fixed step and the next one [0, 1), for interpolating what gets rendered
+		static float GetInterpolationAlpha();
+		inline static unsigned long long GetFixedStepIndex() { return m_FixedStepIndex; }
+		inline static unsigned long long GetDroppedFixedSteps() { return m_DroppedFixedSteps; }
 	private:
 		static std::chrono::duration<float> m_DeltaTime;
+		static std::chrono::duration<float> m_FixedDeltaTime;
 		static std::chrono::time_point<std::chrono::steady_clock> m_Time, m_StartTime;
+		static std::chrono::time_point<std::chrono::steady_clock> m_LastFrameTime;	// Real clock, for FrameStats
 		static unsigned int m_FPS;
 		static unsigned long long int m_LastTimeSec;
 		static bool shouldShowFPS;
-	};
 
-	//Time any scope
-	class TimeThis {
-	public:
-		TimeThis(bool timeInMs = false);
-		~TimeThis();
-	private:
-		std::chrono::time_point<std::chrono::steady_clock> m_Start;
-		bool isMS;
+		static unsigned long long m_FixedStepTicks;
+		static unsigned long long m_Accumulator;
+		static unsigned long long m_FixedStepIndex;
+		static unsigned long long m_DroppedFixedSteps;
+		static unsigned int m_MaxFixedSteps;
 	};
 
 }
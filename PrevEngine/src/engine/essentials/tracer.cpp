@@ -0,0 +1,203 @@
+#include "pch.h"
+#include "tracer.h"
+
+#ifdef PV_PROFILER_ENABLED
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace prev {
+
+	struct TraceEvent {
+		const char * Name;
+		unsigned long long Start;		// ns, Profiler::Now
+		unsigned long long Duration;	// ns
+		unsigned short ThreadIndex;
+	};
+
+	struct TraceBlock {
+		static const unsigned int Capacity = 4096;
+		std::array<TraceEvent, Capacity> Events;
+		unsigned int Count;
+	};
+
+	static const unsigned int s_BlockCount = 32;
+	static std::array<TraceBlock, s_BlockCount> s_Blocks;
+
+	// Both guarded by s_Mutex, the writer thread sleeps on s_Condition
+	static std::array<TraceBlock *, s_BlockCount> s_FreeBlocks;
+	static unsigned int s_FreeCount = 0;
+	static std::array<TraceBlock *, s_BlockCount> s_ReadyBlocks;
+	static unsigned int s_ReadyHead = 0, s_ReadyCount = 0;
+
+	static std::mutex s_Mutex;
+	static std::condition_variable s_Condition;
+	static std::thread s_WriterThread;
+	static bool s_StopWriter = false;
+
+	static TraceBlock * s_CurrentBlock = nullptr;	// Only touched by the frame thread
+	static std::FILE * s_File = nullptr;			// Only touched by the writer thread while tracing
+	static unsigned long long s_TraceStart = 0;
+	static unsigned long long s_LastSubmit = 0;
+	static unsigned long long s_DroppedEvents = 0;
+	static bool s_FirstEvent = true;
+
+	bool Tracer::s_IsTracing = false;
+
+	// Names come from user code, a quote or a backslash in one would break the whole file
+	static void WriteJsonString(const char * str) {
+		std::fputc('"', s_File);
+		for (; *str != '\0'; str++) {
+			unsigned char c = (unsigned char)*str;
+			if (c == '"' || c == '\\') {
+				std::fputc('\\', s_File);
+				std::fputc(c, s_File);
+			} else if (c < 0x20) {
+				std::fprintf(s_File, "\\u%04x", c);
+			} else {
+				std::fputc(c, s_File);
+			}
+		}
+		std::fputc('"', s_File);
+	}
+
+	static void WriteBlock(const TraceBlock & block) {
+		for (unsigned int i = 0; i < block.Count; i++) {
+			const TraceEvent & e = block.Events[i];
+			std::fprintf(s_File, "%s\n{\"name\":", s_FirstEvent ? "" : ",");
+			WriteJsonString(e.Name);
+			std::fprintf(s_File, ",\"cat\":\"engine\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u}",
+						 (double)(e.Start - s_TraceStart) / 1000.0, (double)e.Duration / 1000.0, (unsigned int)e.ThreadIndex);
+			s_FirstEvent = false;
+		}
+	}
+
+	// One per trace, it gives its profiler slot back when it exits
+	static void WriterThread() {
+		Profiler::SetThreadName("Trace Writer");
+		std::unique_lock<std::mutex> lock(s_Mutex);
+		while (true) {
+			s_Condition.wait(lock, []() -> bool { return s_ReadyCount > 0 || s_StopWriter; });
+			if (s_ReadyCount == 0 && s_StopWriter)
+				break;
+
+			TraceBlock * block = s_ReadyBlocks[s_ReadyHead];
+			s_ReadyHead = (s_ReadyHead + 1) % s_BlockCount;
+			s_ReadyCount--;
+
+			lock.unlock();
+			WriteBlock(*block);
+			lock.lock();
+
+			s_FreeBlocks[s_FreeCount++] = block;
+		}
+	}
+
+	static void SubmitCurrentBlock() {
+		if (s_CurrentBlock == nullptr)
+			return;
+		{
+			std::lock_guard<std::mutex> lock(s_Mutex);
+			s_ReadyBlocks[(s_ReadyHead + s_ReadyCount) % s_BlockCount] = s_CurrentBlock;
+			s_ReadyCount++;
+		}
+		s_Condition.notify_one();
+		s_CurrentBlock = nullptr;
+		s_LastSubmit = Profiler::Now();
+	}
+
+	static bool AcquireBlock() {
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		if (s_FreeCount == 0)
+			return false;
+		s_CurrentBlock = s_FreeBlocks[--s_FreeCount];
+		s_CurrentBlock->Count = 0;
+		return true;
+	}
+
+	bool Tracer::Start(const std::string & filePath) {
+		if (s_IsTracing)
+			return false;
+
+		s_File = std::fopen(filePath.c_str(), "w");
+		if (s_File == nullptr)
+			return false;
+		std::setvbuf(s_File, nullptr, _IOFBF, 1 << 20);
+		std::fprintf(s_File, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+		for (unsigned int i = 0; i < s_BlockCount; i++)
+			s_FreeBlocks[i] = &s_Blocks[i];
+		s_FreeCount = s_BlockCount;
+		s_ReadyHead = 0;
+		s_ReadyCount = 0;
+		s_StopWriter = false;
+		s_CurrentBlock = nullptr;
+		s_DroppedEvents = 0;
+		s_FirstEvent = true;
+		s_TraceStart = Profiler::Now();
+		s_LastSubmit = s_TraceStart;
+
+		s_WriterThread = std::thread(WriterThread);
+		s_IsTracing = true;
+		return true;
+	}
+
+	void Tracer::Stop() {
+		if (!s_IsTracing)
+			return;
+		s_IsTracing = false;
+
+		SubmitCurrentBlock();
+		{
+			std::lock_guard<std::mutex> lock(s_Mutex);
+			s_StopWriter = true;
+		}
+		s_Condition.notify_one();
+		s_WriterThread.join();
+
+		// Name the threads so the viewer doesn't just show ids
+		for (unsigned int t = 0; t < Profiler::GetThreadCount(); t++) {
+			std::fprintf(s_File, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":", s_FirstEvent ? "" : ",", t);
+			WriteJsonString(Profiler::GetThreadName(t));
+			std::fprintf(s_File, "}}");
+			s_FirstEvent = false;
+		}
+		std::fprintf(s_File, "\n]}\n");
+		std::fclose(s_File);
+		s_File = nullptr;
+
+		if (s_DroppedEvents > 0)
+			PV_LOG_WARN("Trace dropped %llu events, the writer could not keep up", s_DroppedEvents);
+	}
+
+	void Tracer::SubmitFrame(const ProfileFrame & frame) {
+		for (unsigned int i = 0; i < frame.ZoneCount; i++) {
+			// Tracing can start mid frame, zones that began before that would get a negative timestamp
+			const ProfileZoneNode & zone = frame.Zones[i];
+			if (frame.Start + zone.Start < s_TraceStart)
+				continue;
+
+			if (s_CurrentBlock == nullptr && !AcquireBlock()) {
+				s_DroppedEvents += frame.ZoneCount - i;
+				return;
+			}
+
+			TraceEvent & e = s_CurrentBlock->Events[s_CurrentBlock->Count++];
+			e.Name = zone.Name;
+			e.Start = frame.Start + zone.Start;
+			e.Duration = zone.End - zone.Start;
+			e.ThreadIndex = zone.ThreadIndex;
+
+			if (s_CurrentBlock->Count == TraceBlock::Capacity)
+				SubmitCurrentBlock();
+		}
+
+		// Hand over partial blocks now and then so the file keeps up with the session
+		if (Profiler::Now() - s_LastSubmit > 100000000ull)
+			SubmitCurrentBlock();
+	}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "engine/essentials/profiler.h"
+
+#ifdef PV_PROFILER_ENABLED
+
+namespace prev {
+
+	// Streams profiled frames into a chrome://tracing (and Perfetto) compatible json file
+	// Formatting and file io happen on a background thread, the frame thread only copies zones into preallocated blocks
+	class Tracer {
+	public:
+		static bool Start(const std::string & filePath);
+		static void Stop();
+		inline static bool IsTracing() { return s_IsTracing; }
+
+		// Called by Profiler::NewFrame for every completed frame while tracing
+		static void SubmitFrame(const ProfileFrame & frame);
+	private:
+		static bool s_IsTracing;
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -2,7 +2,6 @@
 
 #include "event.h"
 
-#include <sstream>
 #include <string>
 #include <functional>
 
@@ -15,10 +14,8 @@ namespace prev {
 		inline unsigned int GetWidth() const { return m_Width; }
 		inline unsigned int GetHeight() const { return m_Height; }
 		
-		std::string ToString() const override {
-			std::stringstream ss;
-			ss << "WindowResizeEvent: " << m_Width << ", " << m_Height;
-			return ss.str();
+		FrameString ToFrameString() const override {
+			return FrameFormat("WindowResizeEvent: %u, %u", m_Width, m_Height);
 		}
 
 		EVENT_CLASS_TYPE(WindowResize)
@@ -43,10 +40,8 @@ namespace prev {
 		inline unsigned int GetXPos() const { return m_Xpos; }
 		inline unsigned int GetYPos() const { return m_Ypos; }
 
-		std::string ToString() const override {
-			std::stringstream ss;
-			ss << "WindowMovedEvent: " << m_Xpos << ", " << m_Ypos;
-			return ss.str();
+		FrameString ToFrameString() const override {
+			return FrameFormat("WindowMovedEvent: %u, %u", m_Xpos, m_Ypos);
 		}
 
 		EVENT_CLASS_TYPE(WindowMoved)
@@ -3,9 +3,13 @@
 #include <string>
 #include <sstream>
 #include <functional>
+#include <type_traits>
+
+#include "engine/memory/frameallocator.h"
 
 #define BIT(x) (1 << x)
-#define BIND_EVENT_FN(x) std::bind(&x, this, std::placeholders::_1)
+// Plain lambda instead of std::bind, the dispatcher calls it directly so nothing gets type erased
+#define BIND_EVENT_FN(x) [this](auto & e) -> decltype(auto) { return x(e); }
 
 namespace prev {
 
@@ -39,7 +43,13 @@ namespace prev {
 		virtual EventType GetEventType() const = 0;
 		virtual const char * GetName() const = 0;
 		virtual int GetCategoryFlags() const = 0;
-		virtual std::string ToString() const { return GetName(); }
+		// Debug text, safe to keep
+		virtual std::string ToString() const {
+			FrameString str = ToFrameString();
+			return std::string(str.data(), str.size());
+		}
+		// Same text in frame memory for per frame logging, don't keep it past the frame
+		virtual FrameString ToFrameString() const { return MakeFrameString(GetName()); }
 
 		inline bool IsInCategory(EventCategory category) {
 			return GetCategoryFlags() & category;
@@ -50,27 +60,39 @@ namespace prev {
 		bool m_Handled = false;
 	};
 
+	// Handlers are templates resolved at compile time, only the event type is read at runtime (once per dispatcher)
+	// Usage :
+	//	dispatcher.Dispatch<WindowResizeEvent>(BIND_EVENT_FN(X::Resize));		any callable taking T &, returning bool
+	//	dispatcher.Dispatch(this, &X::Resize);									member function, T deduced from it
+	//	dispatcher.Dispatch(this, &X::Resize, &X::KeyPressed, ...);				a whole handler table, stops at the matching one
 	class EventDispatcher {
-		template<typename T>
-		using EventFn = std::function<bool(T&)>;
 	public:
 		EventDispatcher(Event &event) :
-			m_Event(event) {}
+			m_Event(event), m_EventType(event.GetEventType()) {}
 
-		template<typename T>
-		bool Dispatch(EventFn<T> func) {
-			if (m_Event.GetEventType() == T::GetStaticType()) {
-				m_Event.m_Handled = func(*(T*)&m_Event);
+		template<typename T, typename F>
+		bool Dispatch(F && func) {
+			static_assert(std::is_base_of_v<Event, T>, "Dispatch needs an event type");
+			if (m_EventType == T::GetStaticType()) {
+				m_Event.m_Handled = func(static_cast<T &>(m_Event));
 				return true;
 			}
 			return false;
 		}
+
+		template<typename C, typename... T>
+		bool Dispatch(C * object, bool (C::*... funcs)(T &)) {
+			return (Dispatch<T>([object, funcs](T & e) -> bool { return (object->*funcs)(e); }) || ...);
+		}
+
+		inline EventType GetEventType() const { return m_EventType; }
 	private:
 		Event &m_Event;
+		EventType m_EventType;
 	};
 
 	inline std::ostream& operator<<(std::ostream &os, const Event &e) {
-		return os << e.ToString();
+		return os << e.ToFrameString();
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "pch.h"
+#include "eventqueue.h"
+
+namespace prev {
+
+	EventQueue::EventQueue() {
+		m_Records[0].reserve(InitialCapacity);
+		m_Records[1].reserve(InitialCapacity);
+	}
+
+	void EventQueue::Push(Event & e) {
+		Push(ToRecord(e));
+	}
+
+	EventRecord EventQueue::ToRecord(Event & e) {
+		EventRecord record = {};
+		record.Type = e.GetEventType();
+		switch (record.Type) {
+		case EventType::WindowResize:
+		{
+			auto & event = static_cast<WindowResizeEvent &>(e);
+			record.Resize.Width = event.GetWidth();
+			record.Resize.Height = event.GetHeight();
+			break;
+		}
+		case EventType::WindowMoved:
+		{
+			auto & event = static_cast<WindowMoveEvent &>(e);
+			record.Move.X = event.GetXPos();
+			record.Move.Y = event.GetYPos();
+			break;
+		}
+		case EventType::KeyPressed:
+		{
+			auto & event = static_cast<KeyPressedEvent &>(e);
+			record.Key.KeyCode = event.GetKeyCode();
+			record.Key.Repeat = event.IsRepeating();
+			break;
+		}
+		case EventType::KeyReleased:
+			record.Key.KeyCode = static_cast<KeyReleasedEvent &>(e).GetKeyCode();
+			break;
+		case EventType::CharacterInput:
+			record.Character.Char = (unsigned char)static_cast<CharacterEvent &>(e).GetPressedChar();
+			break;
+		case EventType::MouseButtonPressed:
+		case EventType::MouseButtonReleased:
+			record.MouseButton.Button = static_cast<MouseButtonEvent &>(e).GetMouseButton();
+			break;
+		case EventType::MouseMoved:
+		{
+			auto & event = static_cast<MouseMovedEvent &>(e);
+			record.MouseMove.X = event.GetX();
+			record.MouseMove.Y = event.GetY();
+			break;
+		}
+		case EventType::MouseScrolled:
+		{
+			auto & event = static_cast<MouseScrolledEvent &>(e);
+			record.Scroll.XOffset = event.GetXOffset();
+			record.Scroll.YOffset = event.GetYOffset();
+			break;
+		}
+		default:
+			break;
+		}
+		return record;
+	}
+
+	void EventQueue::Push(const EventRecord & record) {
+		TaggedVector<EventRecord, MemTag::Event> & records = m_Records[m_Back];
+
+		if (m_Coalesce && !records.empty() && records.back().Type == record.Type) {
+			EventRecord & last = records.back();
+			switch (record.Type) {
+			case EventType::MouseMoved:
+			case EventType::WindowResize:
+				last = record;
+				m_Coalesced++;
+				return;
+			case EventType::MouseScrolled:
+				last.Scroll.XOffset += record.Scroll.XOffset;
+				last.Scroll.YOffset += record.Scroll.YOffset;
+				m_Coalesced++;
+				return;
+			default:
+				break;
+			}
+		}
+
+		records.push_back(record);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "event.h"
+#include "engine/memory/memorytracker.h"
+
+#include <vector>
+
+namespace prev {
+
+	// Plain copy of an event, no vtable, no heap
+	struct EventRecord {
+		EventType Type;
+		union {
+			struct { unsigned int Width, Height; } Resize;
+			struct { unsigned int X, Y; } Move;
+			struct { int KeyCode; bool Repeat; } Key;
+			struct { unsigned char Char; } Character;
+			struct { int Button; } MouseButton;
+			struct { float X, Y; } MouseMove;
+			struct { float XOffset, YOffset; } Scroll;
+		};
+	};
+
+	// Windows push their events here instead of walking the layer stack for every OS message
+	// Everything pushed during a frame is dispatched in one pass, in push order, by Dispatch
+	class EventQueue {
+	public:
+		static const unsigned int InitialCapacity = 1024;
+
+		EventQueue();
+
+		// Usable directly as the window event callback
+		void Push(Event & e);
+		void Push(const EventRecord & record);
+
+		// Calls func with every queued event rebuilt on the stack, events pushed meanwhile wait for the next Dispatch
+		template<typename F>
+		void Dispatch(F && func) {
+			TaggedVector<EventRecord, MemTag::Event> & records = m_Records[m_Back];
+			m_Back ^= 1;
+			m_LastDispatched = (unsigned int)records.size();
+			m_LastCoalesced = m_Coalesced;
+			m_Coalesced = 0;
+			for (const EventRecord & record : records)
+				Rebuild(record, func);
+			records.clear();
+		}
+
+		// Merge consecutive mouse moves and resizes (last wins) and scrolls (summed)
+		inline void SetCoalescing(bool coalesce) { m_Coalesce = coalesce; }
+		inline bool IsCoalescing() const { return m_Coalesce; }
+
+		inline unsigned int GetLastDispatchedCount() const { return m_LastDispatched; }
+		inline unsigned int GetLastCoalescedCount() const { return m_LastCoalesced; }
+
+		static EventRecord ToRecord(Event & e);
+		// Builds the real event on the stack and calls func with it
+		template<typename F>
+		static void Rebuild(const EventRecord & record, F & func);
+	private:
+		// Double buffered so handlers can push while we dispatch
+		TaggedVector<EventRecord, MemTag::Event> m_Records[2];
+		unsigned int m_Back = 0;
+		bool m_Coalesce = true;
+		unsigned int m_Coalesced = 0;
+		unsigned int m_LastDispatched = 0;
+		unsigned int m_LastCoalesced = 0;
+	};
+
+}
+
+#include "applicationevent.h"
+#include "keyevent.h"
+#include "mouseevent.h"
+
+namespace prev {
+
+	template<typename F>
+	void EventQueue::Rebuild(const EventRecord & record, F & func) {
+		switch (record.Type) {
+		case EventType::WindowClose:			{ WindowCloseEvent e; func(e); break; }
+		case EventType::WindowResize:			{ WindowResizeEvent e(record.Resize.Width, record.Resize.Height); func(e); break; }
+		case EventType::WindowMoved:			{ WindowMoveEvent e(record.Move.X, record.Move.Y); func(e); break; }
+		case EventType::AppTick:				{ AppTickEvent e; func(e); break; }
+		case EventType::AppUpdate:				{ AppUpdateEvent e; func(e); break; }
+		case EventType::AppRender:				{ AppRenderEvent e; func(e); break; }
+		case EventType::KeyPressed:				{ KeyPressedEvent e(record.Key.KeyCode, record.Key.Repeat); func(e); break; }
+		case EventType::KeyReleased:			{ KeyReleasedEvent e(record.Key.KeyCode); func(e); break; }
+		case EventType::CharacterInput:			{ CharacterEvent e(record.Character.Char); func(e); break; }
+		case EventType::MouseButtonPressed:		{ MouseButtonPressedEvent e(record.MouseButton.Button); func(e); break; }
+		case EventType::MouseButtonReleased:	{ MouseButtonReleasedEvent e(record.MouseButton.Button); func(e); break; }
+		case EventType::MouseMoved:				{ MouseMovedEvent e(record.MouseMove.X, record.MouseMove.Y); func(e); break; }
+		case EventType::MouseScrolled:			{ MouseScrolledEvent e(record.Scroll.XOffset, record.Scroll.YOffset); func(e); break; }
+		default:								break;
+		}
+	}
+
+}
\ No newline at end of file
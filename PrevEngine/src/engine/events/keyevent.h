@@ -23,10 +23,8 @@ namespace prev {
 
 		inline int IsRepeating() const { return m_Repeat; }
 
-		std::string ToString() const override {
-			std::stringstream ss;
-			ss << "KeyPressedEvent: " << m_KeyCode << " (" << m_Repeat << " repeats)";
-			return ss.str();
+		FrameString ToFrameString() const override {
+			return FrameFormat("KeyPressedEvent: %d (%d repeats)", m_KeyCode, (int)m_Repeat);
 		}
 
 		EVENT_CLASS_TYPE(KeyPressed)
@@ -39,10 +37,8 @@ namespace prev {
 		KeyReleasedEvent(int keycode) :
 			KeyEvent(keycode) {}
 
-		std::string ToString() const override {
-			std::stringstream ss;
-			ss << "KeyReleasedEvent: " << m_KeyCode;
-			return ss.str();
+		FrameString ToFrameString() const override {
+			return FrameFormat("KeyReleasedEvent: %d", m_KeyCode);
 		}
 
 		EVENT_CLASS_TYPE(KeyReleased)
@@ -55,10 +51,8 @@ namespace prev {
 
 		inline char GetPressedChar() const { return m_PressedChar; }
 
-		std::string ToString() const override {
-			std::string str;
-			str = m_PressedChar;
-			return str;
+		FrameString ToFrameString() const override {
+			return FrameString(1, (char)m_PressedChar, FrameAllocator::GetResource());
 		}
 
 		EVENT_CLASS_TYPE(CharacterInput)
@@ -12,10 +12,8 @@ namespace prev {
 		inline float GetX() const { return m_MouseX; }
 		inline float GetY() const { return m_MouseY; }
 
-		std::string ToString() const override {
-			std::stringstream ss;
-			ss << "MouseMovedEvent: " << GetX() << ", " << GetY();
-			return ss.str();
+		FrameString ToFrameString() const override {
+			return FrameFormat("MouseMovedEvent: %g, %g", GetX(), GetY());
 		}
 
 		EVENT_CLASS_TYPE(MouseMoved)
@@ -32,10 +30,8 @@ namespace prev {
 		inline float GetXOffset() const { return m_XOffset; }
 		inline float GetYOffset() const { return m_YOffset; }
 
-		std::string ToString() const override {
-			std::stringstream ss;
-			ss << "MouseScrolledEvent: " << GetXOffset() << ", " << GetYOffset();
-			return ss.str();
+		FrameString ToFrameString() const override {
+			return FrameFormat("MouseScrolledEvent: %g, %g", GetXOffset(), GetYOffset());
 		}
 
 		EVENT_CLASS_TYPE(MouseScrolled)
@@ -61,10 +57,8 @@ namespace prev {
 		MouseButtonPressedEvent(int button) :
 			MouseButtonEvent(button) {}
 
-		std::string ToString() const override {
-			std::stringstream ss;
-			ss << "MouseButtonPressedEvent: " << m_Button;
-			return ss.str();
+		FrameString ToFrameString() const override {
+			return FrameFormat("MouseButtonPressedEvent: %d", m_Button);
 		}
 
 		EVENT_CLASS_TYPE(MouseButtonPressed)
@@ -75,10 +69,8 @@ namespace prev {
 		MouseButtonReleasedEvent(int button) :
 			MouseButtonEvent(button) {}
 
-		std::string ToString() const override {
-			std::stringstream ss;
-			ss << "MouseButtonReleasedEvent: " << m_Button;
-			return ss.str();
+		FrameString ToFrameString() const override {
+			return FrameFormat("MouseButtonReleasedEvent: %d", m_Button);
 		}
 
 		EVENT_CLASS_TYPE(MouseButtonReleased)
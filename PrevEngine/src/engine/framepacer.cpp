@@ -0,0 +1,149 @@
+#include "pch.h"
+#include "framepacer.h"
+
+namespace prev {
+
+	// Never trust the OS to wake us up closer than this, and never give up more than this to sleep error
+	static const long long s_MinSleepGranularity = 50000;
+	static const long long s_MaxSleepGranularity = 20000000;
+
+	// std::min takes it by reference
+	const unsigned int FramePacer::CostHistorySize;
+
+	long long FramePacer::Now() {
+		return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void FramePacer::SetMode(FramePacingMode mode) {
+		m_Mode = mode;
+		m_Deadline = 0;
+	}
+
+	void FramePacer::SetTargetFPS(float fps) {
+		m_TargetFPS = fps > 0.0f ? fps : 0.0f;
+		m_Period = m_TargetFPS > 0.0f ? (long long)(1000000000.0 / m_TargetFPS) : 0;
+		m_Deadline = 0;
+		if (m_Period > 0 && !m_Calibrated)
+			CalibrateSleep();
+	}
+
+	void FramePacer::CalibrateSleep() {
+		long long worst = 0;
+		for (int i = 0; i < 5; i++) {
+			long long before = Now();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			worst = std::max(worst, Now() - before - 1000000);
+		}
+		m_SleepGranularity = std::min(std::max(worst, s_MinSleepGranularity), s_MaxSleepGranularity);
+		m_Calibrated = true;
+	}
+
+	long long FramePacer::WaitUntil(long long target) {
+		long long now = Now();
+		// Sleep while it's safe, stopping short by how much the OS usually oversleeps
+		while (target - now > m_SleepGranularity + s_MinSleepGranularity) {
+			long long request = target - now - m_SleepGranularity;
+			std::this_thread::sleep_for(std::chrono::nanoseconds(request));
+			long long after = Now();
+			long long overshoot = after - now - request;
+			m_Slept += after - now;
+			now = after;
+
+			// Go up right away, come down slowly
+			if (overshoot > m_SleepGranularity)
+				m_SleepGranularity = overshoot;
+			else
+				m_SleepGranularity += (overshoot - m_SleepGranularity) / 16;
+			m_SleepGranularity = std::min(std::max(m_SleepGranularity, s_MinSleepGranularity), s_MaxSleepGranularity);
+		}
+
+		// Spin out the rest
+		long long spinStart = now;
+		while (now < target) {
+			std::this_thread::yield();
+			now = Now();
+		}
+		m_Spun += now - spinStart;
+		return now - target;
+	}
+
+	long long FramePacer::GetPredictedCost() const {
+		// The worst recent frame, being late costs more than waking up early
+		long long cost = 0;
+		for (unsigned int i = 0; i < std::min(m_CostCount, CostHistorySize); i++)
+			cost = std::max(cost, m_Costs[i]);
+		return cost;
+	}
+
+	void FramePacer::BeginFrame() {
+		long long now = Now();
+		if (m_Mode == FramePacingMode::Off || m_Period == 0) {
+			m_FrameStart = now;
+			return;
+		}
+
+		if (m_Deadline == 0)
+			m_Deadline = now + m_Period;
+
+		long long slotStart = m_Deadline - m_Period;
+		long long target = slotStart;
+		if (m_Mode == FramePacingMode::Adaptive)
+			target = std::max(m_Deadline - GetPredictedCost() - m_SafetyMargin, slotStart);
+
+		if (target > now) {
+			long long wakeError = WaitUntil(target);
+			m_WakeErrorSum += wakeError;
+			m_WakeErrorMax = std::max(m_WakeErrorMax, wakeError);
+			m_Waits++;
+		}
+		m_FrameStart = Now();
+	}
+
+	void FramePacer::EndFrame() {
+		if (m_Mode == FramePacingMode::Off || m_Period == 0 || m_Deadline == 0)
+			return;
+
+		long long end = Now();
+		m_Costs[m_CostCount++ % CostHistorySize] = end - m_FrameStart;
+
+		long long deadlineError = end - m_Deadline;
+		m_DeadlineErrorSum += deadlineError;
+		m_Frames++;
+
+		// A late frame starts a new grid from now instead of rushing the next frames to catch up
+		if (deadlineError > 0) {
+			m_MissedDeadlines++;
+			m_Deadline = end + m_Period;
+		} else {
+			m_Deadline += m_Period;
+		}
+	}
+
+	FramePacingStats FramePacer::GetStats() const {
+		FramePacingStats stats;
+		stats.Frames = m_Frames;
+		stats.MissedDeadlines = m_MissedDeadlines;
+		if (m_Waits > 0)
+			stats.MeanWakeErrorUs = (float)((double)m_WakeErrorSum / m_Waits / 1000.0);
+		stats.MaxWakeErrorUs = (float)m_WakeErrorMax / 1000.0f;
+		if (m_Frames > 0)
+			stats.MeanDeadlineErrorUs = (float)((double)m_DeadlineErrorSum / m_Frames / 1000.0);
+		stats.SleepGranularityUs = (float)m_SleepGranularity / 1000.0f;
+		stats.PredictedCostMs = (float)GetPredictedCost() / 1000000.0f;
+		stats.SleptMs = (float)m_Slept / 1000000.0f;
+		stats.SpunMs = (float)m_Spun / 1000000.0f;
+		return stats;
+	}
+
+	void FramePacer::ResetStats() {
+		m_Frames = 0;
+		m_MissedDeadlines = 0;
+		m_WakeErrorSum = 0;
+		m_WakeErrorMax = 0;
+		m_Waits = 0;
+		m_DeadlineErrorSum = 0;
+		m_Slept = 0;
+		m_Spun = 0;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+
+namespace prev {
+
+	enum class FramePacingMode {
+		Off,		// Run as fast as possible
+		Cap,		// Start a frame at most every 1 / fps
+		Adaptive	// Start as late as possible and still finish before the next deadline, input is fresher
+	};
+
+	struct FramePacingStats {
+		unsigned long long Frames = 0;
+		unsigned long long MissedDeadlines = 0;	// Frames that finished after their deadline
+		float MeanWakeErrorUs = 0.0f;			// How late the wait returned compared to the time asked for
+		float MaxWakeErrorUs = 0.0f;
+		float MeanDeadlineErrorUs = 0.0f;		// Frame end - deadline, negative is early
+		float SleepGranularityUs = 0.0f;		// Measured OS sleep overshoot
+		float PredictedCostMs = 0.0f;			// Adaptive mode, what we think the next frame costs
+		float SleptMs = 0.0f;					// Time handed back to the OS vs time spun, since the last reset
+		float SpunMs = 0.0f;
+	};
+
+	// Waits between frames with a sleep followed by a short spin, the sleep stops early by the measured OS granularity
+	// BeginFrame goes before input is read, EndFrame after the frame was submitted. Main thread only
+	class FramePacer {
+	public:
+		static const unsigned int CostHistorySize = 32;
+	public:
+		void SetMode(FramePacingMode mode);
+		inline FramePacingMode GetMode() const { return m_Mode; }
+		// 0 turns pacing off
+		void SetTargetFPS(float fps);
+		inline float GetTargetFPS() const { return m_TargetFPS; }
+		// Extra time kept free before the deadline in adaptive mode
+		inline void SetSafetyMargin(float milliseconds) { m_SafetyMargin = (long long)(milliseconds * 1000000.0f); }
+
+		void BeginFrame();
+		void EndFrame();
+
+		// Sleeps a few times to see how much the OS oversleeps, done once the first time a target is set
+		void CalibrateSleep();
+
+		FramePacingStats GetStats() const;
+		void ResetStats();
+	private:
+		static long long Now();
+		// Returns how late we woke up
+		long long WaitUntil(long long target);
+		long long GetPredictedCost() const;
+	private:
+		FramePacingMode m_Mode = FramePacingMode::Off;
+		float m_TargetFPS = 0.0f;
+		long long m_Period = 0;				// All times are steady clock ns
+		long long m_SafetyMargin = 500000;
+		long long m_SleepGranularity = 1000000;
+		bool m_Calibrated = false;
+
+		long long m_Deadline = 0;			// End of the slot the current frame has to fit in, 0 means resync
+		long long m_FrameStart = 0;
+		std::array<long long, CostHistorySize> m_Costs{};
+		unsigned int m_CostCount = 0;
+
+		unsigned long long m_Frames = 0;
+		unsigned long long m_MissedDeadlines = 0;
+		long long m_WakeErrorSum = 0;
+		long long m_WakeErrorMax = 0;
+		unsigned long long m_Waits = 0;
+		long long m_DeadlineErrorSum = 0;
+		long long m_Slept = 0;
+		long long m_Spun = 0;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "pch.h"
+#include "framepipeline.h"
+
+namespace prev {
+
+	// std::min takes it by reference
+	const unsigned int FramePipeline::MaxFrameLatency;
+
+	FramePipeline::FramePipeline(GraphicsAPI * graphicsAPI, JobSystem * jobSystem) :
+		m_GraphicsAPI(graphicsAPI) {
+		for (FramePacket & packet : m_Packets)
+			packet.Queue.SetJobSystem(jobSystem);
+	}
+
+	FramePipeline::~FramePipeline() {
+		StopRenderThread();
+	}
+
+	void FramePipeline::SetFrameLatency(unsigned int frameLatency) {
+		frameLatency = std::min(std::max(frameLatency, 1u), MaxFrameLatency);
+		if (frameLatency == m_FrameLatency)
+			return;
+
+		StopRenderThread();
+		m_FrameLatency = frameLatency;
+		if (m_FrameLatency > 1)
+			StartRenderThread();
+	}
+
+	FramePacket & FramePipeline::BeginPacket(unsigned long long frameIndex, float deltaTime) {
+		PV_PROFILE_FUNCTION();
+
+		if (m_FrameLatency > 1) {
+			// The slot we're about to reuse was frame (m_Submitted - latency), wait until it's presented
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_PacketDone.wait(lock, [this]() { return m_Submitted - m_Completed < m_FrameLatency; });
+		}
+
+		FramePacket & packet = m_Packets[m_Submitted % m_FrameLatency];
+		packet.FrameIndex = frameIndex;
+		packet.DeltaTime = deltaTime;
+		packet.Deferred = m_FrameLatency > 1;
+		packet.Queue.Reset();
+		packet.RenderCommands.clear();
+		return packet;
+	}
+
+	void FramePipeline::SubmitPacket() {
+		if (m_FrameLatency == 1) {
+			Execute(m_Packets[0]);
+			m_LastFrameIndex = m_Packets[0].FrameIndex;
+			m_Submitted++;
+			m_Completed++;
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_LastFrameIndex = m_Packets[m_Submitted % m_FrameLatency].FrameIndex;
+			m_Submitted++;
+		}
+		m_PacketReady.notify_one();
+	}
+
+	void FramePipeline::WaitIdle() {
+		if (m_FrameLatency == 1)
+			return;
+		PV_PROFILE_FUNCTION();
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_PacketDone.wait(lock, [this]() { return m_Completed == m_Submitted; });
+	}
+
+	void FramePipeline::WaitForFrame(unsigned long long frameIndex) {
+		if (m_FrameLatency == 1)
+			return;
+		PV_PROFILE_FUNCTION();
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		// Frame indices of packets in flight are consecutive, so the nth packet back is frame (last - n)
+		m_PacketDone.wait(lock, [this, frameIndex]() {
+			unsigned long long inFlight = m_Submitted - m_Completed;
+			return inFlight == 0 || m_LastFrameIndex - inFlight + 1 > frameIndex;
+		});
+	}
+
+	void FramePipeline::Execute(FramePacket & packet) {
+		{
+			PV_PROFILE_SCOPE("GraphicsAPI::StartFrame");
+			m_GraphicsAPI->StartFrame();
+		}
+		packet.Queue.Sort();
+		{
+			PV_PROFILE_SCOPE("GraphicsAPI::Submit");
+			m_GraphicsAPI->Submit(packet.Queue);
+		}
+		{
+			PV_PROFILE_SCOPE("FramePipeline::RenderCommands");
+			for (auto & command : packet.RenderCommands)
+				command();
+		}
+		{
+			PV_PROFILE_SCOPE("GraphicsAPI::EndFrame");
+			m_GraphicsAPI->EndFrame();
+		}
+	}
+
+	void FramePipeline::RenderThread() {
+	#ifdef PV_PROFILER_ENABLED
+		Profiler::SetThreadName("Render Thread");
+	#endif
+
+		while (true) {
+			FramePacket * packet;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_PacketReady.wait(lock, [this]() { return m_Stop || m_Completed < m_Submitted; });
+				if (m_Completed == m_Submitted)
+					return;
+				packet = &m_Packets[m_Completed % m_FrameLatency];
+			}
+
+			Execute(*packet);
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Completed++;
+			}
+			m_PacketDone.notify_all();
+		}
+	}
+
+	void FramePipeline::StartRenderThread() {
+		m_Stop = false;
+		m_Submitted = 0;
+		m_Completed = 0;
+		m_Thread = std::thread(&FramePipeline::RenderThread, this);
+	}
+
+	void FramePipeline::StopRenderThread() {
+		if (!m_Thread.joinable())
+			return;
+		{
+			// The render thread finishes what was submitted before it leaves
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_PacketReady.notify_one();
+		m_Thread.join();
+		m_Submitted = 0;
+		m_Completed = 0;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "engine/graphicsapi.h"
+#include "engine/render/commandbuffer.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace prev {
+
+	// Everything the render side needs from one simulated frame
+	// Between GraphicsAPI::StartFrame and EndFrame the queue is sorted and submitted, then the render commands run in order
+	// On the render thread when pipelined
+	struct FramePacket {
+		unsigned long long FrameIndex = 0;
+		float DeltaTime = 0.0f;
+		bool Deferred = false;		// Commands run after the next frame has started simulating, copy what they read
+		RenderQueue Queue;
+		std::vector<std::function<void()>> RenderCommands;
+	};
+
+	// Frame latency 1 : StartFrame / commands / EndFrame run inline, like before
+	// Frame latency 2 or 3 : a render thread presents frame N while the main thread simulates N + 1 (and N + 2)
+	class FramePipeline {
+	public:
+		static const unsigned int MaxFrameLatency = 3;
+
+		// Workers of the job system record into the packets' queues without a lock
+		FramePipeline(GraphicsAPI * graphicsAPI, JobSystem * jobSystem = nullptr);
+		~FramePipeline();
+
+		FramePipeline(const FramePipeline &) = delete;
+		FramePipeline & operator=(const FramePipeline &) = delete;
+
+		// Only between frames, waits for the render thread to go idle first
+		void SetFrameLatency(unsigned int frameLatency);
+		inline unsigned int GetFrameLatency() const { return m_FrameLatency; }
+
+		// Waits until the packet slot is free again (frame N - latency presented)
+		FramePacket & BeginPacket(unsigned long long frameIndex, float deltaTime);
+		// Runs the packet inline or hands it to the render thread
+		void SubmitPacket();
+
+		// Fence : returns once every submitted frame has been presented
+		void WaitIdle();
+		// Fence : returns once the given frame has been presented
+		void WaitForFrame(unsigned long long frameIndex);
+		inline unsigned long long GetSubmittedCount() const { return m_Submitted; }
+	private:
+		void Execute(FramePacket & packet);
+		void RenderThread();
+		void StartRenderThread();
+		void StopRenderThread();
+	private:
+		GraphicsAPI * m_GraphicsAPI;
+		unsigned int m_FrameLatency = 1;
+
+		FramePacket m_Packets[MaxFrameLatency];
+		// Frames submitted / frames the render thread finished
+		unsigned long long m_Submitted = 0;
+		unsigned long long m_Completed = 0;
+		unsigned long long m_LastFrameIndex = 0;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_PacketReady;
+		std::condition_variable m_PacketDone;
+		bool m_Stop = false;
+		std::thread m_Thread;
+	};
+
+}
\ No newline at end of file
@@ -5,13 +5,20 @@ namespace prev {
 
 #if defined(PV_RENDERING_API_OPENGL) || defined(PV_RENDERING_API_DIRECTX)
 	GraphicsAPI * GraphicsAPI::Create(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc, RenderingAPI renderingAPI) {
+		// Null and software apis have no dependencies so they are always available
+		if (renderingAPI == RenderingAPI::RENDERING_API_NULL) {
+			return UseNull(windowRawPointer, windowApi, graphicsDesc);
+		}
+		if (renderingAPI == RenderingAPI::RENDERING_API_SOFTWARE) {
+			return UseSoftware(windowRawPointer, windowApi, graphicsDesc);
+		}
 	#ifdef PV_RENDERING_API_OPENGL
-		if (windowingAPI != WindowAPI::WINDOWING_API_WIN32) {
+		if (renderingAPI != RenderingAPI::RENDERING_API_OPENGL) {
 			PV_POST_ERROR("Cannot use DirectX when PV_RENDERING_API_DIRECTX is not defined!\nUsing OpenGL instead");
 		}
 		return UseOpenGL(windowRawPointer, windowApi, graphicsDesc);
 	#else
-		if (windowingAPI != WindowAPI::WINDOWING_API_WIN32) {
+		if (renderingAPI != RenderingAPI::RENDERING_API_DIRECTX) {
 			PV_POST_ERROR("Cannot use OpenGL when PV_RENDERING_API_OPENGL is not defined!\nUsing DirectX instead");
 		}
 		return UseDirectX(windowRawPointer, windowApi, graphicsDesc);
@@ -23,21 +30,38 @@ namespace prev {
 			return UseOpenGL(windowRawPointer, windowApi, graphicsDesc);
 		} else if (renderingAPI == RenderingAPI::RENDERING_API_DIRECTX) {
 			return UseDirectX(windowRawPointer, windowApi, graphicsDesc);
+		} else if (renderingAPI == RenderingAPI::RENDERING_API_NULL) {
+			return UseNull(windowRawPointer, windowApi, graphicsDesc);
+		} else if (renderingAPI == RenderingAPI::RENDERING_API_SOFTWARE) {
+			return UseSoftware(windowRawPointer, windowApi, graphicsDesc);
 		} else {
 			PV_POST_FATAL("Please Pass a valid rendering api\n"
 						  "For OpenGL use RENDERING_API_OPENGL\n"
-						  "For DirectX 11 use RENDERING_API_DIRECTX\n");
+						  "For DirectX 11 use RENDERING_API_DIRECTX\n"
+						  "For no rendering use RENDERING_API_NULL\n"
+						  "For rendering on the CPU use RENDERING_API_SOFTWARE\n");
 			return nullptr;
 		}
 	}
+#elif defined(PV_RENDERING_API_NULL)
+	GraphicsAPI * GraphicsAPI::Create(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc, RenderingAPI renderingAPI) {
+		if (renderingAPI == RenderingAPI::RENDERING_API_SOFTWARE) {
+			return UseSoftware(windowRawPointer, windowApi, graphicsDesc);
+		}
+		if (renderingAPI != RenderingAPI::RENDERING_API_NULL) {
+			PV_POST_WARN("Only the null and software apis are available when PV_RENDERING_API_NULL is defined!\nUsing null api instead");
+		}
+		return UseNull(windowRawPointer, windowApi, graphicsDesc);
+	}
 #else
 	GraphicsAPI * GraphicsAPI::Create(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc, RenderingAPI renderingAPI) {
 		PV_POST_FATAL("Please Define the rendering api symbols\n"
 					  "For OpenGL use PV_RENDERING_API_OPENGL\n"
 					  "For DirectX 11 use PV_RENDERING_API_DIRECTX\n"
+					  "For no rendering use PV_RENDERING_API_NULL\n"
 					  "To Compile both use PV_RENDERING_API_BOTH");
+		return nullptr;
 	}
-}
 #endif
 
 }
\ No newline at end of file
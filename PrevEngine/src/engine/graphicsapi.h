@@ -1,12 +1,18 @@
 #pragma once
 
 #include "engine/window.h"
+#include "engine/render/statecache.h"
 
 namespace prev {
 
+	class RenderQueue;
+	class JobSystem;
+
 	enum class RenderingAPI {
 		RENDERING_API_DIRECTX,
 		RENDERING_API_OPENGL,
+		RENDERING_API_NULL,	 // No GPU calls, frames are only CPU work
+		RENDERING_API_SOFTWARE, // Rasterized on the CPU into a framebuffer that can be read back
 		RENDERING_API_UNINIT // Uninitialized
 	};
 
@@ -18,6 +24,7 @@ namespace prev {
 		unsigned int Height;
 		bool Vsync;
 		bool Fullscreen;
+		JobSystem * Jobs = nullptr; // For backends that spread their work over the job system (software)
 	};
 
 	class GraphicsAPI {
@@ -31,16 +38,28 @@ namespace prev {
 
 		virtual void OnEvent(Event & e) { };
 		virtual void SetFullscreen(bool fullscreen) { };
+		// StartFrame and EndFrame may be called from a render thread (see FramePipeline)
+		virtual bool SupportsRenderThread() const { return true; }
+		// Runs a sorted queue, between StartFrame and EndFrame
+		virtual void Submit(const RenderQueue & queue) { }
+
+		// State changes the last submitted frame made and the ones it skipped, from any thread
+		inline RenderStateCounters GetStateCounters() const { return m_StateCache.GetLastFrame(); }
 	public:
 		RenderingAPI m_RenderingAPI = RenderingAPI::RENDERING_API_UNINIT;
 	protected:
 		GraphicsAPI() { }
+	protected:
+		// Backends bind through it in Submit, invalidate it whenever the device state is changed behind its back
+		RenderStateCache m_StateCache;
 	protected:
 		// To get window raw pointer use GetRawPointer method in Window class
 		static GraphicsAPI * UseDirectX(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc);
 		static GraphicsAPI * UseOpenGL(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc);
+		static GraphicsAPI * UseNull(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc);
+		static GraphicsAPI * UseSoftware(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc);
 	private:
-		static GraphicsAPI * GraphicsAPI::Create(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc, RenderingAPI renderingAPI);
+		static GraphicsAPI * Create(void * windowRawPointer, WindowAPI windowApi, GraphicsDesc & graphicsDesc, RenderingAPI renderingAPI);
 	};
 
 }
@@ -7,6 +7,8 @@ struct AppConsole {
 
 	using CmdParam = const std::vector<std::string> &;
 	using CmdFunc = std::function<void(CmdParam)>;
+	// Scrollback is what grows, so that's what counts as console memory
+	using ConsoleItems = prev::TaggedVector<prev::TaggedString<prev::MemTag::Console>, prev::MemTag::Console>;
 
 	struct Command {
 		std::string		CommandName;
@@ -15,7 +17,7 @@ struct AppConsole {
 	};
 
 	std::array<char, 256>		InputBuf;
-	std::vector<std::string>	Items;
+	ConsoleItems				Items;
 	std::vector<Command>		Commands;
 	std::vector<std::string>	History;
 	int							HistoryPos;    // -1: new line, 0..History.Size-1 browsing history.
@@ -5,6 +5,7 @@
 namespace prev {
 
 	class ImGuiConsole : public Layer {
+		PV_LAYER_HOOKS(ImGuiConsole)
 	public:
 		ImGuiConsole();
 		~ImGuiConsole();
@@ -0,0 +1,55 @@
+#include "pch.h"
+#include "imguiframestats.h"
+
+#include "engine/essentials/framestats.h"
+
+#include <imgui.h>
+
+namespace prev {
+
+	static bool s_IsVisible = true;
+
+	ImGuiFrameStats::ImGuiFrameStats() : Layer("IMGUI_FRAME_STATS_LAYER") {
+	}
+
+	void ImGuiFrameStats::OnImGuiUpdate() {
+		if (!s_IsVisible)
+			return;
+
+		const float padding = 10.0f;
+		ImGuiIO & io = ImGui::GetIO();
+		ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x - padding, padding), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+		ImGui::SetNextWindowBgAlpha(0.35f);
+		ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings |
+			ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+		if (!ImGui::Begin("Frame Stats", nullptr, flags)) {
+			ImGui::End();
+			return;
+		}
+
+		// Scale to the worst recent frame so hitches stand out, but never below 60 fps
+		FrameTimeStats recent = FrameStats::GetStats(0);
+		float scaleMax = std::max(recent.MaxMs * 1.1f, 16.7f);
+		char overlay[32];
+		std::snprintf(overlay, sizeof(overlay), "%.2f ms", recent.P50Ms);
+		ImGui::PlotLines("##FrameTimes", FrameStats::GetHistory(), FrameStats::HistorySize, FrameStats::GetHistoryOffset(),
+						 overlay, 0.0f, scaleMax, ImVec2(260.0f, 50.0f));
+
+		ImGui::Text("%7s %6s %6s %6s %6s %6s %4s", "frames", "p50", "p95", "p99", "p99.9", "max", "hitch");
+		for (unsigned int i = 0; i < FrameStats::GetWindowCount(); i++) {
+			FrameTimeStats stats = FrameStats::GetStats(i);
+			ImGui::Text("%7u %6.2f %6.2f %6.2f %6.2f %6.2f %4u", stats.WindowFrames, stats.P50Ms, stats.P95Ms, stats.P99Ms, stats.P999Ms, stats.MaxMs, stats.Hitches);
+		}
+
+		ImGui::End();
+	}
+
+	void ImGuiFrameStats::SetVisible(bool visible) {
+		s_IsVisible = visible;
+	}
+
+	bool ImGuiFrameStats::IsVisible() {
+		return s_IsVisible;
+	}
+
+}
\ No newline at end of file
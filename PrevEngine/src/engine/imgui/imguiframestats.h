@@ -0,0 +1,18 @@
+#pragma once
+
+#include "engine/layer/layer.h"
+
+namespace prev {
+
+	// Small frame time graph with the percentiles of every FrameStats window, top right corner
+	class ImGuiFrameStats : public Layer {
+		PV_LAYER_HOOKS(ImGuiFrameStats)
+	public:
+		ImGuiFrameStats();
+		virtual void OnImGuiUpdate() override;
+
+		static void SetVisible(bool visible);
+		static bool IsVisible();
+	};
+
+}
\ No newline at end of file
@@ -22,12 +22,41 @@
 
 namespace prev {
 
+	// Copy of a frame's draw lists, so the render thread can draw them while the next frame is being built
+	struct ImGuiLayer::DrawSnapshot {
+		ImDrawData DrawData;
+		std::vector<ImDrawList *> Lists;
+
+		~DrawSnapshot() {
+			Clear();
+		}
+
+		void Clear() {
+			for (ImDrawList * list : Lists)
+				IM_DELETE(list);
+			Lists.clear();
+		}
+
+		void Copy(const ImDrawData * drawData) {
+			Clear();
+			DrawData = *drawData;
+			for (int i = 0; i < drawData->CmdListsCount; i++)
+				Lists.push_back(drawData->CmdLists[i]->CloneOutput());
+			DrawData.CmdLists = Lists.data();
+		}
+	};
+
 	ImGuiLayer::ImGuiLayer(WindowAPI windowAPI, RenderingAPI graphicsAPI) {
 
 		m_WindowAPI = windowAPI;
 		m_GraphicsAPI = graphicsAPI;
+		m_Snapshots = std::make_unique<DrawSnapshot[]>(FramePipeline::MaxFrameLatency);
 
 		IMGUI_CHECKVERSION();
+	#ifdef PV_MEMORY_TRACKING_ENABLED
+		// Before the context, so everything ImGui owns is counted under MemTag::ImGui
+		ImGui::SetAllocatorFunctions(&MemoryTracker::ImGuiAlloc, &MemoryTracker::ImGuiFree);
+	#endif
 		ImGui::CreateContext();
 		ImGuiIO & io = ImGui::GetIO(); (void)io;
 		io.ConfigFlags		|= ImGuiConfigFlags_NavEnableKeyboard;
@@ -59,6 +88,13 @@ namespace prev {
 			}
 		#endif
 
+		if (m_GraphicsAPI == RenderingAPI::RENDERING_API_NULL || m_GraphicsAPI == RenderingAPI::RENDERING_API_SOFTWARE) {
+			// No renderer backend to upload the font atlas, so just build it on the cpu for NewFrame
+			unsigned char * pixels;
+			int width, height;
+			io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+		}
+
 		{
 			io.KeyMap[ImGuiKey_Tab]			= PV_KEYBOARD_KEY_TAB;
 			io.KeyMap[ImGuiKey_LeftArrow]	= PV_KEYBOARD_KEY_LEFT;
@@ -102,26 +138,45 @@ namespace prev {
 				ImGui_ImplOpenGL3_Shutdown();
 			}
 		#endif
+		// Cloned draw lists belong to the ImGui allocator
+		m_Snapshots.reset();
 		ImGui::DestroyContext();
 	}
 
-	void ImGuiLayer::EndFrame() {
+	void ImGuiLayer::EndFrame(FramePacket & packet) {
+		PV_PROFILE_SCOPE("ImGuiLayer::EndFrame");
 		ImGui::EndFrame();
 		ImGui::Render();
+
+		ImDrawData * drawData = ImGui::GetDrawData();
+		if (packet.Deferred) {
+			// One snapshot per frame that can be in flight
+			DrawSnapshot & snapshot = m_Snapshots[m_NextSnapshot++ % FramePipeline::MaxFrameLatency];
+			snapshot.Copy(drawData);
+			drawData = &snapshot.DrawData;
+		}
+		packet.RenderCommands.push_back([this, drawData]() -> void {
+			RenderDrawData(drawData);
+		});
+	}
+
+	void ImGuiLayer::RenderDrawData(ImDrawData * drawData) {
+		PV_PROFILE_SCOPE("ImGuiLayer::RenderDrawData");
 		#if defined(PV_RENDERING_API_DIRECTX) || defined(PV_RENDERING_API_BOTH)
 			if (m_GraphicsAPI == RenderingAPI::RENDERING_API_DIRECTX) {
-				ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+				ImGui_ImplDX11_RenderDrawData(drawData);
 			}
 		#endif
 
 		#if defined(PV_RENDERING_API_OPENGL) || defined(PV_RENDERING_API_BOTH)
 			if (m_GraphicsAPI == RenderingAPI::RENDERING_API_OPENGL) {
-				ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+				ImGui_ImplOpenGL3_RenderDrawData(drawData);
 			}
 		#endif
 	}
 
 	void ImGuiLayer::StartFrame() {
+		PV_PROFILE_SCOPE("ImGuiLayer::StartFrame");
 		ImGuiIO & io = ImGui::GetIO();
 		io.DeltaTime = Timer::GetDeltaTime();
 		io.DisplaySize.x = (float)m_WinSizeX;
@@ -143,15 +198,17 @@ namespace prev {
 	}
 
 	void ImGuiLayer::OnEvent(Event & event) {
+		PV_PROFILE_SCOPE("ImGuiLayer::OnEvent");
 		EventDispatcher dispatcher(event);
-		dispatcher.Dispatch<MouseMovedEvent>(BIND_EVENT_FN(ImGuiLayer::MouseMoved));
-		dispatcher.Dispatch<MouseButtonPressedEvent>(BIND_EVENT_FN(ImGuiLayer::MouseButtonPressed));
-		dispatcher.Dispatch<MouseButtonReleasedEvent>(BIND_EVENT_FN(ImGuiLayer::MouseButtonReleased));
-		dispatcher.Dispatch<MouseScrolledEvent>(BIND_EVENT_FN(ImGuiLayer::MouseScrolled));
-		dispatcher.Dispatch<KeyPressedEvent>(BIND_EVENT_FN(ImGuiLayer::KeyPressed));
-		dispatcher.Dispatch<KeyReleasedEvent>(BIND_EVENT_FN(ImGuiLayer::KeyReleased));
-		dispatcher.Dispatch<CharacterEvent>(BIND_EVENT_FN(ImGuiLayer::CharacterInputEvent));
-		dispatcher.Dispatch<WindowResizeEvent>(BIND_EVENT_FN(ImGuiLayer::WindowSizeChanged));
+		dispatcher.Dispatch(this,
+							&ImGuiLayer::MouseMoved,
+							&ImGuiLayer::MouseButtonPressed,
+							&ImGuiLayer::MouseButtonReleased,
+							&ImGuiLayer::MouseScrolled,
+							&ImGuiLayer::KeyPressed,
+							&ImGuiLayer::KeyReleased,
+							&ImGuiLayer::CharacterInputEvent,
+							&ImGuiLayer::WindowSizeChanged);
 	}
 
 	bool ImGuiLayer::MouseMoved(MouseMovedEvent & e) {
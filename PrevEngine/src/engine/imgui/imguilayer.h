@@ -3,10 +3,13 @@
 #include "engine/layer/layer.h"
 #include "engine/window.h"
 #include "engine/graphicsapi.h"
+#include "engine/framepipeline.h"
 
 // Use this macro for ImGui calls, so that you can easily disable them
 #define IMGUI_CALL(...) __VA_ARGS__;
 
+struct ImDrawData;
+
 namespace prev {
 
 	class ImGuiLayer {
@@ -16,12 +19,18 @@ namespace prev {
 		~ImGuiLayer();
 	private:
 		void StartFrame();
-		void EndFrame();
+		// Adds the ImGui draw to the packet, deferred packets get a copy of the draw data
+		void EndFrame(FramePacket & packet);
 		void OnEvent(Event & event);
+		void RenderDrawData(ImDrawData * drawData);
 	private:
 		WindowAPI m_WindowAPI;
 		RenderingAPI m_GraphicsAPI;
 		unsigned int m_WinSizeX, m_WinSizeY;
+
+		struct DrawSnapshot;
+		std::unique_ptr<DrawSnapshot[]> m_Snapshots;
+		unsigned int m_NextSnapshot = 0;
 	private:
 		bool MouseMoved(MouseMovedEvent & e);
 		bool KeyPressed(KeyPressedEvent & e);
@@ -4,28 +4,75 @@
 #include <imgui.h>
 
 
+// Keeps the last MaxLines messages (or less if the text doesn't fit in TextCapacity)
+// Text lives in a ring arena, lines only store where their text is, nothing is allocated after construction
 struct ImGuiAppLog {
 private:
-	struct MessageLog {
-		std::string m_Message;
-		prev::LogLevel m_Level;
+	static const unsigned int MaxLines = 16384;
+	static const unsigned int TextCapacity = 1 << 20;
+	static const unsigned int MaxLineLength = 4096;
+	static const unsigned int LevelCount = 4;
+
+	struct LogLine {
+		unsigned int Offset;
+		unsigned int Length;
+		prev::LogLevel Level;
 	};
 
 public:
-	std::vector<MessageLog> Messages;
 	ImGuiTextFilter			Filter;
 	bool					ScrollToBottom, check;
+	std::array<bool, LevelCount> ShowLevel;
+
+	ImGuiAppLog() {
+		Text.resize(TextCapacity);
+		Lines.resize(MaxLines);
+		Filtered.resize(MaxLines);
+		ShowLevel.fill(true);
+		ScrollToBottom = true;
+		check = false;
+		Clear();
+	}
 
 	void Clear() {
-		Messages.clear();
+		TextHead = 0;
+		FirstLine = NextLine = 0;
+		FilteredBegin = FilteredEnd = 0;
+		LevelCounts.fill(0);
 	}
 
-	void AddLog(prev::LogLevel level, std::string message) {
-		Messages.push_back({ message, level });
+	void AddLog(prev::LogLevel level, std::string_view message) {
+		unsigned int length = (unsigned int)std::min<size_t>(message.size(), MaxLineLength);
+
+		// Not enough room before the end of the arena, start over from the front
+		// Lines still living in the tail we skip are the oldest ones, drop them
+		if (TextHead + length > TextCapacity) {
+			while (NextLine != FirstLine && GetLine(FirstLine).Offset >= TextHead)
+				PopOldest();
+			TextHead = 0;
+		}
+
+		// Everything at or after TextHead is from the previous pass over the arena, so older than anything before it
+		while (NextLine != FirstLine && (NextLine - FirstLine == MaxLines ||
+			   (GetLine(FirstLine).Offset >= TextHead && GetLine(FirstLine).Offset < TextHead + length)))
+			PopOldest();
+
+		std::memcpy(&Text[TextHead], message.data(), length);
+		LogLine & line = Lines[NextLine % MaxLines];
+		line.Offset = TextHead;
+		line.Length = length;
+		line.Level = level;
+		TextHead += length;
+		LevelCounts[(int)level]++;
+
+		if (PassFilter(line))
+			Filtered[FilteredEnd++ % MaxLines] = NextLine;
+		NextLine++;
+
 		check = true;
 	}
 
-	void Draw(const char * title, std::map<prev::LogLevel, ImVec4> & colors, bool * p_open = NULL) {
+	void Draw(const char * title, const std::array<ImVec4, LevelCount> & colors, bool * p_open = NULL) {
 		ImGui::SetNextWindowSize(ImVec2(500, 400), ImGuiCond_FirstUseEver);
 		if (!ImGui::Begin(title, p_open)) {
 			ImGui::End();
@@ -35,7 +82,7 @@ public:
 		ImGui::SameLine();
 		bool copy = ImGui::Button("Copy");
 		ImGui::SameLine();
-		Filter.Draw("Filter", -100.0f);
+		bool filterChanged = Filter.Draw("Filter", -100.0f);
 		ImGui::NewLine();
 		ImGui::Checkbox("Auto Scroll", &ScrollToBottom);
 		ImGui::SameLine();
@@ -44,25 +91,44 @@ public:
 			showFPSinLog = !showFPSinLog;
 			prev::Timer::FPSCounter(showFPSinLog);
 		}
+
+		static const char * levelNames[LevelCount] = { "Info", "Warn", "Error", "Fatal" };
+		for (unsigned int i = 0; i < LevelCount; i++) {
+			char label[32];
+			std::snprintf(label, sizeof(label), "%s (%u)", levelNames[i], LevelCounts[i]);
+			ImGui::PushStyleColor(ImGuiCol_Text, colors[i]);
+			filterChanged |= ImGui::Checkbox(label, &ShowLevel[i]);
+			ImGui::PopStyleColor();
+			if (i + 1 < LevelCount)
+				ImGui::SameLine();
+		}
+
+		if (filterChanged)
+			RebuildFilter();
+
 		ImGui::Separator();
 		ImGui::BeginChild("scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
-		if (copy)
-			ImGui::LogToClipboard();
 
 		ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
 
-		if (Filter.IsActive()) {
-			for (auto & message : Messages) {
-				if (Filter.PassFilter(message.m_Message.c_str())) {
-					ImGui::PushStyleColor(ImGuiCol_Text, colors[message.m_Level]);
-					ImGui::TextUnformatted(message.m_Message.c_str());
-					ImGui::PopStyleColor();
-				}
+		if (copy) {
+			// Copy everything that passes the filter, not just the rows on screen
+			ImGui::LogToClipboard();
+			for (unsigned long long i = FilteredBegin; i < FilteredEnd; i++) {
+				const LogLine & line = GetLine(Filtered[i % MaxLines]);
+				ImGui::LogText("%.*s\n", (int)line.Length, &Text[line.Offset]);
 			}
-		} else {
-			for (auto & message : Messages) {
-				ImGui::PushStyleColor(ImGuiCol_Text, colors[message.m_Level]);
-				ImGui::TextUnformatted(message.m_Message.c_str());
+			ImGui::LogFinish();
+		}
+
+		// Only the visible rows are submitted, cost doesn't depend on how long the session has been running
+		ImGuiListClipper clipper((int)(FilteredEnd - FilteredBegin));
+		while (clipper.Step()) {
+			for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+				const LogLine & line = GetLine(Filtered[(FilteredBegin + row) % MaxLines]);
+				const char * text = &Text[line.Offset];
+				ImGui::PushStyleColor(ImGuiCol_Text, colors[(int)line.Level]);
+				ImGui::TextUnformatted(text, text + line.Length);
 				ImGui::PopStyleColor();
 			}
 		}
@@ -76,24 +142,63 @@ public:
 		ImGui::EndChild();
 		ImGui::End();
 	}
+private:
+	inline LogLine & GetLine(unsigned long long lineId) {
+		return Lines[lineId % MaxLines];
+	}
+
+	bool PassFilter(const LogLine & line) {
+		if (!ShowLevel[(int)line.Level])
+			return false;
+		if (!Filter.IsActive())
+			return true;
+		const char * text = &Text[line.Offset];
+		return Filter.PassFilter(text, text + line.Length);
+	}
+
+	void PopOldest() {
+		LevelCounts[(int)GetLine(FirstLine).Level]--;
+		if (FilteredBegin != FilteredEnd && Filtered[FilteredBegin % MaxLines] == FirstLine)
+			FilteredBegin++;
+		FirstLine++;
+	}
+
+	// Only when the filter changes, new lines are filtered as they come in
+	void RebuildFilter() {
+		FilteredBegin = FilteredEnd = 0;
+		for (unsigned long long i = FirstLine; i < NextLine; i++) {
+			if (PassFilter(GetLine(i)))
+				Filtered[FilteredEnd++ % MaxLines] = i;
+		}
+	}
+private:
+	prev::TaggedVector<char, prev::MemTag::Log> Text;
+	unsigned int TextHead;
+
+	prev::TaggedVector<LogLine, prev::MemTag::Log> Lines;
+	unsigned long long FirstLine, NextLine;		// Ids of the oldest line and the next line to be added
+
+	prev::TaggedVector<unsigned long long, prev::MemTag::Log> Filtered;	// Ring of line ids that pass the filter
+	unsigned long long FilteredBegin, FilteredEnd;
+
+	std::array<unsigned int, LevelCount> LevelCounts;
 };
 
 namespace prev {
 
-	std::function<void(std::string, LogLevel)> Log::m_LogFunction;
 	static bool is_logging = true;
-	static std::map<LogLevel, ImVec4> m_LogColors;
+	static std::array<ImVec4, 4> m_LogColors;
 	static ImGuiAppLog log;
 
 	ImGuiLogger::ImGuiLogger() : Layer("IMGUI_LOGGER_LAYER") {
 		{
-			m_LogColors[LogLevel::PV_INFO] = ImVec4(0, 1, 0, 1);
-			m_LogColors[LogLevel::PV_WARN] = ImVec4(1, 1, 0, 1);
-			m_LogColors[LogLevel::PV_ERROR] = ImVec4(1, 0, 0, 1);
-			m_LogColors[LogLevel::PV_FATAL] = ImVec4(1, 0, 1, 1);
+			m_LogColors[(int)LogLevel::PV_INFO] = ImVec4(0, 1, 0, 1);
+			m_LogColors[(int)LogLevel::PV_WARN] = ImVec4(1, 1, 0, 1);
+			m_LogColors[(int)LogLevel::PV_ERROR] = ImVec4(1, 0, 0, 1);
+			m_LogColors[(int)LogLevel::PV_FATAL] = ImVec4(1, 0, 1, 1);
 		}
 
-		Log::m_LogFunction = [](std::string s, LogLevel level) -> void {
+		Log::m_LogFunction = [](std::string_view s, LogLevel level) -> void {
 			log.AddLog(level, s);
 		};
 
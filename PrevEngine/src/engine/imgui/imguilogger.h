@@ -3,6 +3,7 @@
 namespace prev {
 
 	class ImGuiLogger : public Layer {
+		PV_LAYER_HOOKS(ImGuiLogger)
 	public:
 		ImGuiLogger();
 		virtual void OnImGuiUpdate() override;
@@ -0,0 +1,76 @@
+#include "pch.h"
+#include "imguimemory.h"
+
+#ifdef PV_MEMORY_TRACKING_ENABLED
+
+#include <imgui.h>
+
+namespace prev {
+
+	static bool s_IsVisible = true;
+
+	ImGuiMemory::ImGuiMemory() : Layer("IMGUI_MEMORY_LAYER") {
+	}
+
+	void ImGuiMemory::OnImGuiUpdate() {
+		MemTagStats total = MemoryTracker::GetTotalStats();
+		m_History[m_HistoryOffset] = (float)(total.LiveBytes / (1024.0 * 1024.0));
+		m_HistoryOffset = (m_HistoryOffset + 1) % HistorySize;
+
+		if (!s_IsVisible)
+			return;
+
+		ImGui::SetNextWindowSize(ImVec2(520, 260), ImGuiCond_FirstUseEver);
+		if (!ImGui::Begin("Memory", &s_IsVisible)) {
+			ImGui::End();
+			return;
+		}
+
+		float scaleMax = *std::max_element(m_History.begin(), m_History.end()) * 1.1f;
+		char overlay[32];
+		std::snprintf(overlay, sizeof(overlay), "%.2f MB live", total.LiveBytes / (1024.0 * 1024.0));
+		ImGui::PlotLines("##MemoryHistory", m_History.data(), HistorySize, m_HistoryOffset, overlay, 0.0f, scaleMax, ImVec2(0.0f, 50.0f));
+
+		if (ImGui::Button("Reset Peaks"))
+			MemoryTracker::ResetPeaks();
+		ImGui::SameLine();
+		if (ImGui::Button("Log"))
+			MemoryTracker::LogStats();
+
+		ImGui::Separator();
+		ImGui::Columns(6, "MemoryTags");
+		ImGui::Text("Tag");			ImGui::NextColumn();
+		ImGui::Text("Live KB");		ImGui::NextColumn();
+		ImGui::Text("Peak KB");		ImGui::NextColumn();
+		ImGui::Text("Live");		ImGui::NextColumn();
+		ImGui::Text("Total");		ImGui::NextColumn();
+		ImGui::Text("Allocs/s");	ImGui::NextColumn();
+		ImGui::Separator();
+		for (unsigned int i = 0; i <= (unsigned int)MemTag::Count; i++) {
+			bool isTotal = i == (unsigned int)MemTag::Count;
+			MemTagStats stats = isTotal ? total : MemoryTracker::GetStats((MemTag)i);
+			if (isTotal)
+				ImGui::Separator();
+			ImGui::Text("%s", isTotal ? "Total" : MemoryTracker::GetTagName((MemTag)i));	ImGui::NextColumn();
+			ImGui::Text("%.1f", stats.LiveBytes / 1024.0);									ImGui::NextColumn();
+			ImGui::Text("%.1f", stats.PeakBytes / 1024.0);									ImGui::NextColumn();
+			ImGui::Text("%llu", stats.LiveAllocations);										ImGui::NextColumn();
+			ImGui::Text("%llu", stats.TotalAllocations);									ImGui::NextColumn();
+			ImGui::Text("%.1f", stats.AllocationsPerSecond);								ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+
+		ImGui::End();
+	}
+
+	void ImGuiMemory::SetVisible(bool visible) {
+		s_IsVisible = visible;
+	}
+
+	bool ImGuiMemory::IsVisible() {
+		return s_IsVisible;
+	}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "engine/layer/layer.h"
+#include "engine/memory/memorytracker.h"
+
+#ifdef PV_MEMORY_TRACKING_ENABLED
+
+namespace prev {
+
+	// Live bytes, peak, allocation count and rate of every MemTag, plus a graph of the total
+	class ImGuiMemory : public Layer {
+		PV_LAYER_HOOKS(ImGuiMemory)
+	public:
+		static const unsigned int HistorySize = 256;
+	public:
+		ImGuiMemory();
+		virtual void OnImGuiUpdate() override;
+
+		static void SetVisible(bool visible);
+		static bool IsVisible();
+	private:
+		std::array<float, HistorySize> m_History{};	// Total live MB, one sample per frame
+		unsigned int m_HistoryOffset = 0;
+	};
+
+}
+
+#endif
\ No newline at end of file
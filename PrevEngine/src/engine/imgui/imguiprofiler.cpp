@@ -0,0 +1,109 @@
+#include "pch.h"
+#include "imguiprofiler.h"
+
+#ifdef PV_PROFILER_ENABLED
+
+#include <imgui.h>
+
+namespace prev {
+
+	static bool s_IsOpen = true;
+	static float s_RowHeight = 18.0f;
+
+	// Same name gets the same color every frame
+	static ImU32 GetZoneColor(const char * name) {
+		unsigned int hash = 2166136261u;
+		for (const char * c = name; *c; c++)
+			hash = (hash ^ (unsigned char)*c) * 16777619u;
+		return IM_COL32(80 + (hash & 0x7F), 80 + ((hash >> 8) & 0x7F), 80 + ((hash >> 16) & 0x7F), 255);
+	}
+
+	ImGuiProfiler::ImGuiProfiler() : Layer("IMGUI_PROFILER_LAYER") {
+	}
+
+	void ImGuiProfiler::OnImGuiUpdate() {
+		if (!s_IsOpen)
+			return;
+
+		ImGui::SetNextWindowSize(ImVec2(800, 300), ImGuiCond_FirstUseEver);
+		if (!ImGui::Begin("Profiler", &s_IsOpen)) {
+			ImGui::End();
+			return;
+		}
+
+		const ProfileFrame & frame = Profiler::GetLastFrame();
+
+		bool paused = Profiler::IsPaused();
+		if (ImGui::Checkbox("Pause", &paused))
+			Profiler::SetPaused(paused);
+		ImGui::SameLine();
+		ImGui::Text("Frame %llu : %.3f ms, %u zones", frame.FrameIndex, frame.GetDurationMs(), frame.ZoneCount);
+		ImGui::Separator();
+
+		if (frame.End <= frame.Start) {
+			ImGui::End();
+			return;
+		}
+
+		ImGui::BeginChild("FlameGraph", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+
+		ImDrawList * drawList = ImGui::GetWindowDrawList();
+		ImVec2 origin = ImGui::GetCursorScreenPos();
+		float width = ImGui::GetContentRegionAvail().x;
+		float scale = width / (float)(frame.End - frame.Start);
+
+		// One band per thread, one row per depth inside a band
+		std::array<unsigned int, Profiler::MaxThreads> bandDepth;
+		bandDepth.fill(0);
+		for (unsigned int i = 0; i < frame.ZoneCount; i++) {
+			const ProfileZoneNode & zone = frame.Zones[i];
+			if (zone.Depth + 1u > bandDepth[zone.ThreadIndex])
+				bandDepth[zone.ThreadIndex] = zone.Depth + 1u;
+		}
+
+		std::array<float, Profiler::MaxThreads> bandOffset;
+		float y = 0.0f;
+		for (unsigned int t = 0; t < Profiler::MaxThreads; t++) {
+			bandOffset[t] = y;
+			if (bandDepth[t] == 0)
+				continue;
+			drawList->AddText(ImVec2(origin.x, origin.y + y), ImGui::GetColorU32(ImGuiCol_Text), Profiler::GetThreadName(t));
+			bandOffset[t] = y + s_RowHeight;
+			y += s_RowHeight * (bandDepth[t] + 1);
+		}
+
+		const ProfileZoneNode * hovered = nullptr;
+		for (unsigned int i = 0; i < frame.ZoneCount; i++) {
+			const ProfileZoneNode & zone = frame.Zones[i];
+			// Zones that began in an earlier frame are cut at the start of this one
+			ImVec2 min(origin.x + std::max(zone.Start, 0ll) * scale, origin.y + bandOffset[zone.ThreadIndex] + zone.Depth * s_RowHeight);
+			ImVec2 max(origin.x + zone.End * scale, min.y + s_RowHeight - 1.0f);
+			if (max.x - min.x < 1.0f)
+				max.x = min.x + 1.0f;
+
+			drawList->AddRectFilled(min, max, GetZoneColor(zone.Name));
+			if (max.x - min.x > ImGui::CalcTextSize(zone.Name).x + 4.0f) {
+				drawList->AddText(ImVec2(min.x + 2.0f, min.y + 1.0f), IM_COL32(0, 0, 0, 255), zone.Name);
+			}
+			if (ImGui::IsMouseHoveringRect(min, max))
+				hovered = &zone;
+		}
+
+		ImGui::InvisibleButton("FlameGraphCanvas", ImVec2(width, y > 1.0f ? y : 1.0f));
+
+		if (hovered) {
+			ImGui::BeginTooltip();
+			ImGui::Text("%s", hovered->Name);
+			ImGui::Text("%.3f ms", (float)(hovered->End - hovered->Start) / 1000000.0f);
+			if (hovered->Parent >= 0)
+				ImGui::Text("In %s", frame.Zones[hovered->Parent].Name);
+			ImGui::EndTooltip();
+		}
+
+		ImGui::EndChild();
+		ImGui::End();
+	}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "engine/layer/layer.h"
+
+#ifdef PV_PROFILER_ENABLED
+
+namespace prev {
+
+	// Shows the last profiled frame as a flame graph
+	class ImGuiProfiler : public Layer {
+		PV_LAYER_HOOKS(ImGuiProfiler)
+	public:
+		ImGuiProfiler();
+		virtual void OnImGuiUpdate() override;
+	};
+
+}
+
+#endif
\ No newline at end of file
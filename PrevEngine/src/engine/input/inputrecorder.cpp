@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "inputrecorder.h"
+
+#include "platform/nullwindow.h"
+
+namespace prev {
+
+	static const char s_InputMagic[8] = { 'P', 'V', 'I', 'N', 'P', 'U', 'T', '1' };
+	static const std::uint32_t s_InputVersion = 1;
+
+	InputRecorder::~InputRecorder() {
+		Stop();
+	}
+
+	bool InputRecorder::Start(const std::string & filePath, std::uint64_t frameIndex) {
+		Stop();
+
+		m_File = std::fopen(filePath.c_str(), "wb");
+		if (m_File == nullptr) {
+			PV_LOG_ERROR("Unable to open input recording %s", filePath);
+			return false;
+		}
+
+		InputRecordHeader header = {};
+		std::memcpy(header.Magic, s_InputMagic, sizeof(header.Magic));
+		header.Version = s_InputVersion;
+		header.EntrySize = sizeof(InputRecordEntry);
+		std::fwrite(&header, sizeof(header), 1, m_File);
+
+		m_StartFrame = frameIndex;
+		m_RecordedCount = 0;
+		return true;
+	}
+
+	void InputRecorder::Stop() {
+		if (m_File == nullptr)
+			return;
+		std::fclose(m_File);
+		m_File = nullptr;
+		PV_LOG_INFO("Input recording stopped, %llu events", m_RecordedCount);
+	}
+
+	void InputRecorder::Record(std::uint64_t frameIndex, float time, Event & e) {
+		if (m_File == nullptr)
+			return;
+
+		InputRecordEntry entry = {};
+		entry.Frame = frameIndex - m_StartFrame;
+		entry.Time = time;
+		entry.Event = EventQueue::ToRecord(e);
+		std::fwrite(&entry, sizeof(entry), 1, m_File);
+		m_RecordedCount++;
+	}
+
+	bool InputReplay::Load(const std::string & filePath) {
+		std::FILE * file = std::fopen(filePath.c_str(), "rb");
+		if (file == nullptr) {
+			PV_LOG_ERROR("Unable to open input recording %s", filePath);
+			return false;
+		}
+
+		InputRecordHeader header;
+		if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.Magic, s_InputMagic, sizeof(header.Magic)) != 0 ||
+			header.Version != s_InputVersion || header.EntrySize != sizeof(InputRecordEntry)) {
+			PV_LOG_ERROR("%s is not an input recording from this build", filePath);
+			std::fclose(file);
+			return false;
+		}
+
+		m_Entries.clear();
+		InputRecordEntry entry;
+		while (std::fread(&entry, sizeof(entry), 1, file) == 1)
+			m_Entries.push_back(entry);
+		std::fclose(file);
+
+		m_Next = 0;
+		m_Frame = 0;
+		return true;
+	}
+
+	void InputReplay::Attach(NullWindow * window) {
+		m_Next = 0;
+		m_Frame = 0;
+		window->SetEventSource([this](std::function<void(Event & e)> & callback) -> void {
+			while (m_Next < m_Entries.size() && m_Entries[m_Next].Frame <= m_Frame) {
+				EventQueue::Rebuild(m_Entries[m_Next].Event, callback);
+				m_Next++;
+			}
+			m_Frame++;
+		});
+	}
+
+}
\ No newline at end of file
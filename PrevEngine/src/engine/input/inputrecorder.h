@@ -0,0 +1,58 @@
+#pragma once
+
+#include "engine/events/eventqueue.h"
+
+#include <cstdint>
+#include <cstdio>
+
+namespace prev {
+
+	class NullWindow;
+
+	// One recorded event, the file is a header followed by these back to back
+	// Written raw, so a capture is only meant to be replayed on the same platform
+	struct InputRecordEntry {
+		std::uint64_t Frame;	// Relative to the frame the recording started on
+		float Time;				// Timer::GetTime() when the event was handled
+		EventRecord Event;
+	};
+
+	struct InputRecordHeader {
+		char Magic[8];
+		std::uint32_t Version;
+		std::uint32_t EntrySize;
+	};
+
+	// Writes every event the application handles to a file
+	class InputRecorder {
+	public:
+		~InputRecorder();
+
+		bool Start(const std::string & filePath, std::uint64_t frameIndex);
+		void Stop();
+		inline bool IsRecording() const { return m_File != nullptr; }
+
+		void Record(std::uint64_t frameIndex, float time, Event & e);
+	private:
+		std::FILE * m_File = nullptr;
+		std::uint64_t m_StartFrame = 0;
+		unsigned long long m_RecordedCount = 0;
+	};
+
+	// Plays a recording back through the null window, each event on the frame it was recorded on
+	class InputReplay {
+	public:
+		bool Load(const std::string & filePath);
+		// Takes over the window's event source, frame 0 is the next Window::Update
+		void Attach(NullWindow * window);
+
+		inline bool IsFinished() const { return m_Next >= m_Entries.size(); }
+		inline size_t GetEventCount() const { return m_Entries.size(); }
+		inline std::uint64_t GetLastFrame() const { return m_Entries.empty() ? 0 : m_Entries.back().Frame; }
+	private:
+		std::vector<InputRecordEntry> m_Entries;
+		size_t m_Next = 0;
+		std::uint64_t m_Frame = 0;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "pch.h"
+#include "jobsystem.h"
+
+namespace prev {
+
+	const unsigned int JobSystem::MaxWorkers;
+
+	static thread_local JobSystem * t_JobSystem = nullptr;
+	static thread_local unsigned int t_WorkerIndex = 0;
+
+	// Idle workers spin this many times looking for work before going to sleep
+	static const unsigned int s_SpinCount = 64;
+
+	bool JobDeque::Push(Job * job) {
+		long long bottom = m_Bottom.load(std::memory_order_relaxed);
+		long long top = m_Top.load(std::memory_order_acquire);
+		if (bottom - top >= Capacity)
+			return false;
+
+		m_Jobs[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	Job * JobDeque::Pop() {
+		long long bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long top = m_Top.load(std::memory_order_relaxed);
+
+		if (top > bottom) {
+			// Empty
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job * job = m_Jobs[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+		if (top == bottom) {
+			// Last one, race the thieves for it
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	Job * JobDeque::Steal() {
+		long long top = m_Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long bottom = m_Bottom.load(std::memory_order_acquire);
+		if (top >= bottom)
+			return nullptr;
+
+		Job * job = m_Jobs[top & (Capacity - 1)].load(std::memory_order_relaxed);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return job;
+	}
+
+	JobSystem::JobSystem(unsigned int workerCount) {
+		if (workerCount == 0)
+			workerCount = std::thread::hardware_concurrency();
+		m_WorkerCount = std::min(std::max(workerCount, 1u), MaxWorkers);
+
+		m_Workers = std::make_unique<Worker[]>(m_WorkerCount);
+		for (unsigned int i = 0; i < m_WorkerCount; i++) {
+			m_Workers[i].Jobs = std::make_unique<Job[]>(Worker::JobCount);
+			m_Workers[i].Random = 0x9E3779B9u * (i + 1);
+		}
+
+		t_JobSystem = this;
+		t_WorkerIndex = 0;
+		for (unsigned int i = 1; i < m_WorkerCount; i++)
+			m_Workers[i].Thread = std::thread(&JobSystem::WorkerThread, this, i);
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_Stop.store(true);
+		}
+		m_WakeUp.notify_all();
+		for (unsigned int i = 1; i < m_WorkerCount; i++)
+			m_Workers[i].Thread.join();
+
+		if (t_JobSystem == this)
+			t_JobSystem = nullptr;
+	}
+
+	unsigned int JobSystem::GetWorkerIndex() const {
+		return t_JobSystem == this ? t_WorkerIndex : MaxWorkers;
+	}
+
+	Job * JobSystem::AllocateJob() {
+		// Only the owner allocates from its ring, a thief running a job from it clears the flag once it's done with the slot
+		Worker & worker = m_Workers[t_WorkerIndex];
+		Job * job = &worker.Jobs[worker.NextJob & (Worker::JobCount - 1)];
+		if (job->InFlight.load(std::memory_order_acquire))
+			return nullptr;
+		job->InFlight.store(true, std::memory_order_relaxed);
+		worker.NextJob++;
+		return job;
+	}
+
+	void JobSystem::Submit(Job * job) {
+		if (!m_Workers[t_WorkerIndex].Deque.Push(job)) {
+			// Deque is full, do it now rather than drop it
+			Execute(job);
+			return;
+		}
+
+		// seq_cst pairs with the sleeper bumping m_Sleeping then reading m_Generation
+		m_Generation.fetch_add(1);
+		if (m_Sleeping.load() > 0) {
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_WakeUp.notify_all();
+		}
+	}
+
+	void JobSystem::Execute(Job * job) {
+		JobCounter * counter = job->Counter;
+		job->Function(*job);
+		job->InFlight.store(false, std::memory_order_release);
+		if (counter != nullptr)
+			counter->Value.fetch_sub(1, std::memory_order_release);
+	}
+
+	bool JobSystem::RunOne(unsigned int workerIndex) {
+		Worker & worker = m_Workers[workerIndex];
+		Job * job = worker.Deque.Pop();
+
+		if (job == nullptr && m_WorkerCount > 1) {
+			// Steal from a random victim, then walk the rest
+			worker.Random ^= worker.Random << 13;
+			worker.Random ^= worker.Random >> 17;
+			worker.Random ^= worker.Random << 5;
+			unsigned int start = worker.Random % m_WorkerCount;
+			for (unsigned int i = 0; i < m_WorkerCount && job == nullptr; i++) {
+				unsigned int victim = (start + i) % m_WorkerCount;
+				if (victim != workerIndex)
+					job = m_Workers[victim].Deque.Steal();
+			}
+		}
+
+		if (job == nullptr)
+			return false;
+		Execute(job);
+		return true;
+	}
+
+	void JobSystem::Wait(JobCounter & counter) {
+		unsigned int workerIndex = GetWorkerIndex();
+		while (!counter.IsDone()) {
+			if (workerIndex == MaxWorkers || !RunOne(workerIndex))
+				std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::WorkerThread(unsigned int workerIndex) {
+		t_JobSystem = this;
+		t_WorkerIndex = workerIndex;
+
+	#ifdef PV_PROFILER_ENABLED
+		static char names[MaxWorkers][16];
+		std::snprintf(names[workerIndex], sizeof(names[workerIndex]), "Worker %u", workerIndex);
+		Profiler::SetThreadName(names[workerIndex]);
+	#endif
+
+		unsigned int idle = 0;
+		while (!m_Stop.load(std::memory_order_relaxed)) {
+			if (RunOne(workerIndex)) {
+				idle = 0;
+				continue;
+			}
+			if (++idle < s_SpinCount) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			// Sleep until something gets submitted, checking the generation under the lock so no wake up is lost
+			unsigned int generation = m_Generation.load(std::memory_order_acquire);
+			if (RunOne(workerIndex)) {
+				idle = 0;
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(m_SleepMutex);
+			m_Sleeping.fetch_add(1);
+			m_WakeUp.wait(lock, [this, generation]() -> bool {
+				return m_Stop.load(std::memory_order_relaxed) || m_Generation.load() != generation;
+			});
+			m_Sleeping.fetch_sub(1);
+			idle = 0;
+		}
+	}
+
+}
\ No newline at end of file
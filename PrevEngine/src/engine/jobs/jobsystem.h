@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+namespace prev {
+
+	// Counts jobs that haven't finished yet, wait on it with JobSystem::Wait
+	struct JobCounter {
+		std::atomic<unsigned int> Value{ 0 };
+
+		inline bool IsDone() const { return Value.load(std::memory_order_acquire) == 0; }
+	};
+
+	// The callable is stored inline, no heap allocation per job
+	struct alignas(64) Job {
+		static const unsigned int DataSize = 40;
+
+		void (*Function)(Job & job);
+		JobCounter * Counter;
+		alignas(16) unsigned char Data[DataSize];
+		std::atomic<bool> InFlight{ false };	// Set from Run until the job has finished, the slot isn't reused meanwhile
+	};
+
+	// Chase-Lev work stealing deque, fixed size
+	// The owning worker pushes and pops at the bottom, everyone else steals from the top
+	class JobDeque {
+	public:
+		static const long long Capacity = 4096; // Power of 2
+
+		bool Push(Job * job);
+		Job * Pop();
+		Job * Steal();
+	private:
+		alignas(64) std::atomic<long long> m_Top{ 0 };
+		alignas(64) std::atomic<long long> m_Bottom{ 0 };
+		std::atomic<Job *> m_Jobs[Capacity];
+	};
+
+	// Owned by the Application, the thread that creates it counts as worker 0
+	// Only worker threads (and worker 0) can schedule jobs, any other thread runs them inline
+	class JobSystem {
+	public:
+		static const unsigned int MaxWorkers = 64;
+
+		// 0 picks std::thread::hardware_concurrency()
+		JobSystem(unsigned int workerCount = 0);
+		~JobSystem();
+
+		JobSystem(const JobSystem &) = delete;
+		JobSystem & operator=(const JobSystem &) = delete;
+
+		template<typename F>
+		void Run(F && func, JobCounter * counter = nullptr) {
+			using Function = std::decay_t<F>;
+			static_assert(sizeof(Function) <= Job::DataSize, "Job captures too much, capture a pointer instead");
+			static_assert(alignof(Function) <= 16, "Job capture is over aligned");
+
+			// Not one of our threads, or the next slot still holds a job that was stolen and is still running
+			Job * job = GetWorkerIndex() != MaxWorkers ? AllocateJob() : nullptr;
+			if (job == nullptr) {
+				func();
+				return;
+			}
+
+			if (counter != nullptr)
+				counter->Value.fetch_add(1, std::memory_order_relaxed);
+
+			new (job->Data) Function(std::forward<F>(func));
+			job->Counter = counter;
+			job->Function = [](Job & job) -> void {
+				Function & function = *std::launder(reinterpret_cast<Function *>(job.Data));
+				function();
+				function.~Function();
+			};
+			Submit(job);
+		}
+
+		// Helps running jobs until the counter reaches 0
+		void Wait(JobCounter & counter);
+
+		// func(index) for every index in [0, count), in batches of batchSize (0 picks one), returns when all are done
+		template<typename F>
+		void ParallelFor(unsigned int count, unsigned int batchSize, F && func) {
+			if (count == 0)
+				return;
+			if (batchSize == 0)
+				batchSize = std::max(1u, count / (m_WorkerCount * 4));
+
+			JobCounter counter;
+			auto * function = &func;
+			for (unsigned int begin = 0; begin < count; begin += batchSize) {
+				unsigned int end = std::min(count, begin + batchSize);
+				Run([function, begin, end]() -> void {
+					for (unsigned int i = begin; i < end; i++)
+						(*function)(i);
+				}, &counter);
+			}
+			Wait(counter);
+		}
+
+		inline unsigned int GetWorkerCount() const { return m_WorkerCount; }
+		// Index of the calling thread in this system, MaxWorkers when it isn't one of ours
+		unsigned int GetWorkerIndex() const;
+	private:
+		struct alignas(64) Worker {
+			static const unsigned int JobCount = JobDeque::Capacity * 2; // Ring of slots, twice the deque so one is usually free again by the time the ring comes back to it
+
+			JobDeque Deque;
+			std::unique_ptr<Job[]> Jobs;
+			unsigned int NextJob = 0;
+			unsigned int Random = 0;
+			std::thread Thread;
+		};
+
+		// nullptr when the next slot in the calling worker's ring is still in flight
+		Job * AllocateJob();
+		void Submit(Job * job);
+		bool RunOne(unsigned int workerIndex);
+		void Execute(Job * job);
+		void WorkerThread(unsigned int workerIndex);
+	private:
+		unsigned int m_WorkerCount;
+		std::unique_ptr<Worker[]> m_Workers;
+
+		std::atomic<bool> m_Stop{ false };
+		std::atomic<unsigned int> m_Generation{ 0 };
+		std::atomic<unsigned int> m_Sleeping{ 0 };
+		std::mutex m_SleepMutex;
+		std::condition_variable m_WakeUp;
+	};
+
+}
\ No newline at end of file
@@ -1,13 +1,65 @@
 #include "pch.h"
 #include "layer.h"
 
+#include "engine/framepipeline.h"
+
 namespace prev {
 
+	JobSystem * Layer::s_JobSystem = nullptr;
+	FramePacket * Layer::s_FramePacket = nullptr;
+
+	CommandBuffer & Layer::GetCommandBuffer() {
+		return s_FramePacket->Queue.GetBuffer();
+	}
+
+	static unsigned long long HashResource(const char * resource) {
+		// FNV-1a
+		unsigned long long hash = 14695981039346656037ull;
+		for (const char * c = resource; *c; c++) {
+			hash ^= (unsigned char)*c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static const char * InternName(const std::string & name) {
+		static std::mutex mutex;
+		static std::unordered_set<std::string> names;
+		std::lock_guard<std::mutex> lock(mutex);
+		return names.insert(name).first->c_str();
+	}
+
+	static PoolDesc GetLayerPoolDesc() {
+		PoolDesc desc;
+		desc.Tag = MemTag::Layer;
+		desc.BlocksPerSlab = 16;
+		return desc;
+	}
+
+	PoolAllocator & Layer::GetPool() {
+		static PoolAllocator pool{ GetLayerPoolDesc() };
+		return pool;
+	}
+
 	Layer::Layer(const std::string & name) :
-		m_DebugName(name) {
+		m_DebugName(name), m_ProfileName(InternName(name)) {
 	}
 
 	Layer::~Layer() {
 	}
 
+	void Layer::Reads(const char * resource) {
+		m_Reads.push_back(HashResource(resource));
+		m_DeclaresResources = true;
+	}
+
+	void Layer::Writes(const char * resource) {
+		m_Writes.push_back(HashResource(resource));
+		m_DeclaresResources = true;
+	}
+
+	void Layer::DeclareIndependent() {
+		m_DeclaresResources = true;
+	}
+
 }
\ No newline at end of file
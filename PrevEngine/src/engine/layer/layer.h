@@ -1,25 +1,125 @@
 #pragma once
 
 #include "engine/events/event.h"
+#include "engine/memory/poolallocator.h"
+
+#include <new>
+#include <vector>
+#include <type_traits>
+#include <typeinfo>
 
 namespace prev {
 
+	class JobSystem;
+	class CommandBuffer;
+	struct FramePacket;
+
+	// Per frame hooks, the layer stack only calls the ones a layer type overrides
+	enum LayerHook : unsigned int {
+		LayerHookUpdate			= BIT(0),
+		LayerHookFixedUpdate	= BIT(1),
+		LayerHookImGuiUpdate	= BIT(2),
+		LayerHookEvent			= BIT(3),
+		LayerHookAll			= LayerHookUpdate | LayerHookFixedUpdate | LayerHookImGuiUpdate | LayerHookEvent
+	};
+
+	// Refers to a layer in a LayerStack, goes stale (and Get returns nullptr) once the layer is popped
+	struct LayerHandle {
+		unsigned int Index = ~0u;
+		unsigned int Generation = 0;
+
+		inline bool IsValid() const { return Index != ~0u; }
+		inline bool operator==(const LayerHandle & other) const { return Index == other.Index && Generation == other.Generation; }
+		inline bool operator!=(const LayerHandle & other) const { return !(*this == other); }
+	};
+
 	class Layer {
 		friend class Application;
 		friend class LayerStack;
 	public:
+		// Layers of every type come from one pool, its slabs count under MemTag::Layer
+		static void * operator new(size_t size) { return GetPool().allocate(size); }
+		static void operator delete(void * ptr, size_t size) { GetPool().deallocate(ptr, size); }
+		// Layers with over aligned members, the pool aligns up to PoolAllocator::MaxAlignment and hands bigger ones to MemAlloc
+		static void * operator new(size_t size, std::align_val_t alignment) { return GetPool().allocate(size, (size_t)alignment); }
+		static void operator delete(void * ptr, size_t size, std::align_val_t alignment) { GetPool().deallocate(ptr, size, (size_t)alignment); }
+		static PoolAllocator & GetPool();
+
 		Layer(const std::string &name = "Layer");
 		virtual ~Layer();
+	protected:
+		// The application's job system, for spreading work from OnUpdate
+		inline static JobSystem & GetJobSystem() { return *s_JobSystem; }
+		// This frame's packet, add render commands to it from OnUpdate or OnImGuiUpdate
+		inline static FramePacket & GetFramePacket() { return *s_FramePacket; }
+		// The calling thread's buffer in this frame's render queue, also from an OnUpdate running on a worker
+		static CommandBuffer & GetCommandBuffer();
+
+		// Declaring resources lets OnUpdate run on a worker thread, next to layers it doesn't conflict with
+		// Layers that declare nothing run alone, in stack order. Call these before the layer is pushed or from OnAttach
+		void Reads(const char * resource);
+		void Writes(const char * resource);
+		// For layers that touch nothing shared with other layers
+		void DeclareIndependent();
 	private:
 		virtual void OnAttach() {}
 		virtual void OnDetach() {}
 		virtual void OnUpdate() {}
+		// Runs at Timer's fixed update rate, zero or more times per frame, before OnUpdate
+		virtual void OnFixedUpdate() {}
 		virtual void OnImGuiUpdate() {}
 		virtual void OnEvent(Event &event) {}
 
 		inline const std::string &GetName() const {	return m_DebugName;	}
+
+		// The hooks of the layer's dynamic type, PV_LAYER_HOOKS overrides it. Layers without it get every hook
+		virtual unsigned int GetHooks() const { return LayerHookAll; }
+
+		// A hook counts as overridden unless &T::Hook is visibly still Layer's, private overrides can't be
+		// named from here so they fail the check and count too. With T = Layer every hook is assumed overridden
+	#define PV_LAYER_INHERITS_HOOK(hook)\
+		template<typename T, typename = void>\
+		struct Inherits##hook : std::false_type {};\
+		template<typename T>\
+		struct Inherits##hook<T, std::enable_if_t<std::is_same_v<decltype(&T::hook), decltype(&Layer::hook)>>> : std::true_type {};
+
+		PV_LAYER_INHERITS_HOOK(OnUpdate)
+		PV_LAYER_INHERITS_HOOK(OnFixedUpdate)
+		PV_LAYER_INHERITS_HOOK(OnImGuiUpdate)
+		PV_LAYER_INHERITS_HOOK(OnEvent)
+	#undef PV_LAYER_INHERITS_HOOK
+
+	protected:
+		template<typename T>
+		static unsigned int DetectHooks() {
+			if constexpr (std::is_same_v<T, Layer>) {
+				return LayerHookAll;
+			} else {
+				unsigned int hooks = 0;
+				if (!InheritsOnUpdate<T>::value)		hooks |= LayerHookUpdate;
+				if (!InheritsOnFixedUpdate<T>::value)	hooks |= LayerHookFixedUpdate;
+				if (!InheritsOnImGuiUpdate<T>::value)	hooks |= LayerHookImGuiUpdate;
+				if (!InheritsOnEvent<T>::value)			hooks |= LayerHookEvent;
+				return hooks;
+			}
+		}
 	private:
 		std::string m_DebugName;
+		const char * m_ProfileName;		// Interned, profiled frames can outlive the layer
+
+		std::vector<unsigned long long> m_Reads;
+		std::vector<unsigned long long> m_Writes;
+		bool m_DeclaresResources = false;
+
+		unsigned int m_Hooks = LayerHookAll;
+		LayerHandle m_Handle;			// Set by the stack it's pushed on
+
+		static JobSystem * s_JobSystem;
+		static FramePacket * s_FramePacket;
 	};
 
-}
\ No newline at end of file
+}
+
+// Put it first in a layer's class body so the layer stack only calls the hooks it overrides, even when it's pushed through
+// a base pointer. A subclass that doesn't repeat it is caught by the typeid check and gets every hook
+#define PV_LAYER_HOOKS(type) virtual unsigned int GetHooks() const override { return typeid(*this) == typeid(type) ? prev::Layer::DetectHooks<type>() : prev::LayerHookAll; }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "layerstack.h"
 
+#include "engine/jobs/jobsystem.h"
+
 namespace prev {
 
 	LayerStack::LayerStack() {}
@@ -10,81 +12,316 @@ namespace prev {
 			delete layer;
 		for (Layer * layer : m_Overlays)
 			delete layer;
+		// Pushed during a walk that never ended
+		for (const Pending & pending : m_Pending) {
+			const Slot * slot = GetSlot(pending.Handle);
+			if (pending.Type == PendingType::Push && slot != nullptr && !slot->IsAttached)
+				delete slot->Instance;
+		}
+	}
+
+	LayerHandle LayerStack::Push(Layer * layer, bool isOverlay) {
+		LayerHandle handle;
+		if (!m_FreeSlots.empty()) {
+			handle.Index = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		} else {
+			handle.Index = (unsigned int)m_Slots.size();
+			m_Slots.emplace_back();
+		}
+
+		Slot & slot = m_Slots[handle.Index];
+		slot.Instance = layer;
+		slot.IsOverlay = isOverlay;
+		slot.IsAttached = false;
+		handle.Generation = slot.Generation;
+		layer->m_Handle = handle;
+
+		if (m_IterationDepth > 0)
+			m_Pending.push_back({ PendingType::Push, handle });
+		else
+			Attach(handle);
+		return handle;
+	}
+
+	bool LayerStack::PopLayer(Layer * layer) {
+		const Slot * slot = GetSlot(layer->m_Handle);
+		if (slot != nullptr && slot->Instance == layer && !slot->IsOverlay)
+			return Pop(layer->m_Handle);
+		return false;
+	}
+
+	bool LayerStack::PopOverlay(Layer * layer) {
+		const Slot * slot = GetSlot(layer->m_Handle);
+		if (slot != nullptr && slot->Instance == layer && slot->IsOverlay)
+			return Pop(layer->m_Handle);
+		return false;
+	}
+
+	bool LayerStack::Pop(LayerHandle handle) {
+		if (GetSlot(handle) == nullptr)
+			return false;
+		if (m_IterationDepth > 0) {
+			m_Pending.push_back({ PendingType::Pop, handle });
+			return false;
+		}
+		Detach(handle);
+		return true;
+	}
+
+	const LayerStack::Slot * LayerStack::GetSlot(LayerHandle handle) const {
+		if (handle.Index >= m_Slots.size())
+			return nullptr;
+		const Slot & slot = m_Slots[handle.Index];
+		if (slot.Instance == nullptr || slot.Generation != handle.Generation)
+			return nullptr;
+		return &slot;
 	}
 
-	void LayerStack::PushLayer(Layer * layer) {
-		m_Layers.push_back(layer);
-		layer->OnAttach();
+	void LayerStack::Attach(LayerHandle handle) {
+		Slot & slot = m_Slots[handle.Index];
+		slot.IsAttached = true;
+		(slot.IsOverlay ? m_Overlays : m_Layers).push_back(slot.Instance);
+		AddName(slot.Instance);
+		m_PhasesDirty = true;
+		slot.Instance->OnAttach();
 	}
 
-	void LayerStack::PushOverlay(Layer * overlay) {
-		m_Overlays.push_back(overlay);
-		overlay->OnAttach();
+	void LayerStack::Detach(LayerHandle handle) {
+		Slot & slot = m_Slots[handle.Index];
+		Layer * layer = slot.Instance;
+		bool wasAttached = slot.IsAttached;
+		if (wasAttached) {
+			std::vector<Layer *> & layers = slot.IsOverlay ? m_Overlays : m_Layers;
+			layers.erase(std::find(layers.begin(), layers.end(), layer));
+			RemoveName(layer);
+			m_PhasesDirty = true;
+		}
+
+		// Stale handles to the slot stop resolving from here on
+		slot.Instance = nullptr;
+		slot.IsAttached = false;
+		slot.Generation++;
+		m_FreeSlots.push_back(handle.Index);
+		layer->m_Handle = LayerHandle();
+
+		if (wasAttached)
+			layer->OnDetach();
 	}
 
-	void LayerStack::PopLayer(Layer * layer) {
-		for (int i = 0; i < m_Layers.size(); i++) {
-			if (m_Layers[i] == layer) {
-				m_Layers.erase(m_Layers.begin() + i);
-				layer->OnDetach();
+	// In the order they were asked for, a layer pushed and popped during the same walk is never attached
+	// Layers popped during the walk are still owned by the stack, they are deleted once detached
+	void LayerStack::ApplyPending() {
+		std::vector<Pending> pending;
+		pending.swap(m_Pending);
+		for (const Pending & change : pending) {
+			const Slot * slot = GetSlot(change.Handle);
+			if (slot == nullptr)
+				continue;
+			if (change.Type == PendingType::Push) {
+				Attach(change.Handle);
+			} else {
+				Layer * layer = slot->Instance;
+				Detach(change.Handle);
+				delete layer;
 			}
 		}
 	}
 
-	void LayerStack::PopOverlay(Layer * layer) {
-		for (int i = 0; i < m_Overlays.size(); i++) {
-			if (m_Overlays[i] == layer) {
-				m_Overlays.erase(m_Overlays.begin() + i);
-				layer->OnDetach();
+	void LayerStack::AddName(Layer * layer) {
+		auto it = m_Names.find(layer->m_DebugName);
+		if (it == m_Names.end()) {
+			m_Names.emplace(layer->m_DebugName, layer->m_Handle);
+			return;
+		}
+		// Layers come before overlays, otherwise the first one pushed keeps the name
+		const Slot * slot = GetSlot(it->second);
+		if (slot->IsOverlay && !m_Slots[layer->m_Handle.Index].IsOverlay)
+			it->second = layer->m_Handle;
+	}
+
+	void LayerStack::RemoveName(Layer * layer) {
+		auto it = m_Names.find(layer->m_DebugName);
+		if (it == m_Names.end() || it->second != layer->m_Handle)
+			return;
+
+		// Only when the name is shared, hand it to the next layer that has it
+		for (auto & layers : { &m_Layers, &m_Overlays }) {
+			for (Layer * other : *layers) {
+				if (other != layer && other->m_DebugName == layer->m_DebugName) {
+					it->second = other->m_Handle;
+					return;
+				}
 			}
 		}
+		m_Names.erase(it);
 	}
 
-	void LayerStack::OnUpdate() {
-		for (auto layer : m_Layers) {
-			layer->OnUpdate();
+	Layer * LayerStack::Get(LayerHandle handle) const {
+		const Slot * slot = GetSlot(handle);
+		return slot != nullptr ? slot->Instance : nullptr;
+	}
+
+	Layer * LayerStack::GetLayer(const std::string & layerName) const {
+		return Get(FindLayer(layerName));
+	}
+
+	LayerHandle LayerStack::FindLayer(const std::string & layerName) const {
+		auto it = m_Names.find(layerName);
+		if (it == m_Names.end())
+			return LayerHandle();
+		return it->second;
+	}
+
+	// True when b has to wait for a (a comes first in the stack)
+	bool LayerStack::Conflicts(const Layer * a, const Layer * b) {
+		if (!a->m_DeclaresResources || !b->m_DeclaresResources)
+			return true;
+		auto intersects = [](const std::vector<unsigned long long> & x, const std::vector<unsigned long long> & y) -> bool {
+			for (auto i : x) {
+				for (auto j : y) {
+					if (i == j)
+						return true;
+				}
+			}
+			return false;
+		};
+		return intersects(a->m_Writes, b->m_Writes) || intersects(a->m_Writes, b->m_Reads) || intersects(a->m_Reads, b->m_Writes);
+	}
+
+	void LayerStack::RebuildPhases() {
+		PV_PROFILE_FUNCTION();
+
+		RebuildSchedule(m_UpdateSchedule, LayerHookUpdate);
+		RebuildSchedule(m_FixedUpdateSchedule, LayerHookFixedUpdate);
+
+		m_ImGuiLayers.clear();
+		m_EventLayers.clear();
+		for (Layer * layer : m_Layers) {
+			if (layer->m_Hooks & LayerHookImGuiUpdate)
+				m_ImGuiLayers.push_back(layer);
+			if (layer->m_Hooks & LayerHookEvent)
+				m_EventLayers.push_back(layer);
 		}
-		for (auto layer : m_Overlays) {
-			layer->OnUpdate();
+		m_EventOverlaysStart = (unsigned int)m_EventLayers.size();
+		for (Layer * layer : m_Overlays) {
+			if (layer->m_Hooks & LayerHookImGuiUpdate)
+				m_ImGuiLayers.push_back(layer);
+			if (layer->m_Hooks & LayerHookEvent)
+				m_EventLayers.push_back(layer);
 		}
+
+		m_PhasesDirty = false;
 	}
 
-	void LayerStack::OnImGuiUpdate() {
-		for (auto layer : m_Layers) {
-			layer->OnImGuiUpdate();
+	void LayerStack::RebuildSchedule(Schedule & schedule, LayerHook hook) {
+		// Layers without the hook have nothing to run, so they don't hold anyone back either
+		std::vector<Layer *> order;
+		order.reserve(m_Layers.size() + m_Overlays.size());
+		for (auto & layers : { &m_Layers, &m_Overlays }) {
+			for (Layer * layer : *layers) {
+				if (layer->m_Hooks & hook)
+					order.push_back(layer);
+			}
 		}
 
-		for (auto layer : m_Overlays) {
-			layer->OnImGuiUpdate();
+		// Level of a layer is one past the deepest earlier layer it conflicts with
+		// An undeclared layer conflicts with everything, so it gets a level of its own
+		std::vector<unsigned int> levels(order.size(), 0);
+		unsigned int levelCount = 0;
+		unsigned int barrier = 0; // Nothing can be placed below the last undeclared layer
+		for (unsigned int j = 0; j < order.size(); j++) {
+			unsigned int level = barrier;
+			if (!order[j]->m_DeclaresResources) {
+				level = levelCount;
+			} else {
+				for (unsigned int i = 0; i < j; i++) {
+					if (levels[i] >= level && Conflicts(order[i], order[j]))
+						level = levels[i] + 1;
+				}
+			}
+			levels[j] = level;
+			levelCount = std::max(levelCount, level + 1);
+			if (!order[j]->m_DeclaresResources)
+				barrier = level + 1;
+		}
+
+		// Stable bucket by level keeps stack order inside a level
+		schedule.Layers.clear();
+		schedule.LevelStarts.assign(levelCount + 1, 0);
+		for (unsigned int level : levels)
+			schedule.LevelStarts[level + 1]++;
+		for (unsigned int i = 0; i < levelCount; i++)
+			schedule.LevelStarts[i + 1] += schedule.LevelStarts[i];
+		schedule.Layers.resize(order.size());
+		std::vector<unsigned int> next(schedule.LevelStarts.begin(), schedule.LevelStarts.end() - 1);
+		for (unsigned int j = 0; j < order.size(); j++)
+			schedule.Layers[next[levels[j]]++] = order[j];
+	}
+
+	void LayerStack::RunSchedule(const Schedule & schedule, void (Layer::*update)()) {
+		JobSystem * jobSystem = Layer::s_JobSystem;
+		for (unsigned int level = 0; level + 1 < schedule.LevelStarts.size(); level++) {
+			unsigned int begin = schedule.LevelStarts[level];
+			unsigned int end = schedule.LevelStarts[level + 1];
+
+			if (end - begin == 1 || jobSystem == nullptr) {
+				for (unsigned int i = begin; i < end; i++) {
+					PV_PROFILE_SCOPE(schedule.Layers[i]->m_ProfileName);
+					(schedule.Layers[i]->*update)();
+				}
+				continue;
+			}
+
+			Layer * const * layers = schedule.Layers.data() + begin;
+			jobSystem->ParallelFor(end - begin, 1, [layers, update](unsigned int i) -> void {
+				PV_PROFILE_SCOPE(layers[i]->m_ProfileName);
+				(layers[i]->*update)();
+			});
 		}
 	}
 
+	void LayerStack::OnUpdate() {
+		PV_PROFILE_SCOPE("LayerStack::OnUpdate");
+		if (m_PhasesDirty)
+			RebuildPhases();
+		IterationScope scope(*this);
+		RunSchedule(m_UpdateSchedule, &Layer::OnUpdate);
+	}
+
+	void LayerStack::OnFixedUpdate() {
+		PV_PROFILE_SCOPE("LayerStack::OnFixedUpdate");
+		if (m_PhasesDirty)
+			RebuildPhases();
+		IterationScope scope(*this);
+		RunSchedule(m_FixedUpdateSchedule, &Layer::OnFixedUpdate);
+	}
+
+	void LayerStack::OnImGuiUpdate() {
+		PV_PROFILE_SCOPE("LayerStack::OnImGuiUpdate");
+		if (m_PhasesDirty)
+			RebuildPhases();
+		IterationScope scope(*this);
+		for (Layer * layer : m_ImGuiLayers)
+			layer->OnImGuiUpdate();
+	}
+
 	void LayerStack::OnEvent(Event & e) {
-		for (auto layer : m_Layers) {
-			layer->OnEvent(e);
+		PV_PROFILE_SCOPE("LayerStack::OnEvent");
+		if (m_PhasesDirty)
+			RebuildPhases();
+		IterationScope scope(*this);
+		for (unsigned int i = 0; i < m_EventOverlaysStart; i++) {
+			m_EventLayers[i]->OnEvent(e);
 			if (e.Handled())
 				break;
 		}
 
-		for (auto layer : m_Overlays) {
-			layer->OnEvent(e);
+		for (unsigned int i = m_EventOverlaysStart; i < m_EventLayers.size(); i++) {
+			m_EventLayers[i]->OnEvent(e);
 			if (e.Handled())
 				break;
 		}
 	}
 
-	Layer * LayerStack::GetLayer(const std::string & layerName) {
-		for (unsigned int i = 0; i < m_Layers.size(); i++) {
-			if (m_Layers[i]->m_DebugName == layerName) {
-				return m_Layers[i];
-			}
-		}
-		for (unsigned int i = 0; i < m_Overlays.size(); i++) {
-			if (m_Overlays[i]->m_DebugName == layerName) {
-				return m_Overlays[i];
-			}
-		}
-		return nullptr;
-	}
-
 }
\ No newline at end of file
@@ -2,27 +2,128 @@
 
 #include "layer.h"
 
+#include <unordered_map>
+
 namespace prev {
 
+	// Owns its layers. Pushing and popping from a hook (or any time the stack is being walked) is deferred
+	// to the end of the walk, a pushed layer gets its handle right away but is attached then
+	// Push and pop from the main thread only, not from an OnUpdate that runs on a worker
 	class LayerStack {
 	public:
 		LayerStack();
 		~LayerStack();
 
-		void PushLayer(Layer * layer);
-		void PushOverlay(Layer * overlay);
-		void PopLayer(Layer * layer);
-		void PopOverlay(Layer * layer);
+		LayerStack(const LayerStack &) = delete;
+		LayerStack & operator=(const LayerStack &) = delete;
+
+		// Only the hooks the layer overrides get called, see PV_LAYER_HOOKS
+		template<typename T>
+		LayerHandle PushLayer(T * layer) {
+			layer->m_Hooks = GetHooks(layer);
+			return Push(layer, false);
+		}
+
+		template<typename T>
+		LayerHandle PushOverlay(T * overlay) {
+			overlay->m_Hooks = GetHooks(overlay);
+			return Push(overlay, true);
+		}
+
+		// True when the layer was detached right away, the caller owns it afterwards
+		// Popped during a walk it stays until the walk ends, then the stack detaches and deletes it and this returns false
+		bool PopLayer(Layer * layer);
+		bool PopOverlay(Layer * layer);
+		bool Pop(LayerHandle handle);
 
 	public:
 		void OnUpdate();
+		void OnFixedUpdate();
 		void OnImGuiUpdate();
 		void OnEvent(Event & e);
 
-		Layer * GetLayer(const std::string & layerName);
+		// nullptr once the layer is popped
+		Layer * Get(LayerHandle handle) const;
+		// First one in stack order (layers, then overlays) with that name
+		Layer * GetLayer(const std::string & layerName) const;
+		LayerHandle FindLayer(const std::string & layerName) const;
+
+		inline unsigned int GetLayerCount() const { return (unsigned int)(m_Layers.size() + m_Overlays.size()); }
 	private:
+		struct Slot {
+			Layer * Instance = nullptr;
+			unsigned int Generation = 0;
+			bool IsOverlay = false;
+			bool IsAttached = false;
+		};
+
+		enum class PendingType {
+			Push, Pop
+		};
+
+		struct Pending {
+			PendingType Type;
+			LayerHandle Handle;
+		};
+
+		// OnUpdate or OnFixedUpdate order, layers that have the hook grouped in levels, a level only depends on the ones before it
+		// Layers inside a level don't conflict and run in parallel
+		struct Schedule {
+			std::vector<Layer *> Layers;
+			std::vector<unsigned int> LevelStarts;
+		};
+
+		// Walks of the stack bump it, changes made meanwhile wait for the last walk to end
+		struct IterationScope {
+			IterationScope(LayerStack & stack) : Stack(stack) { Stack.m_IterationDepth++; }
+			~IterationScope() {
+				if (--Stack.m_IterationDepth == 0 && !Stack.m_Pending.empty())
+					Stack.ApplyPending();
+			}
+			LayerStack & Stack;
+		};
+
+		// A final T has to be the dynamic type, anything else could be a base so the layer is asked
+		template<typename T>
+		static unsigned int GetHooks(T * layer) {
+			if constexpr (std::is_final_v<T>)
+				return Layer::DetectHooks<T>();
+			else
+				return static_cast<Layer *>(layer)->GetHooks();
+		}
+
+		LayerHandle Push(Layer * layer, bool isOverlay);
+		const Slot * GetSlot(LayerHandle handle) const;
+		void Attach(LayerHandle handle);
+		void Detach(LayerHandle handle);
+		void ApplyPending();
+
+		void AddName(Layer * layer);
+		void RemoveName(Layer * layer);
+
+		void RebuildPhases();
+		void RebuildSchedule(Schedule & schedule, LayerHook hook);
+		void RunSchedule(const Schedule & schedule, void (Layer::*update)());
+		static bool Conflicts(const Layer * a, const Layer * b);
+	private:
+		std::vector<Slot> m_Slots;
+		std::vector<unsigned int> m_FreeSlots;
+
+		// Stack order
 		std::vector<Layer *> m_Layers;
 		std::vector<Layer *> m_Overlays;
+		std::unordered_map<std::string, LayerHandle> m_Names;
+
+		// Only the layers that override each hook, rebuilt when the stack changes
+		Schedule m_UpdateSchedule;
+		Schedule m_FixedUpdateSchedule;
+		std::vector<Layer *> m_ImGuiLayers;
+		std::vector<Layer *> m_EventLayers;
+		unsigned int m_EventOverlaysStart = 0;
+		bool m_PhasesDirty = true;
+
+		unsigned int m_IterationDepth = 0;
+		std::vector<Pending> m_Pending;
 	};
 
 }
\ No newline at end of file
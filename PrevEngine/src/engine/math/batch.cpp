@@ -0,0 +1,231 @@
+#include "pch.h"
+#include "batch.h"
+
+namespace prev::math {
+
+	static size_t Shortest(std::initializer_list<size_t> sizes) {
+		return std::min(sizes);
+	}
+
+	// The scalar kernels work on ranges so the SIMD ones can hand them their leftovers
+	static void TransformPointsRange(const float * m, Vec3Spans<const float> points, Vec3Spans<float> out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float x = points.X[i], y = points.Y[i], z = points.Z[i];
+			float rx = m[0] * x, ry = m[1] * x, rz = m[2] * x;
+			rx = m[4] * y + rx;
+			ry = m[5] * y + ry;
+			rz = m[6] * y + rz;
+			rx = m[8] * z + rx;
+			ry = m[9] * z + ry;
+			rz = m[10] * z + rz;
+			out.X[i] = rx + m[12];
+			out.Y[i] = ry + m[13];
+			out.Z[i] = rz + m[14];
+		}
+	}
+
+	static void MultiplyMatricesRange(Span<const Mat4> a, Span<const Mat4> b, Span<Mat4> out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float ma[16], mb[16], result[16];
+			a[i].Store(ma);
+			b[i].Store(mb);
+			for (unsigned int column = 0; column < 4; column++) {
+				const float * c = mb + column * 4;
+				for (unsigned int row = 0; row < 4; row++) {
+					float sum = ma[row] * c[0];
+					sum = ma[4 + row] * c[1] + sum;
+					sum = ma[8 + row] * c[2] + sum;
+					sum = ma[12 + row] * c[3] + sum;
+					result[column * 4 + row] = sum;
+				}
+			}
+			out[i] = Mat4::FromColumnMajor(result);
+		}
+	}
+
+	static size_t TestSpheresRange(const float (*planes)[4], SphereSpans spheres, Span<unsigned char> visible, size_t begin, size_t end) {
+		size_t count = 0;
+		for (size_t i = begin; i < end; i++) {
+			float x = spheres.X[i], y = spheres.Y[i], z = spheres.Z[i], negRadius = -spheres.Radius[i];
+			bool outside = false;
+			for (unsigned int k = 0; k < Frustum::PlaneCount; k++) {
+				const float * p = planes[k];
+				float distance = ((p[0] * x + p[1] * y) + p[2] * z) + p[3];
+				outside |= distance < negRadius;
+			}
+			visible[i] = outside ? 0 : 1;
+			count += outside ? 0 : 1;
+		}
+		return count;
+	}
+
+	static void StorePlanes(const Frustum & frustum, float (*planes)[4]) {
+		for (unsigned int k = 0; k < Frustum::PlaneCount; k++)
+			Store4(planes[k], frustum.Planes[k].V);
+	}
+
+	namespace scalar {
+
+		void TransformPoints(const Mat4 & m, Vec3Spans<const float> points, Vec3Spans<float> out) {
+			float matrix[16];
+			m.Store(matrix);
+			size_t count = Shortest({ points.X.size(), points.Y.size(), points.Z.size(), out.X.size(), out.Y.size(), out.Z.size() });
+			TransformPointsRange(matrix, points, out, 0, count);
+		}
+
+		void MultiplyMatrices(Span<const Mat4> a, Span<const Mat4> b, Span<Mat4> out) {
+			MultiplyMatricesRange(a, b, out, 0, Shortest({ a.size(), b.size(), out.size() }));
+		}
+
+		size_t TestSpheres(const Frustum & frustum, SphereSpans spheres, Span<unsigned char> visible) {
+			float planes[Frustum::PlaneCount][4];
+			StorePlanes(frustum, planes);
+			size_t count = Shortest({ spheres.X.size(), spheres.Y.size(), spheres.Z.size(), spheres.Radius.size(), visible.size() });
+			return TestSpheresRange(planes, spheres, visible, 0, count);
+		}
+
+	}
+
+#if defined(PV_MATH_AVX2)
+	static inline __m256 MulAdd8(__m256 a, __m256 b, __m256 c) {
+	#if defined(PV_MATH_FMA)
+		return _mm256_fmadd_ps(a, b, c);
+	#else
+		return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+	#endif
+	}
+#endif
+
+	void TransformPoints(const Mat4 & m, Vec3Spans<const float> points, Vec3Spans<float> out) {
+		float c[16];
+		m.Store(c);
+		const size_t count = Shortest({ points.X.size(), points.Y.size(), points.Z.size(), out.X.size(), out.Y.size(), out.Z.size() });
+		size_t i = 0;
+
+	#if defined(PV_MATH_AVX2)
+		__m256 m8[12];
+		for (unsigned int k = 0; k < 12; k++)
+			m8[k] = _mm256_set1_ps(c[k < 3 ? k : k < 6 ? k + 1 : k < 9 ? k + 2 : k + 3]);
+		for (; i + 8 <= count; i += 8) {
+			__m256 x = _mm256_loadu_ps(&points.X[i]), y = _mm256_loadu_ps(&points.Y[i]), z = _mm256_loadu_ps(&points.Z[i]);
+			__m256 rx = _mm256_mul_ps(m8[0], x), ry = _mm256_mul_ps(m8[1], x), rz = _mm256_mul_ps(m8[2], x);
+			rx = MulAdd8(m8[3], y, rx);
+			ry = MulAdd8(m8[4], y, ry);
+			rz = MulAdd8(m8[5], y, rz);
+			rx = MulAdd8(m8[6], z, rx);
+			ry = MulAdd8(m8[7], z, ry);
+			rz = MulAdd8(m8[8], z, rz);
+			_mm256_storeu_ps(&out.X[i], _mm256_add_ps(rx, m8[9]));
+			_mm256_storeu_ps(&out.Y[i], _mm256_add_ps(ry, m8[10]));
+			_mm256_storeu_ps(&out.Z[i], _mm256_add_ps(rz, m8[11]));
+		}
+	#elif !defined(PV_MATH_SCALAR)
+		Float4 m4[12];
+		for (unsigned int k = 0; k < 12; k++)
+			m4[k] = Splat4(c[k < 3 ? k : k < 6 ? k + 1 : k < 9 ? k + 2 : k + 3]);
+		for (; i + 4 <= count; i += 4) {
+			Float4 x = Load4(&points.X[i]), y = Load4(&points.Y[i]), z = Load4(&points.Z[i]);
+			Float4 rx = Mul(m4[0], x), ry = Mul(m4[1], x), rz = Mul(m4[2], x);
+			rx = MulAdd(m4[3], y, rx);
+			ry = MulAdd(m4[4], y, ry);
+			rz = MulAdd(m4[5], y, rz);
+			rx = MulAdd(m4[6], z, rx);
+			ry = MulAdd(m4[7], z, ry);
+			rz = MulAdd(m4[8], z, rz);
+			Store4(&out.X[i], Add(rx, m4[9]));
+			Store4(&out.Y[i], Add(ry, m4[10]));
+			Store4(&out.Z[i], Add(rz, m4[11]));
+		}
+	#endif
+		TransformPointsRange(c, points, out, i, count);
+	}
+
+	void MultiplyMatrices(Span<const Mat4> a, Span<const Mat4> b, Span<Mat4> out) {
+		const size_t count = Shortest({ a.size(), b.size(), out.size() });
+	#if defined(PV_MATH_AVX2)
+		// Two result columns per register, each half multiplies a's columns by one of b's
+		for (size_t i = 0; i < count; i++) {
+			const Mat4 & ma = a[i];
+			const Mat4 & mb = b[i];
+			__m256 columns[4];
+			for (unsigned int k = 0; k < 4; k++)
+				columns[k] = _mm256_broadcast_ps(&ma.Columns[k].V);
+			__m256 pairs[2] = { _mm256_loadu_ps((const float *)&mb.Columns[0]), _mm256_loadu_ps((const float *)&mb.Columns[2]) };
+			Mat4 result;
+			for (unsigned int p = 0; p < 2; p++) {
+				__m256 sum = _mm256_mul_ps(columns[0], _mm256_permute_ps(pairs[p], 0x00));
+				sum = MulAdd8(columns[1], _mm256_permute_ps(pairs[p], 0x55), sum);
+				sum = MulAdd8(columns[2], _mm256_permute_ps(pairs[p], 0xAA), sum);
+				sum = MulAdd8(columns[3], _mm256_permute_ps(pairs[p], 0xFF), sum);
+				_mm256_storeu_ps((float *)&result.Columns[p * 2], sum);
+			}
+			out[i] = result;
+		}
+	#elif !defined(PV_MATH_SCALAR)
+		for (size_t i = 0; i < count; i++)
+			out[i] = a[i] * b[i];
+	#else
+		MultiplyMatricesRange(a, b, out, 0, count);
+	#endif
+	}
+
+	size_t TestSpheres(const Frustum & frustum, SphereSpans spheres, Span<unsigned char> visible) {
+		float planes[Frustum::PlaneCount][4];
+		StorePlanes(frustum, planes);
+		const size_t count = Shortest({ spheres.X.size(), spheres.Y.size(), spheres.Z.size(), spheres.Radius.size(), visible.size() });
+		size_t visibleCount = 0;
+		size_t i = 0;
+
+	#if defined(PV_MATH_AVX2)
+		__m256 p8[Frustum::PlaneCount][4];
+		for (unsigned int k = 0; k < Frustum::PlaneCount; k++) {
+			for (unsigned int c = 0; c < 4; c++)
+				p8[k][c] = _mm256_set1_ps(planes[k][c]);
+		}
+		const __m256 signBit = _mm256_set1_ps(-0.0f);
+		for (; i + 8 <= count; i += 8) {
+			__m256 x = _mm256_loadu_ps(&spheres.X[i]), y = _mm256_loadu_ps(&spheres.Y[i]), z = _mm256_loadu_ps(&spheres.Z[i]);
+			__m256 negRadius = _mm256_xor_ps(_mm256_loadu_ps(&spheres.Radius[i]), signBit);
+			__m256 outside = _mm256_setzero_ps();
+			for (unsigned int k = 0; k < Frustum::PlaneCount; k++) {
+				__m256 distance = _mm256_mul_ps(p8[k][0], x);
+				distance = MulAdd8(p8[k][1], y, distance);
+				distance = MulAdd8(p8[k][2], z, distance);
+				distance = _mm256_add_ps(distance, p8[k][3]);
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negRadius, _CMP_LT_OQ));
+			}
+			unsigned int inside = ~(unsigned int)_mm256_movemask_ps(outside) & 0xFF;
+			for (unsigned int lane = 0; lane < 8; lane++) {
+				visible[i + lane] = (inside >> lane) & 1;
+				visibleCount += (inside >> lane) & 1;
+			}
+		}
+	#elif !defined(PV_MATH_SCALAR)
+		// Like the AVX2 path, 4 wide
+		Float4 p4[Frustum::PlaneCount][4];
+		for (unsigned int k = 0; k < Frustum::PlaneCount; k++) {
+			for (unsigned int c = 0; c < 4; c++)
+				p4[k][c] = Splat4(planes[k][c]);
+		}
+		for (; i + 4 <= count; i += 4) {
+			Float4 x = Load4(&spheres.X[i]), y = Load4(&spheres.Y[i]), z = Load4(&spheres.Z[i]);
+			Float4 negRadius = Neg(Load4(&spheres.Radius[i]));
+			Float4 outside = Zero4();
+			for (unsigned int k = 0; k < Frustum::PlaneCount; k++) {
+				Float4 distance = Mul(p4[k][0], x);
+				distance = MulAdd(p4[k][1], y, distance);
+				distance = MulAdd(p4[k][2], z, distance);
+				distance = Add(distance, p4[k][3]);
+				outside = Or(outside, Less(distance, negRadius));
+			}
+			unsigned int inside = ~(unsigned int)MoveMask(outside) & 0xF;
+			for (unsigned int lane = 0; lane < 4; lane++) {
+				visible[i + lane] = (inside >> lane) & 1;
+				visibleCount += (inside >> lane) & 1;
+			}
+		}
+	#endif
+		return visibleCount + TestSpheresRange(planes, spheres, visible, i, count);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "frustum.h"
+
+#include <cstddef>
+#include <utility>
+
+namespace prev::math {
+
+	// Pointer and count, a stand-in for std::span until the engine moves past C++17
+	template<typename T>
+	class Span {
+	public:
+		Span() : m_Data(nullptr), m_Size(0) { }
+		Span(T * data, size_t size) : m_Data(data), m_Size(size) { }
+		// Anything with data() and size(), std::vector, std::array, TaggedVector
+		template<typename Container, typename = decltype(std::declval<Container &>().data())>
+		Span(Container & container) : m_Data(container.data()), m_Size(container.size()) { }
+
+		inline T * data() const { return m_Data; }
+		inline size_t size() const { return m_Size; }
+		inline bool empty() const { return m_Size == 0; }
+		inline T * begin() const { return m_Data; }
+		inline T * end() const { return m_Data + m_Size; }
+		inline T & operator[](size_t index) const { return m_Data[index]; }
+	private:
+		T * m_Data;
+		size_t m_Size;
+	};
+
+	// Structure of arrays, one span per component. Kernels work on the shortest span they are given
+	template<typename T>
+	struct Vec3Spans {
+		Span<T> X, Y, Z;
+	};
+
+	struct SphereSpans {
+		Span<const float> X, Y, Z, Radius;
+	};
+
+	// out = m * (x, y, z, 1) without the divide by w, out can be the same arrays as points
+	void TransformPoints(const Mat4 & m, Vec3Spans<const float> points, Vec3Spans<float> out);
+	// out[i] = a[i] * b[i]
+	void MultiplyMatrices(Span<const Mat4> a, Span<const Mat4> b, Span<Mat4> out);
+	// visible[i] is 1 when the sphere touches the frustum, returns how many do
+	size_t TestSpheres(const Frustum & frustum, SphereSpans spheres, Span<unsigned char> visible);
+
+	// One element at a time on plain floats, what the SIMD kernels are measured and checked against
+	// In a deterministic build both give the same bits
+	namespace scalar {
+
+		void TransformPoints(const Mat4 & m, Vec3Spans<const float> points, Vec3Spans<float> out);
+		void MultiplyMatrices(Span<const Mat4> a, Span<const Mat4> b, Span<Mat4> out);
+		size_t TestSpheres(const Frustum & frustum, SphereSpans spheres, Span<unsigned char> visible);
+
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "matrix.h"
+
+namespace prev::math {
+
+	// Planes point inwards, a point is inside a plane when dot(normal, p) + w >= 0
+	struct Frustum {
+		enum Plane : unsigned int { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+		Vec4 Planes[PlaneCount];
+
+		// From a view projection matrix with 0 <= z <= w clip space (DirectX), planes normalized
+		static inline Frustum FromMatrix(const Mat4 & viewProjection) {
+			Mat4 rows = Transpose(viewProjection);
+			const Float4 * r = rows.Columns;
+			Frustum frustum;
+			frustum.Planes[Left] = Vec4(Add(r[3], r[0]));
+			frustum.Planes[Right] = Vec4(Sub(r[3], r[0]));
+			frustum.Planes[Bottom] = Vec4(Add(r[3], r[1]));
+			frustum.Planes[Top] = Vec4(Sub(r[3], r[1]));
+			frustum.Planes[Near] = Vec4(r[2]);
+			frustum.Planes[Far] = Vec4(Sub(r[3], r[2]));
+			for (Vec4 & plane : frustum.Planes)
+				plane.V = Div(plane.V, Sqrt(Dot3(plane.V, plane.V)));
+			return frustum;
+		}
+
+		// Distance is ((nx * x + ny * y) + nz * z) + w, the batch kernels compute it in the same order
+		inline bool TestSphere(Vec3 center, float radius) const {
+			for (const Vec4 & plane : Planes) {
+				float distance = GetX(Add(Dot3(plane.V, center.V), SplatLane<3>(plane.V)));
+				if (distance < -radius)
+					return false;
+			}
+			return true;
+		}
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "vector.h"
+
+namespace prev::math {
+
+	// Column major, vectors are columns multiplied on the right (m * v), like SoftwarePipelineDesc::Transform
+	struct Mat4 {
+		Float4 Columns[4];
+
+		// Identity
+		Mat4() : Columns{ Set4(1.0f, 0.0f, 0.0f, 0.0f), Set4(0.0f, 1.0f, 0.0f, 0.0f), Set4(0.0f, 0.0f, 1.0f, 0.0f), Set4(0.0f, 0.0f, 0.0f, 1.0f) } { }
+		Mat4(Vec4 c0, Vec4 c1, Vec4 c2, Vec4 c3) : Columns{ c0.V, c1.V, c2.V, c3.V } { }
+
+		static inline Mat4 Identity() { return Mat4(); }
+		// 16 floats, column after column
+		static inline Mat4 FromColumnMajor(const float * m) {
+			return Mat4(Vec4(Load4(m)), Vec4(Load4(m + 4)), Vec4(Load4(m + 8)), Vec4(Load4(m + 12)));
+		}
+		inline void Store(float * m) const {
+			for (unsigned int i = 0; i < 4; i++)
+				Store4(m + i * 4, Columns[i]);
+		}
+
+		inline Vec4 GetColumn(unsigned int column) const { return Vec4(Columns[column]); }
+		inline float Get(unsigned int row, unsigned int column) const {
+			float values[4];
+			Store4(values, Columns[column]);
+			return values[row];
+		}
+
+		static inline Mat4 Translation(Vec3 t) {
+			Mat4 m;
+			m.Columns[3] = Vec4(t, 1.0f).V;
+			return m;
+		}
+
+		static inline Mat4 Scale(Vec3 s) {
+			return Mat4(Vec4(s.X(), 0.0f, 0.0f, 0.0f), Vec4(0.0f, s.Y(), 0.0f, 0.0f), Vec4(0.0f, 0.0f, s.Z(), 0.0f), Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		}
+
+		// Left handed, depth goes to [0, 1] like DirectX and the software rasterizer
+		static inline Mat4 PerspectiveLH(float fovY, float aspect, float nearZ, float farZ) {
+			float yScale = 1.0f / std::tan(fovY * 0.5f);
+			float range = farZ / (farZ - nearZ);
+			return Mat4(Vec4(yScale / aspect, 0.0f, 0.0f, 0.0f), Vec4(0.0f, yScale, 0.0f, 0.0f), Vec4(0.0f, 0.0f, range, 1.0f), Vec4(0.0f, 0.0f, -nearZ * range, 0.0f));
+		}
+
+		// Looks down +z from eye towards target
+		static inline Mat4 LookAtLH(Vec3 eye, Vec3 target, Vec3 up) {
+			Vec3 forward = Normalize(target - eye);
+			Vec3 right = Normalize(Cross(up, forward));
+			Vec3 newUp = Cross(forward, right);
+			return Mat4(Vec4(right.X(), newUp.X(), forward.X(), 0.0f),
+						Vec4(right.Y(), newUp.Y(), forward.Y(), 0.0f),
+						Vec4(right.Z(), newUp.Z(), forward.Z(), 0.0f),
+						Vec4(-Dot(right, eye), -Dot(newUp, eye), -Dot(forward, eye), 1.0f));
+		}
+	};
+
+	// ((c0 * x + c1 * y) + c2 * z) + c3 * w, every matrix product below adds in this order
+	inline Vec4 operator*(const Mat4 & m, Vec4 v) {
+		Float4 result = Mul(m.Columns[0], SplatLane<0>(v.V));
+		result = MulAdd(m.Columns[1], SplatLane<1>(v.V), result);
+		result = MulAdd(m.Columns[2], SplatLane<2>(v.V), result);
+		return Vec4(MulAdd(m.Columns[3], SplatLane<3>(v.V), result));
+	}
+
+	inline Mat4 operator*(const Mat4 & a, const Mat4 & b) {
+		Mat4 result;
+		for (unsigned int i = 0; i < 4; i++)
+			result.Columns[i] = (a * Vec4(b.Columns[i])).V;
+		return result;
+	}
+
+	// w = 1, no divide by w
+	inline Vec3 TransformPoint(const Mat4 & m, Vec3 p) {
+		Float4 result = Mul(m.Columns[0], SplatLane<0>(p.V));
+		result = MulAdd(m.Columns[1], SplatLane<1>(p.V), result);
+		result = MulAdd(m.Columns[2], SplatLane<2>(p.V), result);
+		return Vec3(Add(result, m.Columns[3]));
+	}
+
+	// w = 0, ignores the translation
+	inline Vec3 TransformDirection(const Mat4 & m, Vec3 d) {
+		Float4 result = Mul(m.Columns[0], SplatLane<0>(d.V));
+		result = MulAdd(m.Columns[1], SplatLane<1>(d.V), result);
+		return Vec3(MulAdd(m.Columns[2], SplatLane<2>(d.V), result));
+	}
+
+	inline Mat4 Transpose(const Mat4 & m) {
+		float in[16];
+		m.Store(in);
+		float out[16];
+		for (unsigned int column = 0; column < 4; column++) {
+			for (unsigned int row = 0; row < 4; row++)
+				out[column * 4 + row] = in[row * 4 + column];
+		}
+		return Mat4::FromColumnMajor(out);
+	}
+
+	// Cofactors over plain floats, so every backend gives the same bits. Singular matrices give infinities
+	inline Mat4 Inverse(const Mat4 & matrix) {
+		float m[16];
+		matrix.Store(m);
+		float inv[16];
+		inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+		inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+		inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+		inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+		inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+		inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+		inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+		inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+		inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+		inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+		inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+		inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+		inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+		inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+		inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+		inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+		float determinant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+		Float4 scale = Splat4(1.0f / determinant);
+		Mat4 result = Mat4::FromColumnMajor(inv);
+		for (Float4 & column : result.Columns)
+			column = Mul(column, scale);
+		return result;
+	}
+
+	inline bool BitEqual(const Mat4 & a, const Mat4 & b) {
+		for (unsigned int i = 0; i < 4; i++) {
+			if (!BitEqual(a.Columns[i], b.Columns[i]))
+				return false;
+		}
+		return true;
+	}
+
+}
\ No newline at end of file
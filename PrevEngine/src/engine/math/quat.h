@@ -0,0 +1,87 @@
+#pragma once
+
+#include "matrix.h"
+
+namespace prev::math {
+
+	// x, y, z, w with w the real part, unit length when it is a rotation
+	struct Quat {
+		Float4 V;
+
+		// Identity
+		Quat() : V(Set4(0.0f, 0.0f, 0.0f, 1.0f)) { }
+		Quat(float x, float y, float z, float w) : V(Set4(x, y, z, w)) { }
+		explicit Quat(Float4 v) : V(v) { }
+
+		inline float X() const { return GetLane<0>(V); }
+		inline float Y() const { return GetLane<1>(V); }
+		inline float Z() const { return GetLane<2>(V); }
+		inline float W() const { return GetLane<3>(V); }
+
+		static inline Quat Identity() { return Quat(); }
+		// axis has to be unit length, angle in radians
+		static inline Quat FromAxisAngle(Vec3 axis, float angle) {
+			float half = angle * 0.5f;
+			return Quat(Vec4(axis * std::sin(half), std::cos(half)).V);
+		}
+	};
+
+	// a * b rotates by b first, then by a
+	inline Quat operator*(Quat a, Quat b) {
+		Float4 result = Mul(SplatLane<3>(a.V), b.V);
+		result = MulAdd(Mul(SplatLane<0>(a.V), Shuffle<3, 2, 1, 0>(b.V)), Set4(1.0f, -1.0f, 1.0f, -1.0f), result);
+		result = MulAdd(Mul(SplatLane<1>(a.V), Shuffle<2, 3, 0, 1>(b.V)), Set4(1.0f, 1.0f, -1.0f, -1.0f), result);
+		result = MulAdd(Mul(SplatLane<2>(a.V), Shuffle<1, 0, 3, 2>(b.V)), Set4(-1.0f, 1.0f, 1.0f, -1.0f), result);
+		return Quat(result);
+	}
+
+	inline float Dot(Quat a, Quat b) { return GetX(Dot4(a.V, b.V)); }
+	inline Quat Conjugate(Quat q) { return Quat(Mul(q.V, Set4(-1.0f, -1.0f, -1.0f, 1.0f))); }
+	inline Quat Inverse(Quat q) { return Quat(Div(Conjugate(q).V, Dot4(q.V, q.V))); }
+	inline Quat Normalize(Quat q) { return Quat(Mul(q.V, ReciprocalSqrt(Dot4(q.V, q.V)))); }
+
+	// v + w * t + u x t with t = 2 (u x v), u the vector part
+	inline Vec3 Rotate(Quat q, Vec3 v) {
+		Vec3 u(q.V);
+		Vec3 t = Cross(u, v) * 2.0f;
+		return Vec3(MulAdd(SplatLane<3>(q.V), t.V, v.V)) + Cross(u, t);
+	}
+
+	// Linear blend renormalized, takes the short way around
+	inline Quat Nlerp(Quat a, Quat b, float t) {
+		Float4 target = Dot(a, b) < 0.0f ? Neg(b.V) : b.V;
+		return Normalize(Quat(MulAdd(Sub(target, a.V), Splat4(t), a.V)));
+	}
+
+	// Constant angular speed, falls back to Nlerp when the two are almost the same rotation
+	inline Quat Slerp(Quat a, Quat b, float t) {
+		float cosAngle = Dot(a, b);
+		Float4 target = b.V;
+		if (cosAngle < 0.0f) {
+			cosAngle = -cosAngle;
+			target = Neg(target);
+		}
+		if (cosAngle > 0.9995f)
+			return Nlerp(a, Quat(target), t);
+		float angle = std::acos(cosAngle);
+		float sinAngle = std::sin(angle);
+		float wa = std::sin((1.0f - t) * angle) / sinAngle;
+		float wb = std::sin(t * angle) / sinAngle;
+		return Quat(MulAdd(a.V, Splat4(wa), Mul(target, Splat4(wb))));
+	}
+
+	// Rotation matrix of a unit quaternion
+	inline Mat4 ToMatrix(Quat q) {
+		float x = q.X(), y = q.Y(), z = q.Z(), w = q.W();
+		float xx = x * x, yy = y * y, zz = z * z;
+		float xy = x * y, xz = x * z, yz = y * z;
+		float wx = w * x, wy = w * y, wz = w * z;
+		return Mat4(Vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f),
+					Vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f),
+					Vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f),
+					Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	inline bool BitEqual(Quat a, Quat b) { return BitEqual(a.V, b.V); }
+
+}
\ No newline at end of file
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+// Backend is picked at compile time, define PV_MATH_SCALAR to force the scalar one
+//  PV_MATH_AVX2	AVX2 (and FMA when the compiler has it), Float4 uses the SSE4 path, batch kernels go 8 wide
+//  PV_MATH_SSE4	SSE4.1, MSVC only says so through /arch:AVX and up
+//  PV_MATH_NEON	AArch64 NEON
+//  PV_MATH_SCALAR	Plain floats
+//
+// PV_MATH_DETERMINISTIC makes every backend give the same bits as the scalar one
+// No FMA, no approximate reciprocals, and every sum is added in the order the scalar code adds it (NEON Min and Max on NaN aside)
+// The compiler must not contract a * b + c on its own either (-ffp-contract=off, premake --deterministic-math does it)
+#if !defined(PV_MATH_SCALAR)
+	#if defined(__AVX2__)
+		#define PV_MATH_AVX2
+		#define PV_MATH_SSE4
+	#elif defined(__SSE4_1__) || defined(__AVX__)
+		#define PV_MATH_SSE4
+	#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+		#define PV_MATH_NEON
+	#else
+		#define PV_MATH_SCALAR
+	#endif
+#endif
+
+#if defined(PV_MATH_SSE4)
+	#if defined(PV_MATH_AVX2)
+		#include <immintrin.h>
+	#else
+		#include <smmintrin.h>
+	#endif
+	#if defined(__FMA__) && !defined(PV_MATH_DETERMINISTIC)
+		#define PV_MATH_FMA
+	#endif
+#elif defined(PV_MATH_NEON)
+	#include <arm_neon.h>
+	#if !defined(PV_MATH_DETERMINISTIC)
+		#define PV_MATH_FMA
+	#endif
+#endif
+
+namespace prev::math {
+
+	// 4 floats in one register, everything in the math library is built on it
+	struct Float4 {
+	#if defined(PV_MATH_SSE4)
+		__m128 V;
+	#elif defined(PV_MATH_NEON)
+		float32x4_t V;
+	#else
+		float V[4];
+	#endif
+	};
+
+	inline const char * GetBackendName() {
+	#if defined(PV_MATH_AVX2)
+		return "avx2";
+	#elif defined(PV_MATH_SSE4)
+		return "sse4";
+	#elif defined(PV_MATH_NEON)
+		return "neon";
+	#else
+		return "scalar";
+	#endif
+	}
+
+	inline constexpr bool IsDeterministic() {
+	#if defined(PV_MATH_DETERMINISTIC)
+		return true;
+	#else
+		return false;
+	#endif
+	}
+
+#if defined(PV_MATH_SSE4)
+	inline Float4 Load4(const float * p) { return { _mm_loadu_ps(p) }; }
+	inline void Store4(float * p, Float4 a) { _mm_storeu_ps(p, a.V); }
+	inline Float4 Set4(float x, float y, float z, float w) { return { _mm_setr_ps(x, y, z, w) }; }
+	inline Float4 Splat4(float a) { return { _mm_set1_ps(a) }; }
+	inline float GetX(Float4 a) { return _mm_cvtss_f32(a.V); }
+
+	inline Float4 Add(Float4 a, Float4 b) { return { _mm_add_ps(a.V, b.V) }; }
+	inline Float4 Sub(Float4 a, Float4 b) { return { _mm_sub_ps(a.V, b.V) }; }
+	inline Float4 Mul(Float4 a, Float4 b) { return { _mm_mul_ps(a.V, b.V) }; }
+	inline Float4 Div(Float4 a, Float4 b) { return { _mm_div_ps(a.V, b.V) }; }
+	inline Float4 Min(Float4 a, Float4 b) { return { _mm_min_ps(a.V, b.V) }; }
+	inline Float4 Max(Float4 a, Float4 b) { return { _mm_max_ps(a.V, b.V) }; }
+	inline Float4 Sqrt(Float4 a) { return { _mm_sqrt_ps(a.V) }; }
+	inline Float4 Neg(Float4 a) { return { _mm_xor_ps(a.V, _mm_set1_ps(-0.0f)) }; }
+	inline Float4 Abs(Float4 a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.V) }; }
+
+	template<int X, int Y, int Z, int W>
+	inline Float4 Shuffle(Float4 a) { return { _mm_shuffle_ps(a.V, a.V, _MM_SHUFFLE(W, Z, Y, X)) }; }
+	// Lanes of a where the mask bit is clear, of b where it is set (bit 0 is x)
+	template<int Mask>
+	inline Float4 Blend(Float4 a, Float4 b) { return { _mm_blend_ps(a.V, b.V, Mask) }; }
+
+	// Masks have every bit of a lane set or clear, MoveMask gives a lane's top bit as bit n
+	inline Float4 Less(Float4 a, Float4 b) { return { _mm_cmplt_ps(a.V, b.V) }; }
+	inline Float4 Or(Float4 a, Float4 b) { return { _mm_or_ps(a.V, b.V) }; }
+	inline int MoveMask(Float4 a) { return _mm_movemask_ps(a.V); }
+#elif defined(PV_MATH_NEON)
+	inline Float4 Load4(const float * p) { return { vld1q_f32(p) }; }
+	inline void Store4(float * p, Float4 a) { vst1q_f32(p, a.V); }
+	inline Float4 Set4(float x, float y, float z, float w) { const float v[4] = { x, y, z, w }; return { vld1q_f32(v) }; }
+	inline Float4 Splat4(float a) { return { vdupq_n_f32(a) }; }
+	inline float GetX(Float4 a) { return vgetq_lane_f32(a.V, 0); }
+
+	inline Float4 Add(Float4 a, Float4 b) { return { vaddq_f32(a.V, b.V) }; }
+	inline Float4 Sub(Float4 a, Float4 b) { return { vsubq_f32(a.V, b.V) }; }
+	inline Float4 Mul(Float4 a, Float4 b) { return { vmulq_f32(a.V, b.V) }; }
+	inline Float4 Div(Float4 a, Float4 b) { return { vdivq_f32(a.V, b.V) }; }
+	inline Float4 Min(Float4 a, Float4 b) { return { vminq_f32(a.V, b.V) }; }
+	inline Float4 Max(Float4 a, Float4 b) { return { vmaxq_f32(a.V, b.V) }; }
+	inline Float4 Sqrt(Float4 a) { return { vsqrtq_f32(a.V) }; }
+	inline Float4 Neg(Float4 a) { return { vnegq_f32(a.V) }; }
+	inline Float4 Abs(Float4 a) { return { vabsq_f32(a.V) }; }
+
+	template<int X, int Y, int Z, int W>
+	inline Float4 Shuffle(Float4 a) {
+	#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 12)
+		return { __builtin_shufflevector(a.V, a.V, X, Y, Z, W) };
+	#else
+		float v[4];
+		vst1q_f32(v, a.V);
+		return Set4(v[X], v[Y], v[Z], v[W]);
+	#endif
+	}
+	template<int Mask>
+	inline Float4 Blend(Float4 a, Float4 b) {
+		const uint32_t bits[4] = { (Mask & 1) ? ~0u : 0u, (Mask & 2) ? ~0u : 0u, (Mask & 4) ? ~0u : 0u, (Mask & 8) ? ~0u : 0u };
+		return { vbslq_f32(vld1q_u32(bits), b.V, a.V) };
+	}
+
+	inline Float4 Less(Float4 a, Float4 b) { return { vreinterpretq_f32_u32(vcltq_f32(a.V, b.V)) }; }
+	inline Float4 Or(Float4 a, Float4 b) { return { vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.V), vreinterpretq_u32_f32(b.V))) }; }
+	inline int MoveMask(Float4 a) {
+		const uint32_t weights[4] = { 1, 2, 4, 8 };
+		return (int)vaddvq_u32(vmulq_u32(vshrq_n_u32(vreinterpretq_u32_f32(a.V), 31), vld1q_u32(weights)));
+	}
+#else
+	inline Float4 Load4(const float * p) { return { { p[0], p[1], p[2], p[3] } }; }
+	inline void Store4(float * p, Float4 a) { p[0] = a.V[0]; p[1] = a.V[1]; p[2] = a.V[2]; p[3] = a.V[3]; }
+	inline Float4 Set4(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+	inline Float4 Splat4(float a) { return { { a, a, a, a } }; }
+	inline float GetX(Float4 a) { return a.V[0]; }
+
+	inline Float4 Add(Float4 a, Float4 b) { return { { a.V[0] + b.V[0], a.V[1] + b.V[1], a.V[2] + b.V[2], a.V[3] + b.V[3] } }; }
+	inline Float4 Sub(Float4 a, Float4 b) { return { { a.V[0] - b.V[0], a.V[1] - b.V[1], a.V[2] - b.V[2], a.V[3] - b.V[3] } }; }
+	inline Float4 Mul(Float4 a, Float4 b) { return { { a.V[0] * b.V[0], a.V[1] * b.V[1], a.V[2] * b.V[2], a.V[3] * b.V[3] } }; }
+	inline Float4 Div(Float4 a, Float4 b) { return { { a.V[0] / b.V[0], a.V[1] / b.V[1], a.V[2] / b.V[2], a.V[3] / b.V[3] } }; }
+	// Second operand on NaN, like minps and maxps
+	inline Float4 Min(Float4 a, Float4 b) {
+		return { { a.V[0] < b.V[0] ? a.V[0] : b.V[0], a.V[1] < b.V[1] ? a.V[1] : b.V[1], a.V[2] < b.V[2] ? a.V[2] : b.V[2], a.V[3] < b.V[3] ? a.V[3] : b.V[3] } };
+	}
+	inline Float4 Max(Float4 a, Float4 b) {
+		return { { a.V[0] > b.V[0] ? a.V[0] : b.V[0], a.V[1] > b.V[1] ? a.V[1] : b.V[1], a.V[2] > b.V[2] ? a.V[2] : b.V[2], a.V[3] > b.V[3] ? a.V[3] : b.V[3] } };
+	}
+	inline Float4 Sqrt(Float4 a) { return { { std::sqrt(a.V[0]), std::sqrt(a.V[1]), std::sqrt(a.V[2]), std::sqrt(a.V[3]) } }; }
+	inline Float4 Neg(Float4 a) { return { { -a.V[0], -a.V[1], -a.V[2], -a.V[3] } }; }
+	inline Float4 Abs(Float4 a) { return { { std::fabs(a.V[0]), std::fabs(a.V[1]), std::fabs(a.V[2]), std::fabs(a.V[3]) } }; }
+
+	template<int X, int Y, int Z, int W>
+	inline Float4 Shuffle(Float4 a) { return { { a.V[X], a.V[Y], a.V[Z], a.V[W] } }; }
+	template<int Mask>
+	inline Float4 Blend(Float4 a, Float4 b) {
+		return { { (Mask & 1) ? b.V[0] : a.V[0], (Mask & 2) ? b.V[1] : a.V[1], (Mask & 4) ? b.V[2] : a.V[2], (Mask & 8) ? b.V[3] : a.V[3] } };
+	}
+
+	// Mask lanes are bit patterns (a set lane reads as a NaN), so they only move through memcpy
+	inline Float4 Less(Float4 a, Float4 b) {
+		Float4 result;
+		for (unsigned int lane = 0; lane < 4; lane++) {
+			unsigned int bits = a.V[lane] < b.V[lane] ? ~0u : 0u;
+			std::memcpy(&result.V[lane], &bits, sizeof(bits));
+		}
+		return result;
+	}
+	inline Float4 Or(Float4 a, Float4 b) {
+		unsigned int x[4], y[4];
+		std::memcpy(x, a.V, sizeof(x));
+		std::memcpy(y, b.V, sizeof(y));
+		for (unsigned int lane = 0; lane < 4; lane++)
+			x[lane] |= y[lane];
+		Float4 result;
+		std::memcpy(result.V, x, sizeof(x));
+		return result;
+	}
+	inline int MoveMask(Float4 a) {
+		unsigned int x[4];
+		std::memcpy(x, a.V, sizeof(x));
+		return (int)((x[0] >> 31) | ((x[1] >> 31) << 1) | ((x[2] >> 31) << 2) | ((x[3] >> 31) << 3));
+	}
+#endif
+
+	inline Float4 Zero4() { return Splat4(0.0f); }
+	template<int Lane>
+	inline float GetLane(Float4 a) { return GetX(Shuffle<Lane, Lane, Lane, Lane>(a)); }
+	template<int Lane>
+	inline Float4 SplatLane(Float4 a) { return Shuffle<Lane, Lane, Lane, Lane>(a); }
+
+	// a * b + c, fused (one rounding) where the backend has it and the build isn't deterministic
+	inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) {
+	#if defined(PV_MATH_FMA) && defined(PV_MATH_SSE4)
+		return { _mm_fmadd_ps(a.V, b.V, c.V) };
+	#elif defined(PV_MATH_FMA) && defined(PV_MATH_NEON)
+		return { vfmaq_f32(c.V, a.V, b.V) };
+	#else
+		return Add(Mul(a, b), c);
+	#endif
+	}
+
+	// Sums in every lane, (x + y) + z and (x + y) + (z + w)
+	inline Float4 Dot3(Float4 a, Float4 b) {
+	#if defined(PV_MATH_SSE4) && !defined(PV_MATH_DETERMINISTIC)
+		return { _mm_dp_ps(a.V, b.V, 0x7F) };
+	#else
+		Float4 m = Mul(a, b);
+		return Add(Add(SplatLane<0>(m), SplatLane<1>(m)), SplatLane<2>(m));
+	#endif
+	}
+
+	inline Float4 Dot4(Float4 a, Float4 b) {
+	#if defined(PV_MATH_SSE4) && !defined(PV_MATH_DETERMINISTIC)
+		return { _mm_dp_ps(a.V, b.V, 0xFF) };
+	#else
+		Float4 m = Mul(a, b);
+		Float4 pairs = Add(m, Shuffle<1, 0, 3, 2>(m));
+		return Add(SplatLane<0>(pairs), SplatLane<2>(pairs));
+	#endif
+	}
+
+	// 1 / sqrt(a), a Newton step on the hardware estimate unless the build is deterministic
+	inline Float4 ReciprocalSqrt(Float4 a) {
+	#if defined(PV_MATH_SSE4) && !defined(PV_MATH_DETERMINISTIC)
+		__m128 estimate = _mm_rsqrt_ps(a.V);
+		__m128 half = _mm_mul_ps(_mm_set1_ps(0.5f), a.V);
+		__m128 step = _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(half, _mm_mul_ps(estimate, estimate)));
+		return { _mm_mul_ps(estimate, step) };
+	#elif defined(PV_MATH_NEON) && !defined(PV_MATH_DETERMINISTIC)
+		float32x4_t estimate = vrsqrteq_f32(a.V);
+		estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(a.V, estimate), estimate));
+		return { vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(a.V, estimate), estimate)) };
+	#else
+		return Div(Splat4(1.0f), Sqrt(a));
+	#endif
+	}
+
+	// Bitwise, so -0 and +0 differ and NaNs can be equal
+	inline bool BitEqual(Float4 a, Float4 b) {
+		float x[4], y[4];
+		Store4(x, a);
+		Store4(y, b);
+		return std::memcmp(x, y, sizeof(x)) == 0;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "simd.h"
+
+namespace prev::math {
+
+	// x, y, z in a register, the fourth lane is unused and never read
+	struct Vec3 {
+		Float4 V;
+
+		Vec3() : V(Zero4()) { }
+		Vec3(float x, float y, float z) : V(Set4(x, y, z, 0.0f)) { }
+		explicit Vec3(float s) : V(Set4(s, s, s, 0.0f)) { }
+		explicit Vec3(Float4 v) : V(v) { }
+
+		inline float X() const { return GetLane<0>(V); }
+		inline float Y() const { return GetLane<1>(V); }
+		inline float Z() const { return GetLane<2>(V); }
+
+		inline Vec3 & operator+=(Vec3 b) { V = Add(V, b.V); return *this; }
+		inline Vec3 & operator-=(Vec3 b) { V = Sub(V, b.V); return *this; }
+		inline Vec3 & operator*=(float s) { V = Mul(V, Splat4(s)); return *this; }
+		inline Vec3 & operator/=(float s) { V = Div(V, Splat4(s)); return *this; }
+	};
+
+	struct Vec4 {
+		Float4 V;
+
+		Vec4() : V(Zero4()) { }
+		Vec4(float x, float y, float z, float w) : V(Set4(x, y, z, w)) { }
+		Vec4(Vec3 xyz, float w) : V(Blend<0x8>(xyz.V, Splat4(w))) { }
+		explicit Vec4(float s) : V(Splat4(s)) { }
+		explicit Vec4(Float4 v) : V(v) { }
+
+		inline float X() const { return GetLane<0>(V); }
+		inline float Y() const { return GetLane<1>(V); }
+		inline float Z() const { return GetLane<2>(V); }
+		inline float W() const { return GetLane<3>(V); }
+		inline Vec3 XYZ() const { return Vec3(V); }
+
+		inline Vec4 & operator+=(Vec4 b) { V = Add(V, b.V); return *this; }
+		inline Vec4 & operator-=(Vec4 b) { V = Sub(V, b.V); return *this; }
+		inline Vec4 & operator*=(float s) { V = Mul(V, Splat4(s)); return *this; }
+		inline Vec4 & operator/=(float s) { V = Div(V, Splat4(s)); return *this; }
+	};
+
+	inline Vec3 operator+(Vec3 a, Vec3 b) { return Vec3(Add(a.V, b.V)); }
+	inline Vec3 operator-(Vec3 a, Vec3 b) { return Vec3(Sub(a.V, b.V)); }
+	inline Vec3 operator-(Vec3 a) { return Vec3(Neg(a.V)); }
+	inline Vec3 operator*(Vec3 a, Vec3 b) { return Vec3(Mul(a.V, b.V)); }
+	inline Vec3 operator*(Vec3 a, float s) { return Vec3(Mul(a.V, Splat4(s))); }
+	inline Vec3 operator*(float s, Vec3 a) { return Vec3(Mul(Splat4(s), a.V)); }
+	inline Vec3 operator/(Vec3 a, float s) { return Vec3(Div(a.V, Splat4(s))); }
+
+	inline Vec4 operator+(Vec4 a, Vec4 b) { return Vec4(Add(a.V, b.V)); }
+	inline Vec4 operator-(Vec4 a, Vec4 b) { return Vec4(Sub(a.V, b.V)); }
+	inline Vec4 operator-(Vec4 a) { return Vec4(Neg(a.V)); }
+	inline Vec4 operator*(Vec4 a, Vec4 b) { return Vec4(Mul(a.V, b.V)); }
+	inline Vec4 operator*(Vec4 a, float s) { return Vec4(Mul(a.V, Splat4(s))); }
+	inline Vec4 operator*(float s, Vec4 a) { return Vec4(Mul(Splat4(s), a.V)); }
+	inline Vec4 operator/(Vec4 a, float s) { return Vec4(Div(a.V, Splat4(s))); }
+
+	inline float Dot(Vec3 a, Vec3 b) { return GetX(Dot3(a.V, b.V)); }
+	inline float Dot(Vec4 a, Vec4 b) { return GetX(Dot4(a.V, b.V)); }
+
+	inline Vec3 Cross(Vec3 a, Vec3 b) {
+		Float4 left = Mul(Shuffle<1, 2, 0, 3>(a.V), Shuffle<2, 0, 1, 3>(b.V));
+		Float4 right = Mul(Shuffle<2, 0, 1, 3>(a.V), Shuffle<1, 2, 0, 3>(b.V));
+		return Vec3(Sub(left, right));
+	}
+
+	inline float LengthSquared(Vec3 a) { return Dot(a, a); }
+	inline float LengthSquared(Vec4 a) { return Dot(a, a); }
+	inline float Length(Vec3 a) { return GetX(Sqrt(Dot3(a.V, a.V))); }
+	inline float Length(Vec4 a) { return GetX(Sqrt(Dot4(a.V, a.V))); }
+
+	// Zero length vectors come back as NaNs
+	inline Vec3 Normalize(Vec3 a) { return Vec3(Mul(a.V, ReciprocalSqrt(Dot3(a.V, a.V)))); }
+	inline Vec4 Normalize(Vec4 a) { return Vec4(Mul(a.V, ReciprocalSqrt(Dot4(a.V, a.V)))); }
+
+	inline Vec3 Min(Vec3 a, Vec3 b) { return Vec3(Min(a.V, b.V)); }
+	inline Vec3 Max(Vec3 a, Vec3 b) { return Vec3(Max(a.V, b.V)); }
+	inline Vec4 Min(Vec4 a, Vec4 b) { return Vec4(Min(a.V, b.V)); }
+	inline Vec4 Max(Vec4 a, Vec4 b) { return Vec4(Max(a.V, b.V)); }
+
+	// a + (b - a) * t
+	inline Vec3 Lerp(Vec3 a, Vec3 b, float t) { return Vec3(MulAdd(Sub(b.V, a.V), Splat4(t), a.V)); }
+	inline Vec4 Lerp(Vec4 a, Vec4 b, float t) { return Vec4(MulAdd(Sub(b.V, a.V), Splat4(t), a.V)); }
+
+	// Only the lanes the type uses, bit for bit
+	inline bool BitEqual(Vec3 a, Vec3 b) { return BitEqual(Blend<0x8>(a.V, Zero4()), Blend<0x8>(b.V, Zero4())); }
+	inline bool BitEqual(Vec4 a, Vec4 b) { return BitEqual(a.V, b.V); }
+
+}
\ No newline at end of file
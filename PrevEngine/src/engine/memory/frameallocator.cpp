@@ -0,0 +1,124 @@
+#include "pch.h"
+#include "frameallocator.h"
+
+namespace prev {
+
+	static const size_t s_BlockAlignment = 64;
+
+	FrameArena::FrameArena(size_t capacity) :
+		m_Capacity(capacity) {
+		m_Block = (char *)MemAlloc(m_Capacity, MemTag::Frame, s_BlockAlignment);
+	}
+
+	FrameArena::~FrameArena() {
+		Reset();
+		MemFree(m_Block, s_BlockAlignment);
+	}
+
+	void * FrameArena::do_allocate(size_t bytes, size_t alignment) {
+		m_Allocations.fetch_add(1, std::memory_order_relaxed);
+		m_Bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+		size_t offset = m_Offset.load(std::memory_order_relaxed);
+		while (true) {
+			size_t aligned = (((size_t)m_Block + offset + alignment - 1) & ~(alignment - 1)) - (size_t)m_Block;
+			if (aligned + bytes > m_Capacity)
+				break;
+			if (m_Offset.compare_exchange_weak(offset, aligned + bytes, std::memory_order_relaxed))
+				return m_Block + aligned;
+		}
+
+		// Full, the heap keeps it alive until Reset
+		void * ptr = MemAlloc(bytes, MemTag::Frame, alignment);
+		std::lock_guard<std::mutex> lock(m_OverflowMutex);
+		m_OverflowBlocks.push_back({ ptr, alignment });
+		m_OverflowBytes += bytes;
+		return ptr;
+	}
+
+	void FrameArena::Reset() {
+		std::lock_guard<std::mutex> lock(m_OverflowMutex);
+		for (auto & block : m_OverflowBlocks)
+			MemFree(block.Ptr, block.Alignment);
+
+		// Grow so a frame like this one fits next time
+		if (!m_OverflowBlocks.empty()) {
+			size_t needed = m_Offset.load(std::memory_order_relaxed) + m_OverflowBytes + m_OverflowBlocks.size() * s_BlockAlignment;
+			size_t capacity = m_Capacity;
+			while (capacity < needed)
+				capacity *= 2;
+			MemFree(m_Block, s_BlockAlignment);
+			m_Block = (char *)MemAlloc(capacity, MemTag::Frame, s_BlockAlignment);
+			m_Capacity = capacity;
+		}
+
+		m_OverflowBlocks.clear();
+		m_OverflowBytes = 0;
+		m_Offset.store(0, std::memory_order_relaxed);
+		m_Allocations.store(0, std::memory_order_relaxed);
+		m_Bytes.store(0, std::memory_order_relaxed);
+	}
+
+	FrameAllocatorStats FrameArena::GetStats() const {
+		FrameAllocatorStats stats;
+		stats.Allocations = m_Allocations.load(std::memory_order_relaxed);
+		stats.Bytes = m_Bytes.load(std::memory_order_relaxed);
+		stats.Used = m_Offset.load(std::memory_order_relaxed);
+		stats.Capacity = m_Capacity;
+		// Other threads may be overflowing right now
+		std::lock_guard<std::mutex> lock(m_OverflowMutex);
+		stats.Overflows = m_OverflowBlocks.size();
+		stats.OverflowBytes = m_OverflowBytes;
+		return stats;
+	}
+
+	FrameAllocator * FrameAllocator::s_Current = nullptr;
+
+	FrameAllocator::FrameAllocator(size_t capacityPerFrame) {
+		for (auto & arena : m_Arenas)
+			arena = std::make_unique<FrameArena>(capacityPerFrame);
+	}
+
+	FrameAllocator::~FrameAllocator() {
+		if (s_Current == this)
+			s_Current = nullptr;
+	}
+
+	void FrameAllocator::BeginFrame(unsigned long long frameIndex) {
+		m_LastFrameStats = m_Arenas[m_Current]->GetStats();
+		m_TotalOverflows += m_LastFrameStats.Overflows;
+
+		m_Current = (unsigned int)(frameIndex % BufferCount);
+		m_Arenas[m_Current]->Reset();
+		s_Current = this;
+	}
+
+	FrameAllocatorStats FrameAllocator::GetStats() const {
+		return m_Arenas[m_Current]->GetStats();
+	}
+
+	std::pmr::memory_resource * FrameAllocator::GetResource() {
+		if (s_Current == nullptr)
+			return std::pmr::new_delete_resource();
+		return s_Current->GetFrameResource();
+	}
+
+	FrameString FrameFormat(const char * format, ...) {
+		char buffer[256];
+		va_list args;
+		va_start(args, format);
+		int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+		if (length < 0)
+			return MakeFrameString();
+		if ((size_t)length < sizeof(buffer))
+			return FrameString(buffer, (size_t)length, FrameAllocator::GetResource());
+
+		FrameString str((size_t)length, '\0', FrameAllocator::GetResource());
+		va_start(args, format);
+		std::vsnprintf(str.data(), (size_t)length + 1, format, args);
+		va_end(args);
+		return str;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <memory>
+
+#include "memorytracker.h"
+
+namespace prev {
+
+	struct FrameAllocatorStats {
+		unsigned long long Allocations = 0;
+		unsigned long long Bytes = 0;			// Requested, without alignment padding
+		unsigned long long Used = 0;			// Bytes taken from the block, with padding
+		unsigned long long Capacity = 0;
+		unsigned long long Overflows = 0;		// Allocations that didn't fit and went to the heap
+		unsigned long long OverflowBytes = 0;
+	};
+
+	// Linear allocator, allocating is an atomic bump so any thread can use it. Deallocate does nothing, Reset frees everything
+	// What doesn't fit goes to the heap until the next Reset, which grows the block so it fits next time
+	class FrameArena : public std::pmr::memory_resource {
+	public:
+		FrameArena(size_t capacity);
+		~FrameArena();
+
+		FrameArena(const FrameArena &) = delete;
+		FrameArena & operator=(const FrameArena &) = delete;
+
+		// Nothing allocated from it may be used after this
+		void Reset();
+		FrameAllocatorStats GetStats() const;
+	private:
+		virtual void * do_allocate(size_t bytes, size_t alignment) override;
+		virtual void do_deallocate(void * ptr, size_t bytes, size_t alignment) override {}
+		virtual bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override { return this == &other; }
+	private:
+		struct OverflowBlock {
+			void * Ptr;
+			size_t Alignment;
+		};
+
+		char * m_Block = nullptr;
+		size_t m_Capacity = 0;
+		std::atomic<size_t> m_Offset{ 0 };
+		std::atomic<unsigned long long> m_Allocations{ 0 };
+		std::atomic<unsigned long long> m_Bytes{ 0 };
+
+		mutable std::mutex m_OverflowMutex;	// Guards the two below
+		std::vector<OverflowBlock> m_OverflowBlocks;
+		unsigned long long m_OverflowBytes = 0;
+	};
+
+	// One arena per frame in flight, so render commands of frame N can still read frame memory while N + 1 and N + 2 simulate
+	// The application resets the arena of the new frame at the top of Run
+	class FrameAllocator {
+	public:
+		static const unsigned int BufferCount = 3;
+	public:
+		FrameAllocator(size_t capacityPerFrame = 1 << 20);
+		~FrameAllocator();
+
+		FrameAllocator(const FrameAllocator &) = delete;
+		FrameAllocator & operator=(const FrameAllocator &) = delete;
+
+		// Resets the arena the frame reuses and makes this the allocator GetResource hands out
+		void BeginFrame(unsigned long long frameIndex);
+		inline std::pmr::memory_resource * GetFrameResource() { return m_Arenas[m_Current].get(); }
+
+		FrameAllocatorStats GetStats() const;
+		inline const FrameAllocatorStats & GetLastFrameStats() const { return m_LastFrameStats; }
+		// Since the allocator was created, a steady state frame should never overflow
+		inline unsigned long long GetTotalOverflows() const { return m_TotalOverflows; }
+
+		// Memory of the current frame, the heap when no application is running frames
+		static std::pmr::memory_resource * GetResource();
+	private:
+		std::array<std::unique_ptr<FrameArena>, BufferCount> m_Arenas;
+		unsigned int m_Current = 0;
+		FrameAllocatorStats m_LastFrameStats;
+		unsigned long long m_TotalOverflows = 0;
+
+		static FrameAllocator * s_Current;
+	};
+
+	// Only valid until the end of the frame (a few frames for render commands), never keep them in a member
+	template<typename T>
+	using FrameVector = std::pmr::vector<T>;
+	using FrameString = std::pmr::string;
+
+	template<typename T>
+	inline FrameVector<T> MakeFrameVector() {
+		return FrameVector<T>(FrameAllocator::GetResource());
+	}
+
+	inline FrameString MakeFrameString(const char * str = "") {
+		return FrameString(str, FrameAllocator::GetResource());
+	}
+
+	// printf into frame memory
+	FrameString FrameFormat(const char * format, ...);
+
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "pch.h"
+#include "memorytracker.h"
+
+#ifdef PV_MEMORY_TRACKING_ENABLED
+
+namespace prev {
+
+	// Right in front of every tracked pointer, Offset walks back to what operator new returned
+	struct MemHeader {
+		unsigned long long Size;
+		unsigned int Offset;
+		MemTag Tag;
+	};
+
+	static const size_t s_HeaderSize = 16;
+	static_assert(sizeof(MemHeader) <= s_HeaderSize, "MemHeader must fit in front of a default aligned pointer");
+
+	static const unsigned int s_TagCount = (unsigned int)MemTag::Count;
+
+	static const char * s_TagNames[s_TagCount] = {
+		"General", "Log", "Console", "Layer", "Event", "ImGui", "Frame", "Render", "Entity"
+	};
+
+	// Constant initialized, so allocations made before main are counted too
+	struct MemTagCounters {
+		std::atomic<unsigned long long> LiveBytes{ 0 };
+		std::atomic<unsigned long long> PeakBytes{ 0 };
+		std::atomic<unsigned long long> LiveAllocations{ 0 };
+		std::atomic<unsigned long long> TotalAllocations{ 0 };
+		std::atomic<float> AllocationsPerSecond{ 0.0f };
+	};
+
+	static MemTagCounters s_Counters[s_TagCount];
+
+	// Main thread only, see Update
+	static unsigned long long s_RateTotals[s_TagCount];
+	static double s_RateStart = -1.0;
+
+	void * MemoryTracker::Allocate(size_t size, MemTag tag, size_t alignment) {
+		// Goes through operator new so tools that count heap allocations still see it
+		size_t extra = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? alignment : 0;
+		char * raw = (char *)::operator new(size + s_HeaderSize + extra);
+		char * ptr = (char *)(((size_t)raw + s_HeaderSize + alignment - 1) & ~(alignment - 1));
+
+		MemHeader * header = (MemHeader *)(ptr - s_HeaderSize);
+		header->Size = size;
+		header->Offset = (unsigned int)(ptr - raw);
+		header->Tag = tag;
+
+		MemTagCounters & counters = s_Counters[(unsigned int)tag];
+		unsigned long long live = counters.LiveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+		counters.LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+		counters.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		unsigned long long peak = counters.PeakBytes.load(std::memory_order_relaxed);
+		while (live > peak && !counters.PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+
+		return ptr;
+	}
+
+	void MemoryTracker::Free(void * ptr) {
+		if (ptr == nullptr)
+			return;
+
+		MemHeader * header = (MemHeader *)((char *)ptr - s_HeaderSize);
+		MemTagCounters & counters = s_Counters[(unsigned int)header->Tag];
+		counters.LiveBytes.fetch_sub(header->Size, std::memory_order_relaxed);
+		counters.LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+		::operator delete((char *)ptr - header->Offset);
+	}
+
+	void MemoryTracker::Update() {
+		double now = Timer::GetTimeSeconds();
+		if (s_RateStart < 0.0) {
+			for (unsigned int i = 0; i < s_TagCount; i++)
+				s_RateTotals[i] = s_Counters[i].TotalAllocations.load(std::memory_order_relaxed);
+			s_RateStart = now;
+			return;
+		}
+
+		double elapsed = now - s_RateStart;
+		if (elapsed < 1.0)
+			return;
+
+		for (unsigned int i = 0; i < s_TagCount; i++) {
+			unsigned long long total = s_Counters[i].TotalAllocations.load(std::memory_order_relaxed);
+			s_Counters[i].AllocationsPerSecond.store((float)((total - s_RateTotals[i]) / elapsed), std::memory_order_relaxed);
+			s_RateTotals[i] = total;
+		}
+		s_RateStart = now;
+	}
+
+	MemTagStats MemoryTracker::GetStats(MemTag tag) {
+		const MemTagCounters & counters = s_Counters[(unsigned int)tag];
+		MemTagStats stats;
+		stats.LiveBytes = counters.LiveBytes.load(std::memory_order_relaxed);
+		stats.PeakBytes = counters.PeakBytes.load(std::memory_order_relaxed);
+		stats.LiveAllocations = counters.LiveAllocations.load(std::memory_order_relaxed);
+		stats.TotalAllocations = counters.TotalAllocations.load(std::memory_order_relaxed);
+		stats.AllocationsPerSecond = counters.AllocationsPerSecond.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	MemTagStats MemoryTracker::GetTotalStats() {
+		// Peaks of different tags can happen at different times, so the total peak is an upper bound
+		MemTagStats total;
+		for (unsigned int i = 0; i < s_TagCount; i++) {
+			MemTagStats stats = GetStats((MemTag)i);
+			total.LiveBytes += stats.LiveBytes;
+			total.PeakBytes += stats.PeakBytes;
+			total.LiveAllocations += stats.LiveAllocations;
+			total.TotalAllocations += stats.TotalAllocations;
+			total.AllocationsPerSecond += stats.AllocationsPerSecond;
+		}
+		return total;
+	}
+
+	const char * MemoryTracker::GetTagName(MemTag tag) {
+		if ((unsigned int)tag >= s_TagCount)
+			return "Unknown";
+		return s_TagNames[(unsigned int)tag];
+	}
+
+	void MemoryTracker::ResetPeaks() {
+		for (auto & counters : s_Counters)
+			counters.PeakBytes.store(counters.LiveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	void MemoryTracker::LogStats() {
+		PV_LOG_INFO("%-8s %12s %12s %10s %12s %10s", "Tag", "Live KB", "Peak KB", "Live", "Total", "Allocs/s");
+		for (unsigned int i = 0; i < s_TagCount; i++) {
+			MemTagStats stats = GetStats((MemTag)i);
+			PV_LOG_INFO("%-8s %12.1f %12.1f %10llu %12llu %10.1f", s_TagNames[i], stats.LiveBytes / 1024.0, stats.PeakBytes / 1024.0,
+						stats.LiveAllocations, stats.TotalAllocations, stats.AllocationsPerSecond);
+		}
+		MemTagStats total = GetTotalStats();
+		PV_LOG_INFO("%-8s %12.1f %12.1f %10llu %12llu %10.1f", "Total", total.LiveBytes / 1024.0, total.PeakBytes / 1024.0,
+					total.LiveAllocations, total.TotalAllocations, total.AllocationsPerSecond);
+	}
+
+	void * MemoryTracker::ImGuiAlloc(size_t size, void * userData) {
+		return Allocate(size, MemTag::ImGui);
+	}
+
+	void MemoryTracker::ImGuiFree(void * ptr, void * userData) {
+		Free(ptr);
+	}
+
+}
+
+#endif
\ No newline at end of file
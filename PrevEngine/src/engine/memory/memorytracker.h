@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <new>
+
+#ifndef PV_DIST
+	#define PV_MEMORY_TRACKING_ENABLED
+#endif
+
+namespace prev {
+
+	// Who owns an allocation, add new tags before Count
+	enum class MemTag : unsigned char {
+		General,
+		Log,
+		Console,
+		Layer,
+		Event,
+		ImGui,
+		Frame,
+		Render,
+		Entity,
+		Count
+	};
+
+	static const size_t MemDefaultAlignment = alignof(std::max_align_t);
+
+#ifdef PV_MEMORY_TRACKING_ENABLED
+
+	struct MemTagStats {
+		unsigned long long LiveBytes = 0;
+		unsigned long long PeakBytes = 0;
+		unsigned long long LiveAllocations = 0;
+		unsigned long long TotalAllocations = 0;
+		float AllocationsPerSecond = 0.0f;	// Over the last full second
+	};
+
+	// Every tagged allocation carries a small header with its size and tag, counters are per tag atomics
+	// Allocate and Free are safe to use from any thread
+	class MemoryTracker {
+	public:
+		static void * Allocate(size_t size, MemTag tag, size_t alignment = MemDefaultAlignment);
+		static void Free(void * ptr);
+
+		// Once per frame on the main thread, refreshes the allocation rates every second
+		static void Update();
+
+		static MemTagStats GetStats(MemTag tag);
+		static MemTagStats GetTotalStats();
+		static const char * GetTagName(MemTag tag);
+		// Peaks start over from what is live now
+		static void ResetPeaks();
+		static void LogStats();
+
+		// For ImGui::SetAllocatorFunctions
+		static void * ImGuiAlloc(size_t size, void * userData);
+		static void ImGuiFree(void * ptr, void * userData);
+	};
+
+	inline void * MemAlloc(size_t size, MemTag tag, size_t alignment = MemDefaultAlignment) {
+		return MemoryTracker::Allocate(size, tag, alignment);
+	}
+
+	// The header knows the alignment, it's only needed when tracking is compiled out
+	inline void MemFree(void * ptr, size_t alignment = MemDefaultAlignment) {
+		MemoryTracker::Free(ptr);
+	}
+
+#else
+
+	inline void * MemAlloc(size_t size, MemTag tag, size_t alignment = MemDefaultAlignment) {
+		if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+			return ::operator new(size, std::align_val_t(alignment));
+		return ::operator new(size);
+	}
+
+	inline void MemFree(void * ptr, size_t alignment = MemDefaultAlignment) {
+		if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+			::operator delete(ptr, std::align_val_t(alignment));
+		else
+			::operator delete(ptr);
+	}
+
+#endif
+
+	// For std containers, e.g. TaggedVector<char, MemTag::Log>
+	template<typename T, MemTag Tag>
+	struct TaggedAllocator {
+		using value_type = T;
+		template<typename U>
+		struct rebind {
+			using other = TaggedAllocator<U, Tag>;
+		};
+
+		TaggedAllocator() noexcept = default;
+		template<typename U>
+		TaggedAllocator(const TaggedAllocator<U, Tag> &) noexcept {}
+
+		T * allocate(size_t count) { return (T *)MemAlloc(count * sizeof(T), Tag, alignof(T)); }
+		void deallocate(T * ptr, size_t count) noexcept { MemFree(ptr, alignof(T)); }
+
+		template<typename U>
+		bool operator==(const TaggedAllocator<U, Tag> &) const noexcept { return true; }
+		template<typename U>
+		bool operator!=(const TaggedAllocator<U, Tag> &) const noexcept { return false; }
+	};
+
+	template<typename T, MemTag Tag>
+	using TaggedVector = std::vector<T, TaggedAllocator<T, Tag>>;
+	template<MemTag Tag>
+	using TaggedString = std::basic_string<char, std::char_traits<char>, TaggedAllocator<char, Tag>>;
+
+}
+
+// Inside a class, makes new / delete of it and everything deriving from it count under the tag
+#define PV_MEMORY_TAG_CLASS(tag)\
+	static void * operator new(size_t size) { return prev::MemAlloc(size, tag); }\
+	static void operator delete(void * ptr) { prev::MemFree(ptr); }
@@ -0,0 +1,237 @@
+#include "pch.h"
+#include "poolallocator.h"
+
+namespace prev {
+
+	// Shared by every pool, an exiting thread gives its index back so short lived threads don't use them all up
+	// The next thread with the index also gets the blocks left in its caches, they are still free blocks of those pools
+	static std::mutex s_ThreadIndexMutex;
+	static std::vector<unsigned int> s_FreeThreadIndices;
+	static unsigned int s_NextThreadIndex = 0;
+
+	struct ThreadIndex {
+		unsigned int Index = ~0u;
+
+		~ThreadIndex() {
+			if (Index == ~0u)
+				return;
+			std::lock_guard<std::mutex> lock(s_ThreadIndexMutex);
+			s_FreeThreadIndices.push_back(Index);
+		}
+
+		unsigned int Get() {
+			if (Index == ~0u) {
+				std::lock_guard<std::mutex> lock(s_ThreadIndexMutex);
+				if (!s_FreeThreadIndices.empty()) {
+					Index = s_FreeThreadIndices.back();
+					s_FreeThreadIndices.pop_back();
+				} else {
+					Index = s_NextThreadIndex++;
+				}
+			}
+			return Index;
+		}
+	};
+
+	static thread_local ThreadIndex t_ThreadIndex;
+
+	static size_t AlignUp(size_t value, size_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	FixedPool::FixedPool(size_t blockSize, size_t alignment, const PoolDesc & desc) :
+		m_Alignment(std::max(alignment, alignof(FreeBlock))), m_Desc(desc) {
+		m_BlockSize = AlignUp(std::max(blockSize, sizeof(FreeBlock)), m_Alignment);
+		m_SlabHeaderSize = AlignUp(sizeof(void *), m_Alignment);
+		if (m_Desc.BlocksPerSlab == 0)
+			m_Desc.BlocksPerSlab = 1;
+		if (m_Desc.ThreadCaches)
+			m_Caches = std::make_unique<ThreadCache[]>(MaxThreadCaches);
+	}
+
+	FixedPool::~FixedPool() {
+		// Blocks sitting in thread caches live in the slabs too, nothing else to give back
+		while (m_Slabs != nullptr) {
+			void * next = *(void **)m_Slabs;
+			MemFree(m_Slabs, m_Alignment);
+			m_Slabs = next;
+		}
+	}
+
+	void FixedPool::AllocateSlab() {
+		char * slab = (char *)MemAlloc(m_SlabHeaderSize + m_BlockSize * m_Desc.BlocksPerSlab, m_Desc.Tag, m_Alignment);
+		*(void **)slab = m_Slabs;
+		m_Slabs = slab;
+		m_SlabCount++;
+
+		char * blocks = slab + m_SlabHeaderSize;
+		if (m_Desc.Poison)
+			std::memset(blocks, FreedPattern, m_BlockSize * m_Desc.BlocksPerSlab);
+
+		// Linked back to front so blocks come out in address order
+		for (unsigned int i = m_Desc.BlocksPerSlab; i > 0; i--) {
+			FreeBlock * block = (FreeBlock *)(blocks + (i - 1) * m_BlockSize);
+			block->Next = m_FreeList;
+			m_FreeList = block;
+		}
+	}
+
+	FixedPool::ThreadCache * FixedPool::GetThreadCache() {
+		if (!m_Caches)
+			return nullptr;
+		unsigned int index = t_ThreadIndex.Get();
+		if (index >= MaxThreadCaches)
+			return nullptr;
+		return &m_Caches[index];
+	}
+
+	void FixedPool::Refill(ThreadCache & cache) {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		while (cache.Count < CacheBatch) {
+			if (m_FreeList == nullptr)
+				AllocateSlab();
+			FreeBlock * block = m_FreeList;
+			m_FreeList = block->Next;
+			block->Next = cache.Head;
+			cache.Head = block;
+			cache.Count++;
+		}
+	}
+
+	void FixedPool::Flush(ThreadCache & cache, unsigned int count) {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (unsigned int i = 0; i < count && cache.Head != nullptr; i++) {
+			FreeBlock * block = cache.Head;
+			cache.Head = block->Next;
+			cache.Count--;
+			block->Next = m_FreeList;
+			m_FreeList = block;
+		}
+	}
+
+	void * FixedPool::Allocate() {
+		FreeBlock * block;
+		ThreadCache * cache = GetThreadCache();
+		if (cache != nullptr) {
+			if (cache->Head == nullptr)
+				Refill(*cache);
+			block = cache->Head;
+			cache->Head = block->Next;
+			cache->Count--;
+			cache->Allocations.store(cache->Allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		} else {
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_FreeList == nullptr)
+				AllocateSlab();
+			block = m_FreeList;
+			m_FreeList = block->Next;
+			m_Allocations++;
+		}
+
+		if (m_Desc.Poison) {
+			CheckPoison(block);
+			std::memset(block, AllocatedPattern, m_BlockSize);
+		}
+		return block;
+	}
+
+	void FixedPool::Free(void * ptr) {
+		if (ptr == nullptr)
+			return;
+
+		if (m_Desc.Poison)
+			std::memset(ptr, FreedPattern, m_BlockSize);
+
+		FreeBlock * block = (FreeBlock *)ptr;
+		ThreadCache * cache = GetThreadCache();
+		if (cache != nullptr) {
+			block->Next = cache->Head;
+			cache->Head = block;
+			cache->Frees.store(cache->Frees.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			if (++cache->Count >= CacheCapacity)
+				Flush(*cache, CacheBatch);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		block->Next = m_FreeList;
+		m_FreeList = block;
+		m_Frees++;
+	}
+
+	// Everything after the free list link should still hold FreedPattern
+	void FixedPool::CheckPoison(void * ptr) {
+		const unsigned char * bytes = (const unsigned char *)ptr;
+		for (size_t i = sizeof(FreeBlock); i < m_BlockSize; i++) {
+			if (bytes[i] != FreedPattern) {
+				PV_LOG_ERROR("Pool block %p (%u bytes) was written to after it was freed, at byte %u", ptr, (unsigned int)m_BlockSize, (unsigned int)i);
+				return;
+			}
+		}
+	}
+
+	// Cached counters are read without stopping their threads, so Live can be a little off while others allocate
+	PoolStats FixedPool::GetStats() {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		unsigned long long allocations = m_Allocations;
+		unsigned long long frees = m_Frees;
+		if (m_Caches) {
+			for (unsigned int i = 0; i < MaxThreadCaches; i++) {
+				allocations += m_Caches[i].Allocations.load(std::memory_order_relaxed);
+				frees += m_Caches[i].Frees.load(std::memory_order_relaxed);
+			}
+		}
+
+		PoolStats stats;
+		stats.BlockSize = m_BlockSize;
+		stats.Slabs = m_SlabCount;
+		stats.Capacity = m_SlabCount * m_Desc.BlocksPerSlab;
+		stats.Live = allocations - frees;
+		stats.TotalAllocations = allocations;
+		return stats;
+	}
+
+	const size_t PoolAllocator::MaxAlignment;
+
+	PoolAllocator::PoolAllocator(const PoolDesc & desc) :
+		m_Tag(desc.Tag) {
+		for (unsigned int i = 0; i < ClassCount; i++) {
+			size_t blockSize = MinBlockSize << i;
+			m_Pools[i] = std::make_unique<FixedPool>(blockSize, std::min(blockSize, MaxAlignment), desc);
+		}
+	}
+
+	unsigned int PoolAllocator::GetSizeClass(size_t size) {
+		if (size > MaxBlockSize)
+			return ClassCount;
+		if (size <= MinBlockSize)
+			return 0;
+		// Sizes are random in practice, a loop here costs a mispredicted branch per call
+	#ifdef _MSC_VER
+		unsigned long highestBit;
+		_BitScanReverse64(&highestBit, (unsigned long long)(size - 1));
+		return (unsigned int)highestBit - 3;
+	#else
+		return (unsigned int)(63 - __builtin_clzll((unsigned long long)(size - 1))) - 3;
+	#endif
+	}
+
+	void * PoolAllocator::do_allocate(size_t bytes, size_t alignment) {
+		unsigned int sizeClass = alignment > MaxAlignment ? ClassCount : GetSizeClass(std::max(bytes, alignment));
+		if (sizeClass == ClassCount) {
+			m_LargeAllocations.fetch_add(1, std::memory_order_relaxed);
+			return MemAlloc(bytes, m_Tag, alignment);
+		}
+		return m_Pools[sizeClass]->Allocate();
+	}
+
+	void PoolAllocator::do_deallocate(void * ptr, size_t bytes, size_t alignment) {
+		unsigned int sizeClass = alignment > MaxAlignment ? ClassCount : GetSizeClass(std::max(bytes, alignment));
+		if (sizeClass == ClassCount) {
+			MemFree(ptr, alignment);
+			return;
+		}
+		m_Pools[sizeClass]->Free(ptr);
+	}
+
+}
\ No newline at end of file
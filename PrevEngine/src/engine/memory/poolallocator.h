@@ -0,0 +1,149 @@
+#pragma once
+
+#include <memory_resource>
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "memorytracker.h"
+
+namespace prev {
+
+	struct PoolDesc {
+		MemTag Tag = MemTag::General;		// What the slabs count as
+		unsigned int BlocksPerSlab = 64;
+		bool ThreadCaches = true;			// Each thread keeps a few free blocks of its own, so most calls skip the lock
+	#ifdef PV_DEBUG
+		bool Poison = true;					// Fill freed blocks and check nothing wrote to them before they are reused
+	#else
+		bool Poison = false;
+	#endif
+	};
+
+	struct PoolStats {
+		size_t BlockSize = 0;
+		unsigned long long Slabs = 0;
+		unsigned long long Capacity = 0;			// Blocks in all the slabs
+		unsigned long long Live = 0;				// Blocks handed out and not freed yet
+		unsigned long long TotalAllocations = 0;
+	};
+
+	// Blocks of one size carved out of slabs, free blocks are kept in an intrusive list
+	// Slabs are never given back until the pool is destroyed. Safe to use from any thread
+	class FixedPool {
+	public:
+		static const unsigned int MaxThreadCaches = 64;	// Threads alive at once past this many always take the lock
+		static const unsigned int CacheCapacity = 32;
+		static const unsigned int CacheBatch = 16;		// Blocks moved between a thread cache and the pool at a time
+		static const unsigned char AllocatedPattern = 0xCD;
+		static const unsigned char FreedPattern = 0xDD;
+	public:
+		FixedPool(size_t blockSize, size_t alignment = MemDefaultAlignment, const PoolDesc & desc = PoolDesc());
+		~FixedPool();
+
+		FixedPool(const FixedPool &) = delete;
+		FixedPool & operator=(const FixedPool &) = delete;
+
+		void * Allocate();
+		// Any thread can free a block, not only the one that allocated it
+		void Free(void * ptr);
+
+		inline size_t GetBlockSize() const { return m_BlockSize; }
+		PoolStats GetStats();
+	private:
+		struct FreeBlock {
+			FreeBlock * Next;
+		};
+
+		// Counters are only written by the owning thread, stores instead of atomic adds keep the fast path lock free and cheap
+		struct alignas(64) ThreadCache {
+			FreeBlock * Head = nullptr;
+			unsigned int Count = 0;
+			std::atomic<unsigned long long> Allocations{ 0 };
+			std::atomic<unsigned long long> Frees{ 0 };
+		};
+
+		// Caller holds m_Mutex
+		void AllocateSlab();
+		// Move blocks between a thread cache and the pool, they take the lock
+		void Refill(ThreadCache & cache);
+		void Flush(ThreadCache & cache, unsigned int count);
+		// nullptr without thread caches or for threads past MaxThreadCaches
+		ThreadCache * GetThreadCache();
+		void CheckPoison(void * ptr);
+	private:
+		size_t m_BlockSize;
+		size_t m_Alignment;
+		PoolDesc m_Desc;
+
+		std::mutex m_Mutex;
+		FreeBlock * m_FreeList = nullptr;
+		void * m_Slabs = nullptr;		// Every slab starts with a pointer to the previous one
+		size_t m_SlabHeaderSize;
+		unsigned long long m_SlabCount = 0;
+
+		std::unique_ptr<ThreadCache[]> m_Caches;
+		// Allocations and frees that went through the lock
+		unsigned long long m_Allocations = 0;
+		unsigned long long m_Frees = 0;
+	};
+
+	// One FixedPool per power of 2 size class from MinBlockSize to MaxBlockSize, anything bigger goes to MemAlloc
+	// A memory_resource, so it can back pmr containers as well as class operator new / delete
+	class PoolAllocator : public std::pmr::memory_resource {
+	public:
+		static const size_t MinBlockSize = 16;
+		static const size_t MaxBlockSize = 2048;
+		static const unsigned int ClassCount = 8;
+		static const size_t MaxAlignment = 64;	// Blocks are aligned to their size, up to this
+	public:
+		PoolAllocator(const PoolDesc & desc = PoolDesc());
+
+		PoolAllocator(const PoolAllocator &) = delete;
+		PoolAllocator & operator=(const PoolAllocator &) = delete;
+
+		// Index of the size class for size, ClassCount when it doesn't fit in one
+		static unsigned int GetSizeClass(size_t size);
+		inline FixedPool & GetClassPool(unsigned int sizeClass) { return *m_Pools[sizeClass]; }
+		// Allocations too big for a size class
+		inline unsigned long long GetLargeAllocations() const { return m_LargeAllocations.load(std::memory_order_relaxed); }
+	private:
+		virtual void * do_allocate(size_t bytes, size_t alignment) override;
+		virtual void do_deallocate(void * ptr, size_t bytes, size_t alignment) override;
+		virtual bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override { return this == &other; }
+	private:
+		std::array<std::unique_ptr<FixedPool>, ClassCount> m_Pools;
+		MemTag m_Tag;
+		std::atomic<unsigned long long> m_LargeAllocations{ 0 };
+	};
+
+	// Pool of one type, Create / Destroy instead of new / delete
+	template<typename T>
+	class ObjectPool {
+	public:
+		ObjectPool(const PoolDesc & desc = PoolDesc()) :
+			m_Pool(sizeof(T), alignof(T), desc) {
+		}
+
+		template<typename... Args>
+		T * Create(Args &&... args) {
+			void * ptr = m_Pool.Allocate();
+			return new (ptr) T(std::forward<Args>(args)...);
+		}
+
+		void Destroy(T * object) {
+			if (object == nullptr)
+				return;
+			object->~T();
+			m_Pool.Free(object);
+		}
+
+		inline PoolStats GetStats() { return m_Pool.GetStats(); }
+	private:
+		FixedPool m_Pool;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "pch.h"
+#include "commandbuffer.h"
+
+#include "engine/jobs/jobsystem.h"
+
+namespace prev {
+
+	CommandBuffer::~CommandBuffer() {
+		for (char * block : m_Blocks)
+			MemFree(block);
+	}
+
+	void CommandBuffer::Reset() {
+		m_Block = 0;
+		m_Offset = 0;
+		m_Entries.clear();
+	}
+
+	void * CommandBuffer::Allocate(size_t size, size_t alignment) {
+		size_t offset = (m_Offset + alignment - 1) & ~(alignment - 1);
+		if (m_Block >= m_Blocks.size() || offset + size > BlockSize) {
+			// Move on to the next block, or add one when every block is full
+			if (m_Block < m_Blocks.size())
+				m_Block++;
+			if (m_Block == m_Blocks.size())
+				m_Blocks.push_back((char *)MemAlloc(BlockSize, MemTag::Render));
+			offset = 0;
+		}
+		m_Offset = offset + size;
+		return m_Blocks[m_Block] + offset;
+	}
+
+	RenderQueue::RenderQueue(JobSystem * jobSystem) :
+		m_JobSystem(jobSystem), m_WorkerBuffers(std::make_unique<CommandBuffer[]>(JobSystem::MaxWorkers)) {
+	}
+
+	RenderQueue::~RenderQueue() {
+	}
+
+	CommandBuffer & RenderQueue::GetBuffer() {
+		unsigned int workerIndex = m_JobSystem != nullptr ? m_JobSystem->GetWorkerIndex() : JobSystem::MaxWorkers;
+		if (workerIndex < JobSystem::MaxWorkers)
+			return m_WorkerBuffers[workerIndex];
+
+		std::thread::id id = std::this_thread::get_id();
+		std::lock_guard<std::mutex> lock(m_ThreadBuffersMutex);
+		for (auto & buffer : m_ThreadBuffers) {
+			if (buffer.first == id)
+				return *buffer.second;
+		}
+		m_ThreadBuffers.emplace_back(id, std::make_unique<CommandBuffer>());
+		return *m_ThreadBuffers.back().second;
+	}
+
+	void RenderQueue::Reset() {
+		for (unsigned int i = 0; i < JobSystem::MaxWorkers; i++)
+			m_WorkerBuffers[i].Reset();
+		for (auto & buffer : m_ThreadBuffers)
+			buffer.second->Reset();
+		m_Sorted.clear();
+	}
+
+	void RenderQueue::Sort() {
+		PV_PROFILE_FUNCTION();
+
+		Gather();
+		if (m_Sorted.size() < RadixSortThreshold) {
+			std::stable_sort(m_Sorted.begin(), m_Sorted.end(), [](const RenderSortEntry & a, const RenderSortEntry & b) -> bool {
+				return a.Key < b.Key;
+			});
+			return;
+		}
+		RadixSort();
+	}
+
+	void RenderQueue::Gather() {
+		size_t count = 0;
+		for (unsigned int i = 0; i < JobSystem::MaxWorkers; i++)
+			count += m_WorkerBuffers[i].GetCommandCount();
+		for (auto & buffer : m_ThreadBuffers)
+			count += buffer.second->GetCommandCount();
+
+		m_Sorted.clear();
+		m_Sorted.reserve(count);
+		for (unsigned int i = 0; i < JobSystem::MaxWorkers; i++) {
+			const auto & entries = m_WorkerBuffers[i].GetEntries();
+			m_Sorted.insert(m_Sorted.end(), entries.begin(), entries.end());
+		}
+		for (auto & buffer : m_ThreadBuffers) {
+			const auto & entries = buffer.second->GetEntries();
+			m_Sorted.insert(m_Sorted.end(), entries.begin(), entries.end());
+		}
+	}
+
+	// LSD radix sort on bytes of the key, all 8 histograms are counted in one pass
+	// Most frames only use a few layers and passes, bytes every key shares are skipped
+	void RenderQueue::RadixSort() {
+		const size_t count = m_Sorted.size();
+		m_Scratch.resize(count);
+
+		unsigned int histograms[8][256] = {};
+		for (const RenderSortEntry & entry : m_Sorted) {
+			unsigned long long key = entry.Key;
+			for (unsigned int digit = 0; digit < 8; digit++)
+				histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+		}
+
+		RenderSortEntry * source = m_Sorted.data();
+		RenderSortEntry * destination = m_Scratch.data();
+		unsigned long long firstKey = source[0].Key;
+		for (unsigned int digit = 0; digit < 8; digit++) {
+			unsigned int shift = digit * 8;
+			unsigned int * histogram = histograms[digit];
+			if (histogram[(firstKey >> shift) & 0xFF] == count)
+				continue;
+
+			unsigned int offset = 0;
+			for (unsigned int i = 0; i < 256; i++) {
+				unsigned int bucket = histogram[i];
+				histogram[i] = offset;
+				offset += bucket;
+			}
+			for (size_t i = 0; i < count; i++)
+				destination[histogram[(source[i].Key >> shift) & 0xFF]++] = source[i];
+			std::swap(source, destination);
+		}
+
+		if (source != m_Sorted.data())
+			m_Sorted.swap(m_Scratch);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "rendercommand.h"
+#include "engine/memory/memorytracker.h"
+
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <new>
+#include <utility>
+
+namespace prev {
+
+	class JobSystem;
+
+	// Linear buffer one thread records into, commands are copied into blocks that are kept from frame to frame
+	// Not thread safe, get one per thread from RenderQueue::GetBuffer
+	class CommandBuffer {
+	public:
+		static const size_t BlockSize = 16 * 1024;
+	public:
+		CommandBuffer() = default;
+		~CommandBuffer();
+
+		CommandBuffer(const CommandBuffer &) = delete;
+		CommandBuffer & operator=(const CommandBuffer &) = delete;
+
+		// Zeroed command with its type set, fill in the rest
+		template<typename T>
+		T & Record(unsigned long long key) {
+			static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Render commands must be plain data");
+			static_assert(sizeof(T) <= BlockSize, "Render command doesn't fit in a block");
+			T * command = new (Allocate(sizeof(T), alignof(T))) T();
+			command->Type = T::CommandType;
+			m_Entries.push_back({ key, &command->Type });
+			return *command;
+		}
+
+		template<typename T>
+		void Record(unsigned long long key, const T & command) {
+			T & recorded = Record<T>(key);
+			recorded = command;
+			recorded.Type = T::CommandType;
+		}
+
+		// Keeps the blocks for the next frame
+		void Reset();
+
+		inline unsigned int GetCommandCount() const { return (unsigned int)m_Entries.size(); }
+		inline const TaggedVector<RenderSortEntry, MemTag::Render> & GetEntries() const { return m_Entries; }
+		inline size_t GetCapacity() const { return m_Blocks.size() * BlockSize; }
+	private:
+		void * Allocate(size_t size, size_t alignment);
+	private:
+		TaggedVector<char *, MemTag::Render> m_Blocks;
+		unsigned int m_Block = 0;	// Block being filled
+		size_t m_Offset = 0;		// Into it
+		TaggedVector<RenderSortEntry, MemTag::Render> m_Entries;
+	};
+
+	// Every command recorded for one frame, one CommandBuffer per thread so recording takes no lock
+	// Record while the frame simulates, then Sort once and hand it to GraphicsAPI::Submit
+	class RenderQueue {
+	public:
+		static const unsigned int RadixSortThreshold = 256;	// Fewer commands than this go through std::stable_sort
+	public:
+		RenderQueue(JobSystem * jobSystem = nullptr);
+		~RenderQueue();
+
+		RenderQueue(const RenderQueue &) = delete;
+		RenderQueue & operator=(const RenderQueue &) = delete;
+
+		// Workers of the job system get their own buffer without a lock, other threads take one the first time they ask
+		void SetJobSystem(JobSystem * jobSystem) { m_JobSystem = jobSystem; }
+		CommandBuffer & GetBuffer();
+
+		// Nobody can be recording when these are called
+		void Reset();
+		// Stable, commands with equal keys from one thread keep the order they were recorded in
+		void Sort();
+
+		inline const TaggedVector<RenderSortEntry, MemTag::Render> & GetSorted() const { return m_Sorted; }
+		inline unsigned int GetCommandCount() const { return (unsigned int)m_Sorted.size(); }
+	private:
+		void Gather();
+		void RadixSort();
+	private:
+		JobSystem * m_JobSystem;
+		std::unique_ptr<CommandBuffer[]> m_WorkerBuffers;	// One per possible job system worker
+
+		std::mutex m_ThreadBuffersMutex;
+		std::vector<std::pair<std::thread::id, std::unique_ptr<CommandBuffer>>> m_ThreadBuffers;
+
+		TaggedVector<RenderSortEntry, MemTag::Render> m_Sorted;
+		TaggedVector<RenderSortEntry, MemTag::Render> m_Scratch;
+	};
+
+}
\ No newline at end of file
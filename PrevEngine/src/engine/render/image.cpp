@@ -0,0 +1,190 @@
+#include "pch.h"
+#include "image.h"
+
+namespace prev {
+
+	static const unsigned char s_PNGSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	static const unsigned int s_MaxStoredBlock = 65535;
+
+	static unsigned int Crc32(const unsigned char * data, size_t size, unsigned int crc = 0) {
+		static const std::array<unsigned int, 256> table = []() {
+			std::array<unsigned int, 256> table;
+			for (unsigned int i = 0; i < 256; i++) {
+				unsigned int c = i;
+				for (unsigned int k = 0; k < 8; k++)
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				table[i] = c;
+			}
+			return table;
+		}();
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	static void PutU32(std::vector<unsigned char> & out, unsigned int value) {
+		out.push_back((unsigned char)(value >> 24));
+		out.push_back((unsigned char)(value >> 16));
+		out.push_back((unsigned char)(value >> 8));
+		out.push_back((unsigned char)value);
+	}
+
+	static unsigned int GetU32(const unsigned char * data) {
+		return ((unsigned int)data[0] << 24) | ((unsigned int)data[1] << 16) | ((unsigned int)data[2] << 8) | data[3];
+	}
+
+	static void PutChunk(std::vector<unsigned char> & out, const char * type, const std::vector<unsigned char> & data) {
+		PutU32(out, (unsigned int)data.size());
+		size_t start = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+		PutU32(out, Crc32(out.data() + start, out.size() - start));
+	}
+
+	bool WritePNG(const std::string & path, const Image & image) {
+		std::vector<unsigned char> header;
+		PutU32(header, image.Width);
+		PutU32(header, image.Height);
+		header.insert(header.end(), { 8, 6, 0, 0, 0 });	// 8 bit RGBA, deflate, no filter method, no interlace
+
+		// Every row starts with filter type 0 (none)
+		const size_t rowSize = (size_t)image.Width * 4 + 1;
+		std::vector<unsigned char> raw(rowSize * image.Height);
+		for (unsigned int y = 0; y < image.Height; y++) {
+			unsigned char * row = raw.data() + y * rowSize;
+			row[0] = 0;
+			std::memcpy(row + 1, image.Pixels.data() + (size_t)y * image.Width, (size_t)image.Width * 4);
+		}
+
+		std::vector<unsigned char> zlib = { 0x78, 0x01 };
+		size_t offset = 0;
+		do {
+			unsigned int size = (unsigned int)std::min(raw.size() - offset, (size_t)s_MaxStoredBlock);
+			bool last = offset + size == raw.size();
+			zlib.push_back(last ? 1 : 0);
+			zlib.push_back((unsigned char)size);
+			zlib.push_back((unsigned char)(size >> 8));
+			zlib.push_back((unsigned char)~size);
+			zlib.push_back((unsigned char)(~size >> 8));
+			zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+			offset += size;
+		} while (offset < raw.size());
+
+		unsigned int a = 1, b = 0;	// Adler-32
+		for (unsigned char byte : raw) {
+			a = (a + byte) % 65521;
+			b = (b + a) % 65521;
+		}
+		PutU32(zlib, (b << 16) | a);
+
+		std::vector<unsigned char> file(s_PNGSignature, s_PNGSignature + 8);
+		PutChunk(file, "IHDR", header);
+		PutChunk(file, "IDAT", zlib);
+		PutChunk(file, "IEND", {});
+
+		std::ofstream stream(path, std::ios::binary);
+		if (!stream) {
+			PV_LOG_ERROR("Unable to write %s", path);
+			return false;
+		}
+		stream.write((const char *)file.data(), file.size());
+		return (bool)stream;
+	}
+
+	bool ReadPNG(const std::string & path, Image & image) {
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream) {
+			PV_LOG_ERROR("Unable to open %s", path);
+			return false;
+		}
+		std::vector<unsigned char> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		if (file.size() < 8 || std::memcmp(file.data(), s_PNGSignature, 8) != 0) {
+			PV_LOG_ERROR("%s is not a PNG", path);
+			return false;
+		}
+
+		std::vector<unsigned char> zlib;
+		bool hasHeader = false;
+		for (size_t offset = 8; offset + 12 <= file.size();) {
+			unsigned int size = GetU32(&file[offset]);
+			if (offset + 12 + size > file.size())
+				break;
+			const unsigned char * type = &file[offset + 4];
+			const unsigned char * data = &file[offset + 8];
+			if (std::memcmp(type, "IHDR", 4) == 0 && size >= 13) {
+				image.Width = GetU32(data);
+				image.Height = GetU32(data + 4);
+				if (data[8] != 8 || data[9] != 6 || data[12] != 0) {
+					PV_LOG_ERROR("%s is not 8 bit RGBA without interlacing", path);
+					return false;
+				}
+				hasHeader = true;
+			} else if (std::memcmp(type, "IDAT", 4) == 0) {
+				zlib.insert(zlib.end(), data, data + size);
+			}
+			offset += 12 + size;
+		}
+		if (!hasHeader || zlib.size() < 2) {
+			PV_LOG_ERROR("%s has no image data", path);
+			return false;
+		}
+
+		// Stored blocks only, each one starts on a byte
+		std::vector<unsigned char> raw;
+		size_t offset = 2;
+		bool last = false;
+		while (!last) {
+			if (offset + 5 > zlib.size() || (zlib[offset] & 0x06) != 0) {
+				PV_LOG_ERROR("%s is compressed, only PNGs written by WritePNG can be read", path);
+				return false;
+			}
+			last = zlib[offset] & 1;
+			unsigned int size = zlib[offset + 1] | (zlib[offset + 2] << 8);
+			offset += 5;
+			if (offset + size > zlib.size()) {
+				PV_LOG_ERROR("%s is truncated", path);
+				return false;
+			}
+			raw.insert(raw.end(), zlib.begin() + offset, zlib.begin() + offset + size);
+			offset += size;
+		}
+
+		const size_t rowSize = (size_t)image.Width * 4 + 1;
+		if (raw.size() < rowSize * image.Height) {
+			PV_LOG_ERROR("%s is truncated", path);
+			return false;
+		}
+		image.Pixels.resize((size_t)image.Width * image.Height);
+		for (unsigned int y = 0; y < image.Height; y++) {
+			const unsigned char * row = raw.data() + y * rowSize;
+			if (row[0] != 0) {
+				PV_LOG_ERROR("%s uses row filters, only PNGs written by WritePNG can be read", path);
+				return false;
+			}
+			std::memcpy(image.Pixels.data() + (size_t)y * image.Width, row + 1, (size_t)image.Width * 4);
+		}
+		return true;
+	}
+
+	ImageDiff CompareImages(const Image & a, const Image & b, unsigned int tolerance) {
+		ImageDiff diff;
+		diff.SameSize = a.Width == b.Width && a.Height == b.Height;
+		if (!diff.SameSize)
+			return diff;
+
+		for (size_t i = 0; i < a.Pixels.size(); i++) {
+			unsigned int pixelDelta = 0;
+			for (unsigned int shift = 0; shift < 32; shift += 8) {
+				int ca = (a.Pixels[i] >> shift) & 0xFF;
+				int cb = (b.Pixels[i] >> shift) & 0xFF;
+				pixelDelta = std::max(pixelDelta, (unsigned int)std::abs(ca - cb));
+			}
+			diff.MaxChannelDelta = std::max(diff.MaxChannelDelta, pixelDelta);
+			if (pixelDelta > tolerance)
+				diff.DifferentPixels++;
+		}
+		return diff;
+	}
+
+}
\ No newline at end of file
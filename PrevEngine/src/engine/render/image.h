@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace prev {
+
+	// 8 bit RGBA, R in the lowest byte (bytes R, G, B, A on little endian), rows top to bottom
+	struct Image {
+		unsigned int Width = 0;
+		unsigned int Height = 0;
+		std::vector<unsigned int> Pixels;
+
+		inline unsigned int GetPixel(unsigned int x, unsigned int y) const { return Pixels[y * Width + x]; }
+	};
+
+	struct ImageDiff {
+		bool SameSize = false;
+		unsigned int DifferentPixels = 0;	// Pixels with a channel more than the tolerance off
+		unsigned int MaxChannelDelta = 0;
+
+		inline bool Matches() const { return SameSize && DifferentPixels == 0; }
+	};
+
+	// Uncompressed (stored deflate blocks), no zlib needed and every viewer opens it
+	bool WritePNG(const std::string & path, const Image & image);
+	// Reads back what WritePNG writes : 8 bit RGBA with stored deflate blocks. Compressed PNGs fail with an error
+	bool ReadPNG(const std::string & path, Image & image);
+
+	ImageDiff CompareImages(const Image & a, const Image & b, unsigned int tolerance = 0);
+
+}
\ No newline at end of file
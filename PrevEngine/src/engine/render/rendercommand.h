@@ -0,0 +1,118 @@
+#pragma once
+
+#include <type_traits>
+
+namespace prev {
+
+	// 64 bit sort key, commands are submitted in increasing key order
+	//  63      56 55    49   48   47          24 23           0
+	// | layer 8  | pass 7 | draw | material 24  | depth 24     |
+	// Setup commands (clear, viewport, render target) have the draw bit clear so they come first in their pass
+	// Back to front draws swap material and depth, with the depth flipped
+	namespace SortKey {
+
+		static const unsigned int LayerBits = 8;
+		static const unsigned int PassBits = 7;
+		static const unsigned int MaterialBits = 24;
+		static const unsigned int DepthBits = 24;
+
+		static const unsigned long long MaterialMask = (1ull << MaterialBits) - 1;
+		static const unsigned long long DepthMask = (1ull << DepthBits) - 1;
+
+		// depth is view depth mapped to [0, 1], anything outside is clamped
+		inline unsigned int QuantizeDepth(float depth) {
+			if (!(depth > 0.0f))
+				return 0;
+			if (depth >= 1.0f)
+				return (unsigned int)DepthMask;
+			return (unsigned int)(depth * (float)DepthMask);
+		}
+
+		inline unsigned long long Setup(unsigned int layer, unsigned int pass) {
+			return ((unsigned long long)(layer & 0xFF) << 56) | ((unsigned long long)(pass & 0x7F) << 49);
+		}
+
+		// Front to back, grouped by material first so state changes are rare
+		inline unsigned long long Draw(unsigned int layer, unsigned int pass, unsigned int material, float depth) {
+			return Setup(layer, pass) | (1ull << 48) | ((material & MaterialMask) << 24) | QuantizeDepth(depth);
+		}
+
+		// For blended draws, farthest first
+		inline unsigned long long DrawBackToFront(unsigned int layer, unsigned int pass, unsigned int material, float depth) {
+			return Setup(layer, pass) | (1ull << 48) | ((DepthMask - QuantizeDepth(depth)) << 24) | (material & MaterialMask);
+		}
+
+		inline unsigned int GetLayer(unsigned long long key) { return (unsigned int)(key >> 56); }
+		inline unsigned int GetPass(unsigned long long key) { return (unsigned int)(key >> 49) & 0x7F; }
+		inline bool IsDraw(unsigned long long key) { return (key >> 48) & 1; }
+
+	}
+
+	enum class RenderCommandType : unsigned char {
+		Clear,
+		SetRenderTarget,
+		SetViewport,
+		Draw
+	};
+
+	// Commands are plain data, copied into a CommandBuffer and read by the backend on the render thread
+	// Every command starts with its type, so a pointer to the type is a pointer to the command
+	// Resource ids belong to the backend, 0 means none
+
+	enum ClearFlags : unsigned int {
+		ClearColor		= 1 << 0,
+		ClearDepth		= 1 << 1,
+		ClearStencil	= 1 << 2
+	};
+
+	struct ClearCommand {
+		static const RenderCommandType CommandType = RenderCommandType::Clear;
+		RenderCommandType Type;
+		unsigned char Stencil;
+		unsigned int Flags;
+		float Color[4];
+		float Depth;
+	};
+
+	struct SetRenderTargetCommand {
+		static const RenderCommandType CommandType = RenderCommandType::SetRenderTarget;
+		RenderCommandType Type;
+		unsigned int RenderTarget;	// 0 is the back buffer
+	};
+
+	struct SetViewportCommand {
+		static const RenderCommandType CommandType = RenderCommandType::SetViewport;
+		RenderCommandType Type;
+		float X, Y;
+		float Width, Height;
+		float MinDepth, MaxDepth;
+	};
+
+	// Carries all of its state, the backend only changes what differs from the draw before it
+	struct DrawCommand {
+		static const RenderCommandType CommandType = RenderCommandType::Draw;
+		static const unsigned int MaxTextures = 4;
+
+		RenderCommandType Type;
+		unsigned int Pipeline;
+		unsigned int VertexBuffer;
+		unsigned int IndexBuffer;		// 0 draws Count vertices from First, otherwise Count indices
+		unsigned int Textures[MaxTextures];
+		unsigned int Count;
+		unsigned int First;
+		int BaseVertex;
+		unsigned int InstanceCount;		// 0 and 1 both draw once
+	};
+
+	struct RenderSortEntry {
+		unsigned long long Key;
+		const RenderCommandType * Command;
+	};
+
+	template<typename T>
+	inline const T & RenderCommandCast(const RenderCommandType * command) {
+		static_assert(std::is_standard_layout_v<T>, "Render commands must start with their type");
+		return *reinterpret_cast<const T *>(command);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "statecache.h"
+
+namespace prev {
+
+	static const unsigned int s_StateCount = (unsigned int)RenderState::Count;
+
+	static const char * s_StateNames[s_StateCount] = {
+		"RenderTarget", "Viewport", "Pipeline", "VertexBuffer", "IndexBuffer", "Texture"
+	};
+
+	unsigned int RenderStateCounters::GetIssued() const {
+		unsigned int issued = 0;
+		for (unsigned int i = 0; i < s_StateCount; i++)
+			issued += Issued[i];
+		return issued;
+	}
+
+	unsigned int RenderStateCounters::GetFiltered() const {
+		unsigned int filtered = 0;
+		for (unsigned int i = 0; i < s_StateCount; i++)
+			filtered += Filtered[i];
+		return filtered;
+	}
+
+	float RenderStateCounters::GetFilterRate() const {
+		unsigned int filtered = GetFiltered();
+		unsigned int total = GetIssued() + filtered;
+		return total > 0 ? (float)filtered / total : 0.0f;
+	}
+
+	RenderStateCache::RenderStateCache() {
+		for (unsigned int i = 0; i < s_StateCount; i++) {
+			m_LastIssued[i].store(0, std::memory_order_relaxed);
+			m_LastFiltered[i].store(0, std::memory_order_relaxed);
+		}
+		Invalidate();
+	}
+
+	void RenderStateCache::Invalidate() {
+		for (unsigned int i = 0; i < s_StateCount; i++)
+			Invalidate((RenderState)i);
+	}
+
+	void RenderStateCache::Invalidate(RenderState state) {
+		switch (state) {
+		case RenderState::RenderTarget:	m_RenderTarget = Unknown; break;
+		case RenderState::Viewport:		m_ViewportKnown = false; break;
+		case RenderState::Pipeline:		m_Pipeline = Unknown; break;
+		case RenderState::VertexBuffer:	m_VertexBuffer = Unknown; break;
+		case RenderState::IndexBuffer:	m_IndexBuffer = Unknown; break;
+		case RenderState::Texture:
+			for (unsigned int & texture : m_Textures)
+				texture = Unknown;
+			break;
+		default:
+			break;
+		}
+	}
+
+	void RenderStateCache::EndFrame() {
+		for (unsigned int i = 0; i < s_StateCount; i++) {
+			m_LastIssued[i].store(m_Frame.Issued[i], std::memory_order_relaxed);
+			m_LastFiltered[i].store(m_Frame.Filtered[i], std::memory_order_relaxed);
+		}
+		m_Frame = RenderStateCounters();
+	}
+
+	bool RenderStateCache::SetRenderTarget(unsigned int renderTarget) {
+		return Set(RenderState::RenderTarget, m_RenderTarget, renderTarget);
+	}
+
+	bool RenderStateCache::SetViewport(const SetViewportCommand & viewport) {
+		const unsigned int state = (unsigned int)RenderState::Viewport;
+		if (m_ViewportKnown && m_Viewport.X == viewport.X && m_Viewport.Y == viewport.Y &&
+			m_Viewport.Width == viewport.Width && m_Viewport.Height == viewport.Height &&
+			m_Viewport.MinDepth == viewport.MinDepth && m_Viewport.MaxDepth == viewport.MaxDepth) {
+			m_Frame.Filtered[state]++;
+			return false;
+		}
+		m_Viewport = viewport;
+		m_ViewportKnown = true;
+		m_Frame.Issued[state]++;
+		return true;
+	}
+
+	bool RenderStateCache::SetPipeline(unsigned int pipeline) {
+		return Set(RenderState::Pipeline, m_Pipeline, pipeline);
+	}
+
+	bool RenderStateCache::SetVertexBuffer(unsigned int vertexBuffer) {
+		return Set(RenderState::VertexBuffer, m_VertexBuffer, vertexBuffer);
+	}
+
+	bool RenderStateCache::SetIndexBuffer(unsigned int indexBuffer) {
+		return Set(RenderState::IndexBuffer, m_IndexBuffer, indexBuffer);
+	}
+
+	bool RenderStateCache::SetTexture(unsigned int slot, unsigned int texture) {
+		return Set(RenderState::Texture, m_Textures[slot], texture);
+	}
+
+	RenderStateCounters RenderStateCache::GetLastFrame() const {
+		RenderStateCounters counters;
+		for (unsigned int i = 0; i < s_StateCount; i++) {
+			counters.Issued[i] = m_LastIssued[i].load(std::memory_order_relaxed);
+			counters.Filtered[i] = m_LastFiltered[i].load(std::memory_order_relaxed);
+		}
+		return counters;
+	}
+
+	const char * RenderStateCache::GetStateName(RenderState state) {
+		if ((unsigned int)state >= s_StateCount)
+			return "Unknown";
+		return s_StateNames[(unsigned int)state];
+	}
+
+}
\ No newline at end of file
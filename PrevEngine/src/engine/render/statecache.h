@@ -0,0 +1,80 @@
+#pragma once
+
+#include "rendercommand.h"
+
+#include <atomic>
+
+namespace prev {
+
+	enum class RenderState : unsigned char {
+		RenderTarget,
+		Viewport,
+		Pipeline,
+		VertexBuffer,
+		IndexBuffer,
+		Texture,
+		Count
+	};
+
+	// Api calls a backend made and the ones the cache dropped because the state was already bound
+	struct RenderStateCounters {
+		unsigned int Issued[(unsigned int)RenderState::Count] = {};
+		unsigned int Filtered[(unsigned int)RenderState::Count] = {};
+
+		unsigned int GetIssued() const;
+		unsigned int GetFiltered() const;
+		// Filtered out of all the calls asked for, 0 when there were none
+		float GetFilterRate() const;
+	};
+
+	// What the backend last bound, so a Set that changes nothing can be skipped
+	// Each Set returns true when the backend has to make the call. Render thread only, except GetLastFrame
+	class RenderStateCache {
+	public:
+		static const unsigned int Unknown = ~0u;
+	public:
+		RenderStateCache();
+
+		// Forget what is bound, for when something else touched the device (ImGui, ClearState, a resize)
+		void Invalidate();
+		void Invalidate(RenderState state);
+		// Publishes this frame's counters for GetLastFrame and starts counting again
+		void EndFrame();
+
+		bool SetRenderTarget(unsigned int renderTarget);
+		bool SetViewport(const SetViewportCommand & viewport);
+		bool SetPipeline(unsigned int pipeline);
+		bool SetVertexBuffer(unsigned int vertexBuffer);
+		bool SetIndexBuffer(unsigned int indexBuffer);
+		bool SetTexture(unsigned int slot, unsigned int texture);
+
+		// Counters of the last frame that ended, from any thread
+		RenderStateCounters GetLastFrame() const;
+		inline const RenderStateCounters & GetCurrentFrame() const { return m_Frame; }
+
+		static const char * GetStateName(RenderState state);
+	private:
+		inline bool Set(RenderState state, unsigned int & bound, unsigned int value) {
+			if (bound == value) {
+				m_Frame.Filtered[(unsigned int)state]++;
+				return false;
+			}
+			bound = value;
+			m_Frame.Issued[(unsigned int)state]++;
+			return true;
+		}
+	private:
+		unsigned int m_RenderTarget;
+		unsigned int m_Pipeline;
+		unsigned int m_VertexBuffer;
+		unsigned int m_IndexBuffer;
+		unsigned int m_Textures[DrawCommand::MaxTextures];
+		SetViewportCommand m_Viewport;
+		bool m_ViewportKnown;
+
+		RenderStateCounters m_Frame;
+		std::atomic<unsigned int> m_LastIssued[(unsigned int)RenderState::Count];
+		std::atomic<unsigned int> m_LastFiltered[(unsigned int)RenderState::Count];
+	};
+
+}
\ No newline at end of file
@@ -5,6 +5,10 @@ namespace prev {
 
 #if defined(PV_WINDOWING_API_WIN32) || defined(PV_WINDOWING_API_GLFW)
 	Window * Window::Create(const WindowDesc & windowDesc, const WindowAPI & windowingAPI) {
+		// Null window has no dependencies so it is always available
+		if (windowingAPI == WindowAPI::WINDOWING_API_NULL) {
+			return CreateNullWindow(windowDesc);
+		}
 	#if defined(PV_WINDOWING_API_WIN32)
 		if (windowingAPI != WindowAPI::WINDOWING_API_WIN32) {
 			PV_POST_ERROR("Cannot use GLFW when PV_WINDOWING_API_GLFW is not defined!\nUsing Win32 instead");
@@ -23,18 +27,29 @@ namespace prev {
 			return CreateWin32Window(windowDesc);
 		} else if (windowingApi == WindowAPI::WINDOWING_API_GLFW) {
 			return CreateGLFWWindow(windowDesc);
+		} else if (windowingApi == WindowAPI::WINDOWING_API_NULL) {
+			return CreateNullWindow(windowDesc);
 		} else {
 			PV_POST_FATAL("Please Pass a valid windowing api\n"
 						  "For Win32 use WINDOWING_API_WIN32\n"
-						  "For GLFW use WINDOWING_API_GLFW\n");
+						  "For GLFW use WINDOWING_API_GLFW\n"
+						  "For no window use WINDOWING_API_NULL\n");
 			return nullptr;
 		}
 	}
+#elif defined(PV_WINDOWING_API_NULL)
+	Window * Window::Create(const WindowDesc & windowDesc, const WindowAPI & windowingApi) {
+		if (windowingApi != WindowAPI::WINDOWING_API_NULL) {
+			PV_POST_WARN("Only the null window is available when PV_WINDOWING_API_NULL is defined!\nUsing null window instead");
+		}
+		return CreateNullWindow(windowDesc);
+	}
 #else
-	static Window * Window::Create(const WindowDesc & windowDesc, const WindowAPI & windowingApi) {
+	Window * Window::Create(const WindowDesc & windowDesc, const WindowAPI & windowingApi) {
 		PV_POST_FATAL("Please Define the windowing api symbols\n"
 					  "For Win32 use PV_WINDOWING_API_WIN32\n"
 					  "For GLFW use PV_WINDOWING_API_GLFW\n"
+					  "For no window use PV_WINDOWING_API_NULL\n"
 					  "To Compile both use PV_WINDOWING_API_BOTH");
 		return nullptr;
 	}
@@ -11,6 +11,7 @@ namespace prev {
 	enum class WindowAPI {
 		WINDOWING_API_WIN32,
 		WINDOWING_API_GLFW,
+		WINDOWING_API_NULL,	  // No OS window, events only come from code
 		WINDOWING_API_UNINIT // Uninitialized
 	};
 
@@ -37,6 +38,7 @@ namespace prev {
 		Window() {};
 		static Window * CreateWin32Window(const WindowDesc & windowDesc = WindowDesc());
 		static Window * CreateGLFWWindow(const WindowDesc & windowDesc = WindowDesc());
+		static Window * CreateNullWindow(const WindowDesc & windowDesc = WindowDesc());
 	private:
 		static Window * Create(const WindowDesc & windowDesc, const WindowAPI & windowingAPI);
 	};
@@ -1,5 +1,7 @@
 #pragma once
 
+#ifdef PV_PLATFORM_WINDOWS
+
 // WINDOWS SPECIFIC STUFF
 
 // target Windows 7 or later
@@ -54,6 +56,8 @@
 #include <d3dcompiler.h>
 #include <dxgi.h>
 
+#endif
+
 // STL Stuff
 #include <iostream>
 #include <fstream>
@@ -66,11 +70,27 @@
 #include <map>
 #include <stack>
 #include <queue>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <memory>
-#include <comdef.h>
 #include <functional>
 #include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <cctype>
+#include <ctime>
+
+#ifdef PV_PLATFORM_WINDOWS
+#include <comdef.h>
+#endif
 
 //CUSTOM INCLUDES
 #include "engine/essentials/error.h"
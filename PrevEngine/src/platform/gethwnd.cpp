@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "gethwnd.h"
 
+#ifdef PV_PLATFORM_WINDOWS
+
 #if defined(PV_WINDOWING_API_GLFW) || defined(PV_WINDOWING_API_BOTH)
 
 #define GLFW_EXPOSE_NATIVE_WIN32
@@ -23,4 +25,6 @@ namespace prev {
 	}
 }
 
+#endif
+
 #endif
\ No newline at end of file
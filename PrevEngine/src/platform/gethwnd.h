@@ -1,5 +1,9 @@
 #pragma once
 
+#ifdef PV_PLATFORM_WINDOWS
+
 namespace prev {
 	HWND GetHWND(void * rawpointer);
 }
+
+#endif
@@ -0,0 +1,40 @@
+#include "pch.h"
+#include "nullwindow.h"
+
+namespace prev {
+
+	Window * Window::CreateNullWindow(const WindowDesc & windowDesc) {
+		return (Window *)new NullWindow(windowDesc);
+	}
+
+	NullWindow::NullWindow(const WindowDesc & windowDesc) {
+		m_Data.Width = windowDesc.Width;
+		m_Data.Height = windowDesc.Height;
+		m_Data.Title = windowDesc.Title;
+		m_Data.CallbackFunction = BIND_EVENT_FN(NullWindow::DefaultEventCallbackFunction);
+
+		m_WindowAPI = WindowAPI::WINDOWING_API_NULL;
+	}
+
+	NullWindow::~NullWindow() {
+	}
+
+	void NullWindow::Update() {
+		// No OS messages to pump, only what the event source generates
+		if (m_Data.EventSource)
+			m_Data.EventSource(m_Data.CallbackFunction);
+	}
+
+	void NullWindow::SetEventCallbackFunc(std::function<void(Event & e)> func) {
+		m_Data.CallbackFunction = func;
+	}
+
+	void NullWindow::SetEventSource(std::function<void(std::function<void(Event & e)> & callback)> source) {
+		m_Data.EventSource = source;
+	}
+
+	void * NullWindow::GetRawPointer() {
+		return (void *)this;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "engine/window.h"
+
+namespace prev {
+
+	// Window without any OS window behind it
+	// Used for headless runs (CI, benchmarks) where no display is available
+	class NullWindow : public Window {
+	public:
+		NullWindow(const WindowDesc & windowDesc);
+		~NullWindow();
+
+		virtual void Update() override;
+		virtual void SetEventCallbackFunc(std::function<void(Event & e) > func) override;
+		virtual void * GetRawPointer() override;
+		virtual std::pair<int, int> GetWindowSize() override { return std::pair<int, int>(m_Data.Width, m_Data.Height); }
+
+		// Stands in for the OS message pump, called every Update with the event callback
+		void SetEventSource(std::function<void(std::function<void(Event & e)> & callback)> source);
+	private:
+		void DefaultEventCallbackFunction(Event & e) { }
+	public:
+		struct WindowData {
+			// Useful Info
+			unsigned int Width;
+			unsigned int Height;
+			std::string Title;
+
+			// Event Callback Function
+			std::function<void(Event & e)> CallbackFunction;
+
+			// Synthetic events
+			std::function<void(std::function<void(Event & e)> & callback)> EventSource;
+		};
+
+		WindowData m_Data;
+	};
+
+}
\ No newline at end of file
@@ -7,4 +7,11 @@
 #include "engine/events/mouseevent.h"
 #include "engine/events/event.h"
 
-#include "engine/layer/layerstack.h"
\ No newline at end of file
+#include "engine/layer/layerstack.h"
+
+#include "engine/essentials/logfilesink.h"
+#include "engine/essentials/framestats.h"
+
+#include "engine/math/quat.h"
+#include "engine/math/batch.h"
+#include "engine/ecs/worldlayer.h"
\ No newline at end of file
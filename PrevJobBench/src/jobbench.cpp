@@ -0,0 +1,115 @@
+#include "engine/jobs/jobsystem.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace prev;
+
+// Measures how JobSystem::ParallelFor scales from 1 worker up to every core
+// Usage: PrevJobBench [--items N] [--iterations N] [--repeats N] [--out file.json]
+
+struct JobBenchConfig {
+	unsigned int Items = 1 << 20;
+	unsigned int Iterations = 64;		// Work per item
+	unsigned int Repeats = 20;
+	unsigned int BatchSize = 0;			// 0 lets ParallelFor pick
+	std::string OutputPath;
+};
+
+struct JobBenchResult {
+	unsigned int Workers;
+	double BestMs;
+	double MedianMs;
+};
+
+static bool ParseArgs(int argc, char ** argv, JobBenchConfig & config) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+			return false;
+		}
+		const char * value = argv[++i];
+		if (arg == "--items")				config.Items = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--iterations")		config.Iterations = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--repeats")		config.Repeats = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--batch")			config.BatchSize = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--out")			config.OutputPath = value;
+		else {
+			std::fprintf(stderr, "Unknown argument %s\n"
+						 "Usage: PrevJobBench [--items N] [--iterations N] [--repeats N] [--batch N] [--out file.json]\n",
+						 arg.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+static JobBenchResult RunScenario(const JobBenchConfig & config, unsigned int workers, std::vector<float> & data) {
+	JobSystem jobSystem(workers);
+	std::vector<double> times;
+
+	for (unsigned int repeat = 0; repeat < config.Repeats + 1; repeat++) {
+		auto start = std::chrono::steady_clock::now();
+		unsigned int iterations = config.Iterations;
+		jobSystem.ParallelFor(config.Items, config.BatchSize, [&data, iterations](unsigned int index) -> void {
+			float value = data[index];
+			for (unsigned int i = 0; i < iterations; i++)
+				value = std::sqrt(value * value + 1.0f) * 0.5f;
+			data[index] = value;
+		});
+		auto end = std::chrono::steady_clock::now();
+		// First run warms up the threads and caches
+		if (repeat > 0)
+			times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+	}
+
+	std::sort(times.begin(), times.end());
+	return { jobSystem.GetWorkerCount(), times.front(), times[times.size() / 2] };
+}
+
+int main(int argc, char ** argv) {
+	JobBenchConfig config;
+	if (!ParseArgs(argc, argv, config) || config.Repeats == 0)
+		return -1;
+
+	std::vector<float> data(config.Items, 1.0f);
+	unsigned int maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<JobBenchResult> results;
+	for (unsigned int workers = 1; workers <= maxWorkers; workers++)
+		results.push_back(RunScenario(config, workers, data));
+
+	FILE * file = stdout;
+	if (!config.OutputPath.empty()) {
+		file = std::fopen(config.OutputPath.c_str(), "w");
+		if (!file) {
+			std::fprintf(stderr, "Unable to open %s\n", config.OutputPath.c_str());
+			return -1;
+		}
+	}
+
+	std::fprintf(file,
+				 "{\n"
+				 "\t\"items\": %u,\n"
+				 "\t\"iterations\": %u,\n"
+				 "\t\"repeats\": %u,\n"
+				 "\t\"scenarios\": [\n",
+				 config.Items, config.Iterations, config.Repeats);
+	for (size_t i = 0; i < results.size(); i++) {
+		const JobBenchResult & result = results[i];
+		std::fprintf(file, "\t\t{ \"workers\": %u, \"best_ms\": %.6f, \"median_ms\": %.6f, \"speedup\": %.3f }%s\n",
+					 result.Workers, result.BestMs, result.MedianMs, results[0].MedianMs / result.MedianMs,
+					 i + 1 == results.size() ? "" : ",");
+	}
+	std::fprintf(file, "\t]\n}\n");
+
+	if (file != stdout)
+		std::fclose(file);
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "engine/essentials/logformat.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+using namespace prev;
+
+// Prints binary logs written by LogFileSink as text, one line per message
+static bool Decode(const char * path, std::FILE * out) {
+	std::FILE * file = std::fopen(path, "rb");
+	if (file == nullptr) {
+		std::fprintf(stderr, "Unable to open %s\n", path);
+		return false;
+	}
+
+	char magic[sizeof(LogBinaryMagic)];
+	if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) || std::memcmp(magic, LogBinaryMagic, sizeof(magic)) != 0) {
+		std::fprintf(stderr, "%s is not a binary log file\n", path);
+		std::fclose(file);
+		return false;
+	}
+
+	std::vector<char> message;
+	LogBinaryRecordHeader header;
+	while (std::fread(&header, sizeof(header), 1, file) == 1) {
+		message.resize(header.Length);
+		if (header.Length > 0 && std::fread(message.data(), 1, header.Length, file) != header.Length) {
+			std::fprintf(stderr, "%s ends in the middle of a record\n", path);
+			break;
+		}
+
+		std::time_t seconds = (std::time_t)(header.Timestamp / 1000000000ull);
+		unsigned int millis = (unsigned int)(header.Timestamp / 1000000ull % 1000ull);
+		std::tm time = {};
+	#ifdef PV_PLATFORM_WINDOWS
+		localtime_s(&time, &seconds);
+	#else
+		localtime_r(&seconds, &time);
+	#endif
+		std::fprintf(out, "%04d-%02d-%02d %02d:%02d:%02d.%03u [%s] %.*s\n",
+					 time.tm_year + 1900, time.tm_mon + 1, time.tm_mday, time.tm_hour, time.tm_min, time.tm_sec, millis,
+					 LogLevelNames[header.Level & 3], (int)message.size(), message.data());
+	}
+
+	std::fclose(file);
+	return true;
+}
+
+int main(int argc, char ** argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "Usage: PrevLogDecode file.pvlog [file.pvlog.1 ...]\n");
+		return -1;
+	}
+
+	// Rotated files are passed oldest first to get one continuous log
+	int result = 0;
+	for (int i = 1; i < argc; i++) {
+		if (!Decode(argv[i], stdout))
+			result = -1;
+	}
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,382 @@
+#include "prev.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace prev;
+using namespace prev::math;
+
+// Times the math batch kernels against their scalar versions, laid out like Google Benchmark
+// Every benchmark is registered with the sizes it runs at, runs until it has taken --min-time and prints a table
+// Before timing, the SIMD and scalar outputs are compared: a deterministic build has to match bit for bit, a fast one reports the largest error
+// Usage: PrevMathBench [--min-time ms] [--filter text] [--out file.json]
+// Exits with 1 when a deterministic build doesn't match the scalar kernels
+
+struct MathBenchConfig {
+	double MinTimeMs = 200.0;
+	std::string Filter;
+	std::string OutputPath;
+};
+
+// SoA inputs and outputs for every kernel, sized for the largest run
+struct MathBenchData {
+	std::vector<float> X, Y, Z, Radius;
+	std::vector<float> OutX, OutY, OutZ;
+	std::vector<Mat4> A, B, Out;
+	std::vector<unsigned char> Visible;
+	Mat4 ViewProjection;
+	Frustum ViewFrustum;
+};
+
+// What a benchmark gets, loops over KeepRunning() like benchmark::State
+class MathBenchState {
+public:
+	MathBenchState(MathBenchData & data, size_t range, size_t iterations) : m_Data(data), m_Range(range), m_Remaining(iterations) { }
+
+	inline bool KeepRunning() {
+		if (m_Remaining == 0)
+			return false;
+		m_Remaining--;
+		return true;
+	}
+
+	inline size_t GetRange() const { return m_Range; }
+	inline MathBenchData & GetData() { return m_Data; }
+private:
+	MathBenchData & m_Data;
+	size_t m_Range;
+	size_t m_Remaining;
+};
+
+typedef void(*MathBenchFunction)(MathBenchState & state);
+
+struct MathBenchmark {
+	const char * Kernel;
+	const char * Path;
+	MathBenchFunction Function;
+	std::vector<size_t> Ranges;
+};
+
+struct MathBenchResult {
+	std::string Name;
+	const char * Kernel;
+	const char * Path;
+	size_t Range;
+	size_t Iterations;
+	double NsPerIteration;
+	double ItemsPerSecond;
+};
+
+// What the compare found for one kernel at one size
+struct MathCheckResult {
+	const char * Kernel;
+	size_t Range;
+	bool BitIdentical;
+	float MaxError;
+};
+
+// Keeps the compiler from dropping a result nobody reads
+static volatile float s_Sink;
+
+template<typename T>
+static inline void DoNotOptimize(const T & value) {
+	s_Sink = (float)*(const volatile unsigned char *)&value;
+}
+
+static bool ParseArgs(int argc, char ** argv, MathBenchConfig & config) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+			return false;
+		}
+		const char * value = argv[++i];
+		if (arg == "--min-time")		config.MinTimeMs = std::strtod(value, nullptr);
+		else if (arg == "--filter")		config.Filter = value;
+		else if (arg == "--out")		config.OutputPath = value;
+		else {
+			std::fprintf(stderr, "Unknown argument %s\n"
+						 "Usage: PrevMathBench [--min-time ms] [--filter text] [--out file.json]\n",
+						 arg.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+static unsigned int s_Random = 0x9E3779B9u;
+
+// In [-1, 1)
+static float Random() {
+	s_Random ^= s_Random << 13;
+	s_Random ^= s_Random >> 17;
+	s_Random ^= s_Random << 5;
+	return (float)(s_Random >> 8) / 8388608.0f - 1.0f;
+}
+
+// Points in a 200 unit box around a camera looking at the origin, so about a third of the spheres are visible
+static void BuildData(MathBenchData & data, size_t count) {
+	data.X.resize(count);
+	data.Y.resize(count);
+	data.Z.resize(count);
+	data.Radius.resize(count);
+	data.OutX.resize(count);
+	data.OutY.resize(count);
+	data.OutZ.resize(count);
+	data.A.resize(count);
+	data.B.resize(count);
+	data.Out.resize(count);
+	data.Visible.resize(count);
+
+	for (size_t i = 0; i < count; i++) {
+		data.X[i] = Random() * 100.0f;
+		data.Y[i] = Random() * 100.0f;
+		data.Z[i] = Random() * 100.0f;
+		data.Radius[i] = Random() * 2.0f + 2.5f;
+	}
+	for (size_t i = 0; i < count; i++) {
+		Quat rotation = Normalize(Quat(Random(), Random(), Random(), Random() + 1.5f));
+		data.A[i] = Mat4::Translation(Vec3(data.X[i], data.Y[i], data.Z[i])) * ToMatrix(rotation);
+		data.B[i] = Mat4::Scale(Vec3(Random() + 2.0f, Random() + 2.0f, Random() + 2.0f));
+	}
+
+	Mat4 view = Mat4::LookAtLH(Vec3(0.0f, 20.0f, -150.0f), Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
+	data.ViewProjection = Mat4::PerspectiveLH(1.0f, 16.0f / 9.0f, 0.5f, 250.0f) * view;
+	data.ViewFrustum = Frustum::FromMatrix(data.ViewProjection);
+}
+
+static Vec3Spans<const float> Points(MathBenchData & data, size_t count) {
+	return { { data.X.data(), count }, { data.Y.data(), count }, { data.Z.data(), count } };
+}
+
+static Vec3Spans<float> OutPoints(MathBenchData & data, size_t count) {
+	return { { data.OutX.data(), count }, { data.OutY.data(), count }, { data.OutZ.data(), count } };
+}
+
+static SphereSpans Spheres(MathBenchData & data, size_t count) {
+	return { { data.X.data(), count }, { data.Y.data(), count }, { data.Z.data(), count }, { data.Radius.data(), count } };
+}
+
+static void BM_TransformPoints_Scalar(MathBenchState & state) {
+	MathBenchData & data = state.GetData();
+	while (state.KeepRunning()) {
+		scalar::TransformPoints(data.ViewProjection, Points(data, state.GetRange()), OutPoints(data, state.GetRange()));
+		DoNotOptimize(data.OutX[0]);
+	}
+}
+
+static void BM_TransformPoints_Simd(MathBenchState & state) {
+	MathBenchData & data = state.GetData();
+	while (state.KeepRunning()) {
+		TransformPoints(data.ViewProjection, Points(data, state.GetRange()), OutPoints(data, state.GetRange()));
+		DoNotOptimize(data.OutX[0]);
+	}
+}
+
+static void BM_MultiplyMatrices_Scalar(MathBenchState & state) {
+	MathBenchData & data = state.GetData();
+	while (state.KeepRunning()) {
+		scalar::MultiplyMatrices({ data.A.data(), state.GetRange() }, { data.B.data(), state.GetRange() }, { data.Out.data(), state.GetRange() });
+		DoNotOptimize(data.Out[0]);
+	}
+}
+
+static void BM_MultiplyMatrices_Simd(MathBenchState & state) {
+	MathBenchData & data = state.GetData();
+	while (state.KeepRunning()) {
+		MultiplyMatrices({ data.A.data(), state.GetRange() }, { data.B.data(), state.GetRange() }, { data.Out.data(), state.GetRange() });
+		DoNotOptimize(data.Out[0]);
+	}
+}
+
+static void BM_TestSpheres_Scalar(MathBenchState & state) {
+	MathBenchData & data = state.GetData();
+	while (state.KeepRunning())
+		DoNotOptimize(scalar::TestSpheres(data.ViewFrustum, Spheres(data, state.GetRange()), { data.Visible.data(), state.GetRange() }));
+}
+
+static void BM_TestSpheres_Simd(MathBenchState & state) {
+	MathBenchData & data = state.GetData();
+	while (state.KeepRunning())
+		DoNotOptimize(TestSpheres(data.ViewFrustum, Spheres(data, state.GetRange()), { data.Visible.data(), state.GetRange() }));
+}
+
+// 64 to 256k, in steps of 16 like Range(64, 1 << 18)
+static const std::vector<size_t> s_Ranges = { 64, 1024, 16384, 262144 };
+
+static const MathBenchmark s_Benchmarks[] = {
+	{ "TransformPoints", "scalar", BM_TransformPoints_Scalar, s_Ranges },
+	{ "TransformPoints", "simd", BM_TransformPoints_Simd, s_Ranges },
+	{ "MultiplyMatrices", "scalar", BM_MultiplyMatrices_Scalar, s_Ranges },
+	{ "MultiplyMatrices", "simd", BM_MultiplyMatrices_Simd, s_Ranges },
+	{ "TestSpheres", "scalar", BM_TestSpheres_Scalar, s_Ranges },
+	{ "TestSpheres", "simd", BM_TestSpheres_Simd, s_Ranges },
+};
+
+static double RunIterations(const MathBenchmark & benchmark, MathBenchData & data, size_t range, size_t iterations) {
+	MathBenchState state(data, range, iterations);
+	auto start = std::chrono::steady_clock::now();
+	benchmark.Function(state);
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static std::string GetName(const MathBenchmark & benchmark, size_t range) {
+	return std::string("BM_") + benchmark.Kernel + "/" + benchmark.Path + "/" + std::to_string(range);
+}
+
+// Grows the iteration count until a run takes at least the minimum time, the way Google Benchmark does
+static MathBenchResult Measure(const MathBenchConfig & config, const MathBenchmark & benchmark, MathBenchData & data, size_t range) {
+	RunIterations(benchmark, data, range, 1);
+	size_t iterations = 1;
+	double ms = 0.0;
+	for (;;) {
+		ms = RunIterations(benchmark, data, range, iterations);
+		if (ms >= config.MinTimeMs || iterations >= 1000000000)
+			break;
+		double scale = ms > config.MinTimeMs / 10.0 ? config.MinTimeMs * 1.4 / ms : 10.0;
+		iterations = std::max(iterations + 1, (size_t)((double)iterations * scale));
+	}
+
+	MathBenchResult result;
+	result.Name = GetName(benchmark, range);
+	result.Kernel = benchmark.Kernel;
+	result.Path = benchmark.Path;
+	result.Range = range;
+	result.Iterations = iterations;
+	result.NsPerIteration = ms * 1000000.0 / (double)iterations;
+	result.ItemsPerSecond = (double)range * (double)iterations / (ms / 1000.0);
+	return result;
+}
+
+static void CompareFloats(const float * a, const float * b, size_t count, MathCheckResult & check) {
+	for (size_t i = 0; i < count; i++) {
+		if (std::memcmp(&a[i], &b[i], sizeof(float)) != 0)
+			check.BitIdentical = false;
+		check.MaxError = std::max(check.MaxError, std::abs(a[i] - b[i]) / std::max(1.0f, std::abs(b[i])));
+	}
+}
+
+// Runs both paths on the same input and compares what they wrote, the error is relative above 1
+static void Check(MathBenchData & data, size_t range, std::vector<MathCheckResult> & checks) {
+	MathCheckResult transform = { "TransformPoints", range, true, 0.0f };
+	std::vector<float> x(range), y(range), z(range);
+	scalar::TransformPoints(data.ViewProjection, Points(data, range), { { x.data(), range }, { y.data(), range }, { z.data(), range } });
+	TransformPoints(data.ViewProjection, Points(data, range), OutPoints(data, range));
+	CompareFloats(data.OutX.data(), x.data(), range, transform);
+	CompareFloats(data.OutY.data(), y.data(), range, transform);
+	CompareFloats(data.OutZ.data(), z.data(), range, transform);
+	checks.push_back(transform);
+
+	MathCheckResult multiply = { "MultiplyMatrices", range, true, 0.0f };
+	std::vector<Mat4> matrices(range);
+	scalar::MultiplyMatrices({ data.A.data(), range }, { data.B.data(), range }, matrices);
+	MultiplyMatrices({ data.A.data(), range }, { data.B.data(), range }, { data.Out.data(), range });
+	for (size_t i = 0; i < range; i++) {
+		float simd[16], expected[16];
+		data.Out[i].Store(simd);
+		matrices[i].Store(expected);
+		CompareFloats(simd, expected, 16, multiply);
+	}
+	checks.push_back(multiply);
+
+	// A sphere on the wrong side of a plane is an error of 1
+	MathCheckResult spheres = { "TestSpheres", range, true, 0.0f };
+	std::vector<unsigned char> visible(range);
+	size_t expected = scalar::TestSpheres(data.ViewFrustum, Spheres(data, range), visible);
+	size_t count = TestSpheres(data.ViewFrustum, Spheres(data, range), { data.Visible.data(), range });
+	if (count != expected || !std::equal(visible.begin(), visible.end(), data.Visible.begin())) {
+		spheres.BitIdentical = false;
+		spheres.MaxError = 1.0f;
+	}
+	checks.push_back(spheres);
+}
+
+int main(int argc, char ** argv) {
+	MathBenchConfig config;
+	if (!ParseArgs(argc, argv, config) || config.MinTimeMs <= 0.0)
+		return -1;
+
+	size_t maxRange = *std::max_element(s_Ranges.begin(), s_Ranges.end());
+	MathBenchData data;
+	BuildData(data, maxRange);
+
+	int exitCode = 0;
+	std::vector<MathCheckResult> checks;
+	for (size_t range : s_Ranges)
+		Check(data, range, checks);
+	for (const MathCheckResult & check : checks) {
+		if (IsDeterministic() && !check.BitIdentical) {
+			std::fprintf(stderr, "%s/%zu: the %s kernel doesn't match the scalar one in a deterministic build, max error %g\n",
+						 check.Kernel, check.Range, GetBackendName(), check.MaxError);
+			exitCode = 1;
+		}
+	}
+
+	std::printf("Math backend: %s, %s\n", GetBackendName(), IsDeterministic() ? "deterministic" : "fast");
+	std::printf("%-40s %14s %12s %16s\n", "Benchmark", "Time", "Iterations", "Items/s");
+	std::printf("%s\n", std::string(85, '-').c_str());
+
+	std::vector<MathBenchResult> results;
+	for (const MathBenchmark & benchmark : s_Benchmarks) {
+		for (size_t range : benchmark.Ranges) {
+			if (!config.Filter.empty() && GetName(benchmark, range).find(config.Filter) == std::string::npos)
+				continue;
+			MathBenchResult result = Measure(config, benchmark, data, range);
+			std::printf("%-40s %11.0f ns %12zu %14.2fM/s\n", result.Name.c_str(), result.NsPerIteration, result.Iterations, result.ItemsPerSecond / 1000000.0);
+			results.push_back(result);
+		}
+	}
+
+	// Scalar time over SIMD time for every kernel and size
+	std::printf("\n%-20s %10s %10s %12s %10s\n", "Kernel", "Range", "Speedup", "Identical", "MaxError");
+	for (const MathCheckResult & check : checks) {
+		const MathBenchResult * scalarResult = nullptr;
+		const MathBenchResult * simdResult = nullptr;
+		for (const MathBenchResult & result : results) {
+			if (result.Range != check.Range || std::string(result.Kernel) != check.Kernel)
+				continue;
+			(std::string(result.Path) == "scalar" ? scalarResult : simdResult) = &result;
+		}
+		double speedup = scalarResult && simdResult ? scalarResult->NsPerIteration / simdResult->NsPerIteration : 0.0;
+		std::printf("%-20s %10zu %9.2fx %12s %10g\n", check.Kernel, check.Range, speedup, check.BitIdentical ? "yes" : "no", check.MaxError);
+	}
+
+	if (!config.OutputPath.empty()) {
+		FILE * file = std::fopen(config.OutputPath.c_str(), "w");
+		if (!file) {
+			std::fprintf(stderr, "Unable to open %s\n", config.OutputPath.c_str());
+			return -1;
+		}
+		std::fprintf(file,
+					 "{\n"
+					 "\t\"backend\": \"%s\",\n"
+					 "\t\"deterministic\": %s,\n"
+					 "\t\"min_time_ms\": %.3f,\n"
+					 "\t\"benchmarks\": [\n",
+					 GetBackendName(), IsDeterministic() ? "true" : "false", config.MinTimeMs);
+		for (size_t i = 0; i < results.size(); i++) {
+			const MathBenchResult & result = results[i];
+			std::fprintf(file, "\t\t{ \"name\": \"%s\", \"kernel\": \"%s\", \"path\": \"%s\", \"range\": %zu, \"iterations\": %zu, \"ns_per_iteration\": %.3f, \"items_per_second\": %.1f }%s\n",
+						 result.Name.c_str(), result.Kernel, result.Path, result.Range, result.Iterations, result.NsPerIteration, result.ItemsPerSecond,
+						 i + 1 == results.size() ? "" : ",");
+		}
+		std::fprintf(file, "\t],\n\t\"checks\": [\n");
+		for (size_t i = 0; i < checks.size(); i++) {
+			const MathCheckResult & check = checks[i];
+			std::fprintf(file, "\t\t{ \"kernel\": \"%s\", \"range\": %zu, \"bit_identical\": %s, \"max_error\": %g }%s\n",
+						 check.Kernel, check.Range, check.BitIdentical ? "true" : "false", check.MaxError,
+						 i + 1 == checks.size() ? "" : ",");
+		}
+		std::fprintf(file, "\t]\n}\n");
+		std::fclose(file);
+	}
+
+	return exitCode;
+}
\ No newline at end of file
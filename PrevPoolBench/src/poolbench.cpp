@@ -0,0 +1,191 @@
+#include "engine/memory/poolallocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace prev;
+
+// Compares ObjectPool and PoolAllocator against new / delete, on one thread and on every core
+// Usage: PrevPoolBench [--objects N] [--rounds N] [--repeats N] [--out file.json]
+
+struct PoolBenchConfig {
+	unsigned int Objects = 1 << 14;		// Live at once per thread
+	unsigned int Rounds = 64;			// Times every object is freed and allocated again
+	unsigned int Repeats = 10;
+	std::string OutputPath;
+};
+
+struct PoolBenchResult {
+	const char * Name;
+	const char * Allocator;
+	unsigned int Threads;
+	double BestMs;
+	double MedianMs;
+	double NsPerOperation;
+};
+
+// About the size of a small layer or a queued event
+struct BenchObject {
+	unsigned long long Id;
+	float Data[14];
+
+	BenchObject(unsigned long long id) : Id(id) {
+		Data[0] = (float)id;
+	}
+};
+
+static bool ParseArgs(int argc, char ** argv, PoolBenchConfig & config) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+			return false;
+		}
+		const char * value = argv[++i];
+		if (arg == "--objects")			config.Objects = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--rounds")		config.Rounds = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--repeats")	config.Repeats = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--out")		config.OutputPath = value;
+		else {
+			std::fprintf(stderr, "Unknown argument %s\n"
+						 "Usage: PrevPoolBench [--objects N] [--rounds N] [--repeats N] [--out file.json]\n",
+						 arg.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+// Every round frees a scattered half of the objects and allocates them again, so free lists get shuffled like in a real frame
+template<typename Allocate, typename Free>
+static void Churn(const PoolBenchConfig & config, unsigned int seed, Allocate && allocate, Free && free) {
+	std::vector<void *> objects(config.Objects);
+	for (unsigned int i = 0; i < config.Objects; i++)
+		objects[i] = allocate(i);
+
+	unsigned int random = seed * 2654435761u + 1;
+	for (unsigned int round = 0; round < config.Rounds; round++) {
+		for (unsigned int i = 0; i < config.Objects / 2; i++) {
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			unsigned int index = random % config.Objects;
+			free(objects[index], index);
+			objects[index] = allocate(index);
+		}
+	}
+
+	for (unsigned int i = 0; i < config.Objects; i++)
+		free(objects[i], i);
+}
+
+// Mixed sizes for the size class allocator, from 16 bytes up to 1 KB
+static size_t ObjectSize(unsigned int index) {
+	return (size_t)16 << (index % 7);
+}
+
+template<typename Scenario>
+static PoolBenchResult Measure(const PoolBenchConfig & config, const char * name, const char * allocator, unsigned int threads, Scenario && scenario) {
+	std::vector<double> times;
+	for (unsigned int repeat = 0; repeat < config.Repeats + 1; repeat++) {
+		auto start = std::chrono::steady_clock::now();
+		if (threads == 1) {
+			scenario(0u);
+		} else {
+			std::vector<std::thread> workers;
+			for (unsigned int t = 0; t < threads; t++)
+				workers.emplace_back([&scenario, t]() { scenario(t); });
+			for (auto & worker : workers)
+				worker.join();
+		}
+		auto end = std::chrono::steady_clock::now();
+		// First run grows the pools and warms the caches
+		if (repeat > 0)
+			times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+	}
+
+	std::sort(times.begin(), times.end());
+	double operations = 2.0 * threads * (config.Objects + (double)config.Rounds * (config.Objects / 2));
+	double median = times[times.size() / 2];
+	return { name, allocator, threads, times.front(), median, median * 1000000.0 / operations };
+}
+
+static void RunScenarios(const PoolBenchConfig & config, unsigned int threads, std::vector<PoolBenchResult> & results) {
+	results.push_back(Measure(config, "object", "new_delete", threads, [&config](unsigned int t) {
+		Churn(config, t, [](unsigned int i) -> void * { return new BenchObject(i); },
+			  [](void * ptr, unsigned int i) { delete (BenchObject *)ptr; });
+	}));
+
+	for (bool threadCaches : { false, true }) {
+		PoolDesc desc;
+		desc.ThreadCaches = threadCaches;
+		desc.BlocksPerSlab = 256;
+		ObjectPool<BenchObject> pool(desc);
+		results.push_back(Measure(config, "object", threadCaches ? "object_pool_cached" : "object_pool", threads, [&config, &pool](unsigned int t) {
+			Churn(config, t, [&pool](unsigned int i) -> void * { return pool.Create(i); },
+				  [&pool](void * ptr, unsigned int i) { pool.Destroy((BenchObject *)ptr); });
+		}));
+	}
+
+	results.push_back(Measure(config, "mixed_sizes", "new_delete", threads, [&config](unsigned int t) {
+		Churn(config, t, [](unsigned int i) -> void * { return ::operator new(ObjectSize(i)); },
+			  [](void * ptr, unsigned int i) { ::operator delete(ptr); });
+	}));
+
+	for (bool threadCaches : { false, true }) {
+		PoolDesc desc;
+		desc.ThreadCaches = threadCaches;
+		desc.BlocksPerSlab = 256;
+		PoolAllocator pool(desc);
+		results.push_back(Measure(config, "mixed_sizes", threadCaches ? "pool_allocator_cached" : "pool_allocator", threads, [&config, &pool](unsigned int t) {
+			Churn(config, t, [&pool](unsigned int i) -> void * { return pool.allocate(ObjectSize(i)); },
+				  [&pool](void * ptr, unsigned int i) { pool.deallocate(ptr, ObjectSize(i)); });
+		}));
+	}
+}
+
+int main(int argc, char ** argv) {
+	PoolBenchConfig config;
+	if (!ParseArgs(argc, argv, config) || config.Repeats == 0 || config.Objects == 0)
+		return -1;
+
+	std::vector<PoolBenchResult> results;
+	RunScenarios(config, 1, results);
+	unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	if (maxThreads > 1)
+		RunScenarios(config, maxThreads, results);
+
+	FILE * file = stdout;
+	if (!config.OutputPath.empty()) {
+		file = std::fopen(config.OutputPath.c_str(), "w");
+		if (!file) {
+			std::fprintf(stderr, "Unable to open %s\n", config.OutputPath.c_str());
+			return -1;
+		}
+	}
+
+	std::fprintf(file,
+				 "{\n"
+				 "\t\"objects\": %u,\n"
+				 "\t\"rounds\": %u,\n"
+				 "\t\"repeats\": %u,\n"
+				 "\t\"scenarios\": [\n",
+				 config.Objects, config.Rounds, config.Repeats);
+	for (size_t i = 0; i < results.size(); i++) {
+		const PoolBenchResult & result = results[i];
+		std::fprintf(file, "\t\t{ \"scenario\": \"%s\", \"allocator\": \"%s\", \"threads\": %u, \"best_ms\": %.6f, \"median_ms\": %.6f, \"ns_per_op\": %.3f }%s\n",
+					 result.Name, result.Allocator, result.Threads, result.BestMs, result.MedianMs, result.NsPerOperation,
+					 i + 1 == results.size() ? "" : ",");
+	}
+	std::fprintf(file, "\t]\n}\n");
+
+	if (file != stdout)
+		std::fclose(file);
+
+	return 0;
+}
\ No newline at end of file
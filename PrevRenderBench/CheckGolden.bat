@@ -0,0 +1,7 @@
+@echo off
+rem Rasterizes the bench scene and compares it with golden\raster.png, exits with 1 when they differ
+rem Usage: CheckGolden.bat [path to PrevRenderBench.exe], the Release build by default
+set BENCH=%~1
+if "%BENCH%"=="" set BENCH=%~dp0..\bin\Release-windows-x86_64\PrevRenderBench\PrevRenderBench.exe
+"%BENCH%" --draws 1000 --repeats 1 --out NUL --golden "%~dp0golden\raster.png"
+exit /b %ERRORLEVEL%
\ No newline at end of file
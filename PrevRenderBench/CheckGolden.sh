@@ -0,0 +1,6 @@
+#!/bin/sh
+# Rasterizes the bench scene and compares it with golden/raster.png, exits with 1 when they differ
+# Usage: CheckGolden.sh [path to PrevRenderBench], the Release build by default
+DIR=$(dirname "$0")
+BENCH=${1:-$DIR/../bin/Release-linux-x86_64/PrevRenderBench/PrevRenderBench}
+"$BENCH" --draws 1000 --repeats 1 --out /dev/null --golden "$DIR/golden/raster.png"
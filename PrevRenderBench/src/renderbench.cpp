@@ -0,0 +1,390 @@
+#include "prev.h"
+
+#include "engine/render/commandbuffer.h"
+#include "engine/jobs/jobsystem.h"
+#include "api/null/nullapi.h"
+#include "api/software/softwareapi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace prev;
+
+// Records draws into a RenderQueue from the job system, sorts them and submits them to the null api
+// Sorting is compared against std::stable_sort on the same keys, all of it runs without a GPU
+// Also reports the state changes the null api's state cache filtered, for the queue sorted and in recording order
+// Rasterizes a scene of cubes with the software api, the frame can be dumped or compared against a golden PNG
+// Usage: PrevRenderBench [--draws N] [--repeats N] [--out file.json] [--dump file.png] [--golden file.png] [--tolerance N]
+// Exits with 1 when the frame doesn't match the golden image or changes with the thread count
+// CheckGolden.sh (or .bat) runs it against golden/raster.png, rebuild that with --dump when the rasterizer changes on purpose
+
+struct RenderBenchConfig {
+	unsigned int Draws = 100000;
+	unsigned int Repeats = 10;
+	std::string OutputPath;
+	std::string DumpPath;
+	std::string GoldenPath;
+	unsigned int Tolerance = 0;	// Per channel, for goldens made by another compiler
+};
+
+struct RenderBenchResult {
+	const char * Name;
+	const char * Variant;
+	unsigned int Threads;
+	double BestMs;
+	double MedianMs;
+	double NsPerCommand;
+};
+
+static bool ParseArgs(int argc, char ** argv, RenderBenchConfig & config) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+			return false;
+		}
+		const char * value = argv[++i];
+		if (arg == "--draws")			config.Draws = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--repeats")	config.Repeats = (unsigned int)std::strtoul(value, nullptr, 10);
+		else if (arg == "--out")		config.OutputPath = value;
+		else if (arg == "--dump")		config.DumpPath = value;
+		else if (arg == "--golden")		config.GoldenPath = value;
+		else if (arg == "--tolerance")	config.Tolerance = (unsigned int)std::strtoul(value, nullptr, 10);
+		else {
+			std::fprintf(stderr, "Unknown argument %s\n"
+						 "Usage: PrevRenderBench [--draws N] [--repeats N] [--out file.json] [--dump file.png] [--golden file.png] [--tolerance N]\n",
+						 arg.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+static unsigned int DrawRandom(unsigned int index) {
+	unsigned int random = index * 2654435761u + 1;
+	random ^= random << 13;
+	random ^= random >> 17;
+	random ^= random << 5;
+	return random;
+}
+
+// Like a scene: 2 layers, 4 passes, 256 materials, depth all over the place
+static unsigned long long DrawKey(unsigned int index) {
+	unsigned int random = DrawRandom(index);
+	unsigned int pass = random & 3;
+	float depth = (float)((random >> 8) & 0xFFFF) / 65535.0f;
+	if (pass == 3)
+		return SortKey::DrawBackToFront((random >> 2) & 1, pass, random >> 24, depth);
+	return SortKey::Draw((random >> 2) & 1, pass, random >> 24, depth);
+}
+
+// A material is a pipeline and its textures, 16 pipelines shared by the 256 materials
+// With sortKeys false every draw gets the same key, so the queue keeps recording order
+static void RecordRange(RenderQueue & queue, unsigned int begin, unsigned int end, bool sortKeys = true) {
+	CommandBuffer & buffer = queue.GetBuffer();
+	for (unsigned int i = begin; i < end; i++) {
+		unsigned int material = DrawRandom(i) >> 24;
+		DrawCommand & draw = buffer.Record<DrawCommand>(sortKeys ? DrawKey(i) : SortKey::Draw(0, 0, 0, 0.0f));
+		draw.Pipeline = (material >> 4) + 1;
+		draw.VertexBuffer = (i & 0x3F) + 1;
+		draw.IndexBuffer = (i & 0x3F) + 1;
+		draw.Textures[0] = material + 1;
+		draw.Textures[1] = (material & 0xF) + 1;
+		draw.Count = 36;
+	}
+}
+
+template<typename Scenario>
+static RenderBenchResult Measure(const RenderBenchConfig & config, const char * name, const char * variant, unsigned int threads, unsigned int commands, Scenario && scenario) {
+	std::vector<double> times;
+	for (unsigned int repeat = 0; repeat < config.Repeats + 1; repeat++) {
+		double ms = scenario();
+		// First run grows the buffers
+		if (repeat > 0)
+			times.push_back(ms);
+	}
+
+	std::sort(times.begin(), times.end());
+	double median = times[times.size() / 2];
+	return { name, variant, threads, times.front(), median, median * 1000000.0 / commands };
+}
+
+template<typename F>
+static double Time(F && func) {
+	auto start = std::chrono::steady_clock::now();
+	func();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Column major 4x4 matrices for the raster scene
+struct Matrix {
+	float M[16];
+};
+
+static Matrix Multiply(const Matrix & a, const Matrix & b) {
+	Matrix result;
+	for (unsigned int column = 0; column < 4; column++) {
+		for (unsigned int row = 0; row < 4; row++) {
+			float sum = 0.0f;
+			for (unsigned int k = 0; k < 4; k++)
+				sum += a.M[k * 4 + row] * b.M[column * 4 + k];
+			result.M[column * 4 + row] = sum;
+		}
+	}
+	return result;
+}
+
+// Left handed, depth in [0, 1] like DirectX
+static Matrix Perspective(float fovY, float aspect, float nearZ, float farZ) {
+	float yScale = 1.0f / std::tan(fovY * 0.5f);
+	float range = farZ / (farZ - nearZ);
+	return { {
+		yScale / aspect, 0.0f, 0.0f, 0.0f,
+		0.0f, yScale, 0.0f, 0.0f,
+		0.0f, 0.0f, range, 1.0f,
+		0.0f, 0.0f, -nearZ * range, 0.0f
+	} };
+}
+
+static Matrix Model(float x, float y, float z, float scale, float yaw, float pitch) {
+	float cy = std::cos(yaw), sy = std::sin(yaw), cp = std::cos(pitch), sp = std::sin(pitch);
+	return { {
+		cy * scale, 0.0f, -sy * scale, 0.0f,
+		sy * sp * scale, cp * scale, cy * sp * scale, 0.0f,
+		sy * cp * scale, -sp * scale, cy * cp * scale, 0.0f,
+		x, y, z, 1.0f
+	} };
+}
+
+// Quad at center + a * u + b * v, clockwise seen from the side u x v points away from
+static void AddQuad(std::vector<SoftwareVertex> & vertices, std::vector<unsigned int> & indices, const float center[3], const float u[3], const float v[3], const float colors[4][4]) {
+	const float corners[4][2] = { { -1.0f, -1.0f }, { -1.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, -1.0f } };
+	unsigned int first = (unsigned int)vertices.size();
+	for (unsigned int i = 0; i < 4; i++) {
+		float a = corners[i][0], b = corners[i][1];
+		vertices.push_back({ center[0] + a * u[0] + b * v[0], center[1] + a * u[1] + b * v[1], center[2] + a * u[2] + b * v[2], 1.0f,
+							 colors[i][0], colors[i][1], colors[i][2], colors[i][3] });
+	}
+	indices.insert(indices.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+}
+
+// A few thousand cubes in front of the camera over a ground plane that crosses the near plane
+// Every cube has its own pipeline (transform), returns the number of draws
+static unsigned int BuildRasterScene(SoftwareAPI & api, RenderQueue & queue, unsigned int width, unsigned int height) {
+	std::vector<SoftwareVertex> vertices;
+	std::vector<unsigned int> indices;
+	for (unsigned int axis = 0; axis < 3; axis++) {
+		for (float sign : { -1.0f, 1.0f }) {
+			// v = u x n keeps every face clockwise from outside
+			float n[3] = {}, u[3] = {};
+			n[axis] = sign;
+			u[(axis + 1) % 3] = 1.0f;
+			float v[3] = { u[1] * n[2] - u[2] * n[1], u[2] * n[0] - u[0] * n[2], u[0] * n[1] - u[1] * n[0] };
+			float colors[4][4];
+			for (unsigned int i = 0; i < 4; i++) {
+				colors[i][0] = axis == 0 ? 1.0f : 0.25f * i;
+				colors[i][1] = axis == 1 ? 1.0f : 0.3f + 0.1f * i;
+				colors[i][2] = axis == 2 ? 1.0f : (sign > 0.0f ? 0.8f : 0.2f);
+				colors[i][3] = 1.0f;
+			}
+			AddQuad(vertices, indices, n, u, v, colors);
+		}
+	}
+	const unsigned int cubeVertices = api.CreateVertexBuffer(vertices.data(), (unsigned int)vertices.size());
+	const unsigned int cubeIndices = api.CreateIndexBuffer(indices.data(), (unsigned int)indices.size());
+
+	vertices.clear();
+	indices.clear();
+	const float groundCenter[3] = { 0.0f, -3.0f, 0.0f }, groundU[3] = { 0.0f, 0.0f, 60.0f }, groundV[3] = { -60.0f, 0.0f, 0.0f };
+	const float groundColors[4][4] = { { 0.1f, 0.1f, 0.1f, 1.0f }, { 0.2f, 0.6f, 0.2f, 1.0f }, { 0.9f, 0.9f, 0.9f, 1.0f }, { 0.6f, 0.2f, 0.2f, 1.0f } };
+	AddQuad(vertices, indices, groundCenter, groundU, groundV, groundColors);
+	const unsigned int groundVertices = api.CreateVertexBuffer(vertices.data(), (unsigned int)vertices.size());
+	const unsigned int groundIndices = api.CreateIndexBuffer(indices.data(), (unsigned int)indices.size());
+
+	const Matrix projection = Perspective(1.0f, (float)width / height, 0.1f, 100.0f);
+	CommandBuffer & buffer = queue.GetBuffer();
+	ClearCommand & clear = buffer.Record<ClearCommand>(SortKey::Setup(0, 0));
+	clear.Flags = ClearColor | ClearDepth;
+	clear.Color[0] = 0.05f;
+	clear.Color[1] = 0.05f;
+	clear.Color[2] = 0.1f;
+	clear.Color[3] = 1.0f;
+	clear.Depth = 1.0f;
+
+	const unsigned int cubes = 2000;
+	for (unsigned int i = 0; i <= cubes; i++) {
+		unsigned int random = DrawRandom(i);
+		float z = i == cubes ? 0.0f : 5.0f + (float)(random & 0xFF) / 255.0f * 40.0f;
+		Matrix model = Model(((float)((random >> 8) & 0xFF) / 255.0f - 0.5f) * z * 1.2f, ((float)((random >> 16) & 0xFF) / 255.0f - 0.4f) * z * 0.6f, z,
+							 0.3f + (float)(random >> 28) / 15.0f * 0.5f, (float)(random & 0x3FF) * 0.01f, (float)((random >> 10) & 0x3FF) * 0.01f);
+		SoftwarePipelineDesc pipeline;
+		const Matrix transform = Multiply(projection, i == cubes ? Model(0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f) : model);
+		std::copy_n(transform.M, 16, pipeline.Transform);
+
+		DrawCommand & draw = buffer.Record<DrawCommand>(SortKey::Draw(0, 0, 0, z / 100.0f));
+		draw.Pipeline = api.CreatePipeline(pipeline);
+		draw.VertexBuffer = i == cubes ? groundVertices : cubeVertices;
+		draw.IndexBuffer = i == cubes ? groundIndices : cubeIndices;
+		draw.Count = (unsigned int)(i == cubes ? 6 : 36);
+	}
+	queue.Sort();
+	return cubes + 1;
+}
+
+static void RunScenarios(const RenderBenchConfig & config, unsigned int threads, std::vector<RenderBenchResult> & results, Image & frame) {
+	JobSystem jobSystem(threads);
+	RenderQueue queue(&jobSystem);
+	const unsigned int batches = threads * 8;
+	const unsigned int batchSize = (config.Draws + batches - 1) / batches;
+
+	results.push_back(Measure(config, "record", "command_buffer", threads, config.Draws, [&]() -> double {
+		queue.Reset();
+		return Time([&]() {
+			jobSystem.ParallelFor(batches, 1, [&](unsigned int batch) {
+				RecordRange(queue, std::min(config.Draws, batch * batchSize), std::min(config.Draws, (batch + 1) * batchSize));
+			});
+		});
+	}));
+
+	GraphicsDesc softwareDesc(960, 540, false);
+	softwareDesc.Jobs = &jobSystem;
+	SoftwareAPI software(nullptr, WindowAPI::WINDOWING_API_NULL, softwareDesc);
+	RenderQueue scene;
+	const unsigned int sceneDraws = BuildRasterScene(software, scene, softwareDesc.Width, softwareDesc.Height);
+	results.push_back(Measure(config, "raster", SoftwareRasterizer::GetSimdName(), threads, sceneDraws, [&]() -> double {
+		return Time([&]() { software.Submit(scene); });
+	}));
+	frame = software.ReadFramebuffer();
+
+	// Sorting and submitting happen on one thread, only worth measuring once
+	if (threads != 1)
+		return;
+
+	results.push_back(Measure(config, "sort", "radix", threads, config.Draws, [&]() -> double {
+		return Time([&]() { queue.Sort(); });
+	}));
+
+	std::vector<RenderSortEntry> entries(queue.GetSorted().begin(), queue.GetSorted().end());
+	std::vector<RenderSortEntry> unsorted(config.Draws);
+	results.push_back(Measure(config, "sort", "std_stable_sort", threads, config.Draws, [&]() -> double {
+		for (unsigned int i = 0; i < config.Draws; i++)
+			unsorted[i] = { DrawKey(i), entries[i].Command };
+		return Time([&]() {
+			std::stable_sort(unsorted.begin(), unsorted.end(), [](const RenderSortEntry & a, const RenderSortEntry & b) -> bool {
+				return a.Key < b.Key;
+			});
+		});
+	}));
+
+	for (size_t i = 1; i < queue.GetSorted().size(); i++) {
+		if (queue.GetSorted()[i - 1].Key > queue.GetSorted()[i].Key) {
+			std::fprintf(stderr, "Render queue isn't sorted at %u\n", (unsigned int)i);
+			break;
+		}
+	}
+
+	GraphicsDesc graphicsDesc(1280, 720, false);
+	NullAPI api(nullptr, WindowAPI::WINDOWING_API_NULL, graphicsDesc);
+	results.push_back(Measure(config, "submit", "null_api", threads, config.Draws, [&]() -> double {
+		return Time([&]() { api.Submit(queue); });
+	}));
+}
+
+struct StateFilterResult {
+	const char * Order;
+	RenderStateCounters Counters;
+};
+
+// State changes the cache lets through for the same draws, sorted by key and in the order they were recorded
+static void RunStateFilter(const RenderBenchConfig & config, std::vector<StateFilterResult> & results) {
+	GraphicsDesc graphicsDesc(1280, 720, false);
+	NullAPI api(nullptr, WindowAPI::WINDOWING_API_NULL, graphicsDesc);
+	for (bool sortKeys : { true, false }) {
+		RenderQueue queue;
+		RecordRange(queue, 0, config.Draws, sortKeys);
+		queue.Sort();
+		api.Submit(queue);
+		results.push_back({ sortKeys ? "sorted" : "recorded", api.GetStateCounters() });
+	}
+}
+
+int main(int argc, char ** argv) {
+	RenderBenchConfig config;
+	if (!ParseArgs(argc, argv, config) || config.Repeats == 0 || config.Draws == 0)
+		return -1;
+
+	std::vector<RenderBenchResult> results;
+	Image frame, threadedFrame;
+	RunScenarios(config, 1, results, frame);
+	unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	if (maxThreads > 1)
+		RunScenarios(config, maxThreads, results, threadedFrame);
+
+	int exitCode = 0;
+	if (maxThreads > 1 && !CompareImages(frame, threadedFrame).Matches()) {
+		std::fprintf(stderr, "Software raster frame changes with %u threads\n", maxThreads);
+		exitCode = 1;
+	}
+	if (!config.DumpPath.empty() && !WritePNG(config.DumpPath, frame))
+		return -1;
+	if (!config.GoldenPath.empty()) {
+		Image golden;
+		if (!ReadPNG(config.GoldenPath, golden))
+			return -1;
+		ImageDiff diff = CompareImages(frame, golden, config.Tolerance);
+		if (!diff.Matches()) {
+			std::fprintf(stderr, "Software raster frame doesn't match %s: %s, %u pixels off, max channel delta %u\n",
+						 config.GoldenPath.c_str(), diff.SameSize ? "same size" : "different size", diff.DifferentPixels, diff.MaxChannelDelta);
+			exitCode = 1;
+		}
+	}
+
+	std::vector<StateFilterResult> stateFilter;
+	RunStateFilter(config, stateFilter);
+
+	FILE * file = stdout;
+	if (!config.OutputPath.empty()) {
+		file = std::fopen(config.OutputPath.c_str(), "w");
+		if (!file) {
+			std::fprintf(stderr, "Unable to open %s\n", config.OutputPath.c_str());
+			return -1;
+		}
+	}
+
+	std::fprintf(file,
+				 "{\n"
+				 "\t\"draws\": %u,\n"
+				 "\t\"repeats\": %u,\n"
+				 "\t\"scenarios\": [\n",
+				 config.Draws, config.Repeats);
+	for (size_t i = 0; i < results.size(); i++) {
+		const RenderBenchResult & result = results[i];
+		std::fprintf(file, "\t\t{ \"scenario\": \"%s\", \"variant\": \"%s\", \"threads\": %u, \"best_ms\": %.6f, \"median_ms\": %.6f, \"ns_per_command\": %.3f }%s\n",
+					 result.Name, result.Variant, result.Threads, result.BestMs, result.MedianMs, result.NsPerCommand,
+					 i + 1 == results.size() ? "" : ",");
+	}
+	std::fprintf(file, "\t],\n\t\"state_filter\": [\n");
+	for (size_t i = 0; i < stateFilter.size(); i++) {
+		const RenderStateCounters & counters = stateFilter[i].Counters;
+		std::fprintf(file, "\t\t{ \"order\": \"%s\", \"issued\": %u, \"filtered\": %u, \"filter_rate\": %.4f",
+					 stateFilter[i].Order, counters.GetIssued(), counters.GetFiltered(), counters.GetFilterRate());
+		for (unsigned int state = 0; state < (unsigned int)RenderState::Count; state++) {
+			std::fprintf(file, ", \"%s\": [%u, %u]", RenderStateCache::GetStateName((RenderState)state),
+						 counters.Issued[state], counters.Filtered[state]);
+		}
+		std::fprintf(file, " }%s\n", i + 1 == stateFilter.size() ? "" : ",");
+	}
+	std::fprintf(file, "\t]\n}\n");
+
+	if (file != stdout)
+		std::fclose(file);
+
+	return exitCode;
+}
\ No newline at end of file
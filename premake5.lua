@@ -17,16 +17,59 @@ workspace "PrevEngine"
 	
 	include "PrevEngine/vendor/ImGui"
 	
+	newoption {
+		trigger = "headless",
+		description = "Build only the null window and null graphics backends (no OS window, no GPU)"
+	}
+	
+	newoption {
+		trigger = "avx2",
+		description = "Compile for AVX2, the software rasterizer uses 8 wide rows instead of SSE2 pairs"
+	}
+	
+	newoption {
+		trigger = "sse4",
+		description = "Compile for SSE4.1, the math library uses SSE4 instead of its scalar fallback"
+	}
+	
+	newoption {
+		trigger = "deterministic-math",
+		description = "Make every math backend give the same bits as the scalar one (no FMA, no contraction)"
+	}
+	
+	if _OPTIONS["avx2"] then
+		vectorextensions "AVX2"
+	elseif _OPTIONS["sse4"] then
+		vectorextensions "SSE4.1"
+	end
+	
+	if _OPTIONS["deterministic-math"] then
+		defines { "PV_MATH_DETERMINISTIC" }
+		
+		filter "toolset:gcc or toolset:clang"
+			buildoptions { "-ffp-contract=off" }
+		
+		filter "toolset:msc"
+			floatingpoint "Strict"
+		
+		filter {}
+	end
+	
 	--[[
 	Windowing API supprted  | windowingAPI
 	--------------------------------------
 	Win32					| PV_WINDOWING_API_WIN32 -- Dosen't support imgui viewports
 	GLFW					| PV_WINDOWING_API_GLFW  -- support imgui viewports
+	Null					| PV_WINDOWING_API_NULL  -- no OS window, used with --headless
 	
 	To Compile both use 	| PV_WINDOWING_API_BOTH
 	]]--
 	windowingAPI = "PV_WINDOWING_API_BOTH"
 	
+	if _OPTIONS["headless"] then
+		windowingAPI = "PV_WINDOWING_API_NULL"
+	end
+	
 	if (windowingAPI == "PV_WINDOWING_API_GLFW" or windowingAPI == "PV_WINDOWING_API_BOTH") then
 		include "PrevEngine/vendor/glfw"
 	end
@@ -36,11 +79,17 @@ workspace "PrevEngine"
 	---------------------------------------
 	DirectX 				 | PV_RENDERING_API_DIRECTX // 11
 	OpenGL					 | PV_RENDERING_API_OPENGL
+	Null					 | PV_RENDERING_API_NULL -- no GPU calls, used with --headless
+	Software (CPU raster) is always compiled, like null
 	
 	To Compile both use 	 | PV_RENDERING_API_BOTH
 	]]--
 	renderingAPI = "PV_RENDERING_API_BOTH"
 	
+	if _OPTIONS["headless"] then
+		renderingAPI = "PV_RENDERING_API_NULL"
+	end
+	
 	if (renderingAPI == "PV_RENDERING_API_OPENGL" or renderingAPI == "PV_RENDERING_API_BOTH") then
 		include "PrevEngine/vendor/glad"
 	end
@@ -106,25 +155,40 @@ workspace "PrevEngine"
 			includedirs {
 				"%{IncludeDir.glad}"
 			}
-		else
+		elseif (renderingAPI ~= "PV_RENDERING_API_NULL") then
 			error("Invalid renderingAPI")
 		end
 		
-		filter "system:windows"
-			systemversion "latest"
-		
-        defines {
+		defines {
 			renderingAPI,
 			windowingAPI,
-            "PV_BUILD_STATIC_LIB",
-			"PV_PLATFORM_WINDOWS",
-			"_CRT_SECURE_NO_WARNINGS"
+			"PV_BUILD_STATIC_LIB"
 		}
 		
+		filter "system:windows"
+			systemversion "latest"
+		
+			defines {
+				"PV_PLATFORM_WINDOWS",
+				"_CRT_SECURE_NO_WARNINGS"
+			}
+		
+		filter "system:linux"
+			defines {
+				"PV_PLATFORM_LINUX"
+			}
+		
 		pchheader "pch.h"
 		
 		filter "action:vs*"
 			pchsource "PrevEngine/src/pch.cpp"
+		
+		-- Software raster frames are compared against golden images, FMA contraction would make them differ between SIMD builds
+		filter { "files:PrevEngine/src/api/software/**.cpp", "toolset:gcc or toolset:clang" }
+			buildoptions { "-ffp-contract=off" }
+		
+		filter { "files:PrevEngine/src/api/software/**.cpp", "toolset:msc" }
+			buildoptions { "/fp:strict" }
 			
 		filter "configurations:Debug"
 			defines {"PV_DEBUG"}
@@ -170,6 +234,423 @@ workspace "PrevEngine"
 			"PrevEngine"
 		}
 		
+		filter "system:windows"
+			defines {
+				"PV_PLATFORM_WINDOWS"
+			}
+		
+		filter "system:linux"
+			defines {
+				"PV_PLATFORM_LINUX"
+			}
+			
+			links {
+				"ImGui",
+				"pthread"
+			}
+		
+		filter "configurations:Debug"
+			defines {"PV_DEBUG"}
+			runtime "Debug"
+			symbols "on"
+	
+		filter "configurations:Release"
+			defines {"PV_RELEASE"}
+			runtime "Release"
+			optimize "on"
+	
+		filter "configurations:Distribute"
+			defines {"PV_DIST"}
+			runtime "Release"
+			optimize "on"
+	
+	project "PrevBench"
+		location "PrevBench"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "C++17"
+		staticruntime "on"
+	
+		targetdir ("bin/" .. outputDir .. "%{prj.name}")
+		objdir ("bin-int/" .. outputDir .. "%{prj.name}")
+		
+		files {
+			"%{prj.name}/src/**.h",
+			"%{prj.name}/src/**.cpp",
+		}
+		
+		includedirs {
+			"%{prj.name}/src",
+			"PrevEngine/src"
+		}
+		
+		defines {
+			"_CRT_SECURE_NO_WARNINGS"
+		}
+		
+		links {
+			"PrevEngine"
+		}
+		
+		filter "system:windows"
+			defines {
+				"PV_PLATFORM_WINDOWS"
+			}
+		
+		filter "system:linux"
+			defines {
+				"PV_PLATFORM_LINUX"
+			}
+			
+			links {
+				"ImGui",
+				"pthread"
+			}
+		
+		filter "configurations:Debug"
+			defines {"PV_DEBUG"}
+			runtime "Debug"
+			symbols "on"
+	
+		filter "configurations:Release"
+			defines {"PV_RELEASE"}
+			runtime "Release"
+			optimize "on"
+	
+		filter "configurations:Distribute"
+			defines {"PV_DIST"}
+			runtime "Release"
+			optimize "on"
+	project "PrevLogDecode"
+		location "PrevLogDecode"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "C++17"
+		staticruntime "on"
+	
+		targetdir ("bin/" .. outputDir .. "%{prj.name}")
+		objdir ("bin-int/" .. outputDir .. "%{prj.name}")
+		
+		files {
+			"%{prj.name}/src/**.h",
+			"%{prj.name}/src/**.cpp",
+		}
+		
+		includedirs {
+			"PrevEngine/src"
+		}
+		
+		defines {
+			"_CRT_SECURE_NO_WARNINGS"
+		}
+		
+		filter "system:windows"
+			defines {
+				"PV_PLATFORM_WINDOWS"
+			}
+		
+		filter "system:linux"
+			defines {
+				"PV_PLATFORM_LINUX"
+			}
+		
+		filter "configurations:Debug"
+			defines {"PV_DEBUG"}
+			runtime "Debug"
+			symbols "on"
+	
+		filter "configurations:Release"
+			defines {"PV_RELEASE"}
+			runtime "Release"
+			optimize "on"
+	
+		filter "configurations:Distribute"
+			defines {"PV_DIST"}
+			runtime "Release"
+			optimize "on"
+
+	project "PrevJobBench"
+		location "PrevJobBench"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "C++17"
+		staticruntime "on"
+	
+		targetdir ("bin/" .. outputDir .. "%{prj.name}")
+		objdir ("bin-int/" .. outputDir .. "%{prj.name}")
+		
+		files {
+			"%{prj.name}/src/**.h",
+			"%{prj.name}/src/**.cpp",
+		}
+		
+		includedirs {
+			"%{prj.name}/src",
+			"PrevEngine/src"
+		}
+		
+		defines {
+			"_CRT_SECURE_NO_WARNINGS"
+		}
+		
+		links {
+			"PrevEngine"
+		}
+		
+		filter "system:windows"
+			defines {
+				"PV_PLATFORM_WINDOWS"
+			}
+		
+		filter "system:linux"
+			defines {
+				"PV_PLATFORM_LINUX"
+			}
+			
+			links {
+				"ImGui",
+				"pthread"
+			}
+		
+		filter "configurations:Debug"
+			defines {"PV_DEBUG"}
+			runtime "Debug"
+			symbols "on"
+	
+		filter "configurations:Release"
+			defines {"PV_RELEASE"}
+			runtime "Release"
+			optimize "on"
+	
+		filter "configurations:Distribute"
+			defines {"PV_DIST"}
+			runtime "Release"
+			optimize "on"
+
+	project "PrevPoolBench"
+		location "PrevPoolBench"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "C++17"
+		staticruntime "on"
+	
+		targetdir ("bin/" .. outputDir .. "%{prj.name}")
+		objdir ("bin-int/" .. outputDir .. "%{prj.name}")
+		
+		files {
+			"%{prj.name}/src/**.h",
+			"%{prj.name}/src/**.cpp",
+		}
+		
+		includedirs {
+			"%{prj.name}/src",
+			"PrevEngine/src"
+		}
+		
+		defines {
+			"_CRT_SECURE_NO_WARNINGS"
+		}
+		
+		links {
+			"PrevEngine"
+		}
+		
+		filter "system:windows"
+			defines {
+				"PV_PLATFORM_WINDOWS"
+			}
+		
+		filter "system:linux"
+			defines {
+				"PV_PLATFORM_LINUX"
+			}
+			
+			links {
+				"ImGui",
+				"pthread"
+			}
+		
+		filter "configurations:Debug"
+			defines {"PV_DEBUG"}
+			runtime "Debug"
+			symbols "on"
+	
+		filter "configurations:Release"
+			defines {"PV_RELEASE"}
+			runtime "Release"
+			optimize "on"
+	
+		filter "configurations:Distribute"
+			defines {"PV_DIST"}
+			runtime "Release"
+			optimize "on"
+
+	project "PrevRenderBench"
+		location "PrevRenderBench"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "C++17"
+		staticruntime "on"
+	
+		targetdir ("bin/" .. outputDir .. "%{prj.name}")
+		objdir ("bin-int/" .. outputDir .. "%{prj.name}")
+		
+		files {
+			"%{prj.name}/src/**.h",
+			"%{prj.name}/src/**.cpp",
+		}
+		
+		includedirs {
+			"%{prj.name}/src",
+			"PrevEngine/src"
+		}
+		
+		defines {
+			"_CRT_SECURE_NO_WARNINGS"
+		}
+		
+		links {
+			"PrevEngine"
+		}
+		
+		filter "system:windows"
+			defines {
+				"PV_PLATFORM_WINDOWS"
+			}
+		
+		filter "system:linux"
+			defines {
+				"PV_PLATFORM_LINUX"
+			}
+			
+			links {
+				"ImGui",
+				"pthread"
+			}
+		
+		-- The raster scene's vertices are computed here, they have to come out the same in every build for the golden image
+		filter "toolset:gcc or toolset:clang"
+			buildoptions { "-ffp-contract=off" }
+		
+		filter "toolset:msc"
+			floatingpoint "Strict"
+		
+		filter "configurations:Debug"
+			defines {"PV_DEBUG"}
+			runtime "Debug"
+			symbols "on"
+	
+		filter "configurations:Release"
+			defines {"PV_RELEASE"}
+			runtime "Release"
+			optimize "on"
+	
+		filter "configurations:Distribute"
+			defines {"PV_DIST"}
+			runtime "Release"
+			optimize "on"
+
+	project "PrevMathBench"
+		location "PrevMathBench"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "C++17"
+		staticruntime "on"
+	
+		targetdir ("bin/" .. outputDir .. "%{prj.name}")
+		objdir ("bin-int/" .. outputDir .. "%{prj.name}")
+		
+		files {
+			"%{prj.name}/src/**.h",
+			"%{prj.name}/src/**.cpp",
+		}
+		
+		includedirs {
+			"%{prj.name}/src",
+			"PrevEngine/src"
+		}
+		
+		defines {
+			"_CRT_SECURE_NO_WARNINGS"
+		}
+		
+		links {
+			"PrevEngine"
+		}
+		
+		filter "system:windows"
+			defines {
+				"PV_PLATFORM_WINDOWS"
+			}
+		
+		filter "system:linux"
+			defines {
+				"PV_PLATFORM_LINUX"
+			}
+			
+			links {
+				"ImGui",
+				"pthread"
+			}
+		
+		filter "configurations:Debug"
+			defines {"PV_DEBUG"}
+			runtime "Debug"
+			symbols "on"
+	
+		filter "configurations:Release"
+			defines {"PV_RELEASE"}
+			runtime "Release"
+			optimize "on"
+	
+		filter "configurations:Distribute"
+			defines {"PV_DIST"}
+			runtime "Release"
+			optimize "on"
+
+	project "PrevEcsBench"
+		location "PrevEcsBench"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "C++17"
+		staticruntime "on"
+	
+		targetdir ("bin/" .. outputDir .. "%{prj.name}")
+		objdir ("bin-int/" .. outputDir .. "%{prj.name}")
+		
+		files {
+			"%{prj.name}/src/**.h",
+			"%{prj.name}/src/**.cpp",
+		}
+		
+		includedirs {
+			"%{prj.name}/src",
+			"PrevEngine/src"
+		}
+		
+		defines {
+			"_CRT_SECURE_NO_WARNINGS"
+		}
+		
+		links {
+			"PrevEngine"
+		}
+		
+		filter "system:windows"
+			defines {
+				"PV_PLATFORM_WINDOWS"
+			}
+		
+		filter "system:linux"
+			defines {
+				"PV_PLATFORM_LINUX"
+			}
+			
+			links {
+				"ImGui",
+				"pthread"
+			}
+		
 		filter "configurations:Debug"
 			defines {"PV_DEBUG"}
 			runtime "Debug"